@@ -0,0 +1,404 @@
+// uvf_bench: time the conversion stages on synthetic in-memory datasets.
+//
+// Each case builds a mesh in memory (no input files), converts it into a
+// UVFMemoryOutput (no disk I/O unless --output is given) and prints one JSON
+// object per line with per-stage seconds and throughput, best of --repeat runs.
+//
+//   uvf_bench                          default suite at --points=1000000
+//   uvf_bench --points=4000000 --arity=4 --arrays=8 --components=3 --faces=64
+//   uvf_bench --lines --points=2000000 --input=mesh --repeat=5
+#include "vtp_to_uvf.h"
+#include "uvf_output.h"
+#include "conversion_stats.h"
+#include "mesh_normals.h"
+#include "mesh_reorder.h"
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkPointData.h>
+#include <vtkCellData.h>
+#include <vtkFloatArray.h>
+#include <vtkIntArray.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct BenchCase {
+    std::string name = "custom";
+    size_t points = 1000000;    // approximate; rounded to a grid
+    size_t cells = 0;           // 0: as many as the grid holds
+    int arity = 3;              // vertices per polygon (or per polyline with lines)
+    int arrays = 1;             // point-data arrays
+    int components = 1;         // floats per array tuple
+    int faces = 0;              // FaceIndex segments (0: none)
+    bool lines = false;         // polylines instead of polygons
+    std::string input = "vtk";  // vtk (vtkPolyData), stl (binary STL buffer), mesh (raw arrays)
+};
+
+struct Options {
+    int repeat = 3;
+    int threads = 0;
+    std::string output;         // write to this directory instead of memory
+    std::string compression = "none";
+    bool mesh_codecs = false;
+    std::string reorder = "none";
+    std::string vertex_layout = "separate";
+    std::string normals = "none";
+    bool bvh = false;
+    bool feature_edges = false;
+};
+
+// Flat arrays shared by all input kinds; polygons are stored with their arity
+struct SyntheticMesh {
+    size_t width = 0;
+    size_t cell_count = 0;
+    std::vector<float> positions;
+    std::vector<vtkIdType> cells;           // arity ids per cell
+    std::vector<std::vector<float>> arrays;
+    std::vector<int> face_index;            // per cell, empty without faces
+};
+
+// Points on a w x h grid (a gently curved sheet so the mesh is not flat).
+// A polygon of arity k takes ceil(k/2) points from one row and the rest from
+// the next row in reverse, so neighbours share an edge; cells wrap around the
+// grid when more are requested than it holds.
+SyntheticMesh build_mesh(const BenchCase& c) {
+    SyntheticMesh m;
+    const int k = std::max(c.lines ? 2 : 3, c.arity);
+    const size_t top = (k + 1) / 2;
+    m.width = std::max<size_t>(top + 1, static_cast<size_t>(std::sqrt(static_cast<double>(c.points))));
+    const size_t height = std::max<size_t>(2, (c.points + m.width - 1) / m.width);
+    const size_t n = m.width * height;
+
+    m.positions.resize(n * 3);
+    for (size_t i = 0; i < n; ++i) {
+        float x = static_cast<float>(i % m.width);
+        float y = static_cast<float>(i / m.width);
+        m.positions[i * 3 + 0] = x;
+        m.positions[i * 3 + 1] = y;
+        m.positions[i * 3 + 2] = 0.01f * std::sin(x * 0.05f) * std::cos(y * 0.05f);
+    }
+
+    // Cells laid out row by row; polylines take k consecutive points of one row
+    std::vector<size_t> starts;
+    if (c.lines) {
+        for (size_t r = 0; r < height; ++r)
+            for (size_t col = 0; col + k <= m.width; col += k - 1) starts.push_back(r * m.width + col);
+    } else {
+        for (size_t r = 0; r + 1 < height; ++r)
+            for (size_t col = 0; col + top <= m.width; col += top - 1) starts.push_back(r * m.width + col);
+    }
+    const size_t ncells = c.cells ? c.cells : starts.size();
+    m.cell_count = ncells;
+    m.cells.reserve(ncells * k);
+    for (size_t i = 0; i < ncells; ++i) {
+        size_t s = starts[i % starts.size()];
+        if (c.lines) {
+            for (int j = 0; j < k; ++j) m.cells.push_back(static_cast<vtkIdType>(s + j));
+        } else {
+            for (size_t j = 0; j < top; ++j) m.cells.push_back(static_cast<vtkIdType>(s + j));
+            for (size_t j = 0; j < k - top; ++j) m.cells.push_back(static_cast<vtkIdType>(s + m.width + (k - top - 1 - j)));
+        }
+    }
+
+    for (int a = 0; a < c.arrays; ++a) {
+        std::vector<float> data(n * c.components);
+        for (size_t i = 0; i < data.size(); ++i) data[i] = std::sin(0.001f * static_cast<float>(i) + a);
+        m.arrays.push_back(std::move(data));
+    }
+    if (c.faces > 0) {
+        m.face_index.resize(ncells);
+        for (size_t i = 0; i < ncells; ++i) m.face_index[i] = static_cast<int>(i * c.faces / ncells);
+    }
+    return m;
+}
+
+vtkSmartPointer<vtkPolyData> to_polydata(const SyntheticMesh& m, const BenchCase& c) {
+    auto poly = vtkSmartPointer<vtkPolyData>::New();
+    auto pts = vtkSmartPointer<vtkPoints>::New();
+    const size_t n = m.positions.size() / 3;
+    pts->SetNumberOfPoints(static_cast<vtkIdType>(n));
+    for (size_t i = 0; i < n; ++i) pts->SetPoint(static_cast<vtkIdType>(i), m.positions[i * 3], m.positions[i * 3 + 1], m.positions[i * 3 + 2]);
+    poly->SetPoints(pts);
+
+    const int k = std::max(c.lines ? 2 : 3, c.arity);
+    auto cells = vtkSmartPointer<vtkCellArray>::New();
+    for (size_t i = 0; i < m.cells.size(); i += k) cells->InsertNextCell(k, &m.cells[i]);
+    if (c.lines) poly->SetLines(cells);
+    else poly->SetPolys(cells);
+
+    for (size_t a = 0; a < m.arrays.size(); ++a) {
+        auto arr = vtkSmartPointer<vtkFloatArray>::New();
+        arr->SetName(("field" + std::to_string(a)).c_str());
+        arr->SetNumberOfComponents(c.components);
+        arr->SetNumberOfTuples(static_cast<vtkIdType>(n));
+        for (size_t i = 0; i < n; ++i)
+            for (int comp = 0; comp < c.components; ++comp)
+                arr->SetComponent(static_cast<vtkIdType>(i), comp, m.arrays[a][i * c.components + comp]);
+        poly->GetPointData()->AddArray(arr);
+    }
+    if (!m.face_index.empty()) {
+        auto faces = vtkSmartPointer<vtkIntArray>::New();
+        faces->SetName("FaceIndex");
+        faces->SetNumberOfComponents(1);
+        faces->SetNumberOfTuples(static_cast<vtkIdType>(m.face_index.size()));
+        for (size_t i = 0; i < m.face_index.size(); ++i) faces->SetValue(static_cast<vtkIdType>(i), m.face_index[i]);
+        poly->GetCellData()->AddArray(faces);
+    }
+    return poly;
+}
+
+// Binary STL image of the fan-triangulated polygons
+std::string to_stl(const SyntheticMesh& m, const BenchCase& c) {
+    const int k = std::max(3, c.arity);
+    std::vector<float> tris;
+    for (size_t i = 0; i < m.cells.size(); i += k) {
+        for (int j = 1; j + 1 < k; ++j) {
+            for (vtkIdType id : {m.cells[i], m.cells[i + j], m.cells[i + j + 1]})
+                tris.insert(tris.end(), &m.positions[id * 3], &m.positions[id * 3] + 3);
+        }
+    }
+    const uint32_t count = static_cast<uint32_t>(tris.size() / 9);
+    std::string stl(80, '\0');
+    stl.append(reinterpret_cast<const char*>(&count), 4);
+    const float normal[3] = {0, 0, 1};
+    const uint16_t attr = 0;
+    for (uint32_t t = 0; t < count; ++t) {
+        stl.append(reinterpret_cast<const char*>(normal), 12);
+        stl.append(reinterpret_cast<const char*>(&tris[t * 9]), 36);
+        stl.append(reinterpret_cast<const char*>(&attr), 2);
+    }
+    return stl;
+}
+
+// Raw triangle indices for the mesh path (fan triangulation, lines as a,b,b)
+std::vector<uint32_t> to_indices(const SyntheticMesh& m, const BenchCase& c) {
+    const int k = std::max(c.lines ? 2 : 3, c.arity);
+    std::vector<uint32_t> idx;
+    for (size_t i = 0; i < m.cells.size(); i += k) {
+        if (c.lines) {
+            for (int j = 0; j + 1 < k; ++j) {
+                uint32_t a = static_cast<uint32_t>(m.cells[i + j]), b = static_cast<uint32_t>(m.cells[i + j + 1]);
+                idx.insert(idx.end(), {a, b, b});
+            }
+        } else {
+            for (int j = 1; j + 1 < k; ++j)
+                idx.insert(idx.end(), {static_cast<uint32_t>(m.cells[i]), static_cast<uint32_t>(m.cells[i + j]), static_cast<uint32_t>(m.cells[i + j + 1])});
+        }
+    }
+    return idx;
+}
+
+bool run_once(const SyntheticMesh& m, const BenchCase& c, const Options& opts, UVFConversionStats& stats) {
+    UVFOptions options;
+    options.threads = opts.threads;
+    options.compression = opts.compression;
+    options.mesh_codecs = opts.mesh_codecs;
+    options.reorder = opts.reorder;
+    options.vertex_layout = opts.vertex_layout;
+    options.normals = opts.normals;
+    options.bvh = opts.bvh;
+    options.feature_edges = opts.feature_edges;
+    options.stats = &stats;
+    stats.reset();
+
+    std::unique_ptr<UVFOutput> out;
+    if (opts.output.empty()) out.reset(new UVFMemoryOutput());
+    else out.reset(new UVFDirectoryOutput(opts.output));
+
+    if (c.input == "mesh") {
+        std::vector<uint32_t> indices = to_indices(m, c);
+        UVFMeshView view;
+        view.positions = m.positions.data();
+        view.vertex_count = m.positions.size() / 3;
+        view.indices = indices.data();
+        view.index_count = indices.size();
+        for (size_t a = 0; a < m.arrays.size(); ++a)
+            view.attributes.push_back({"field" + std::to_string(a), m.arrays[a].data(), m.arrays[a].size(), c.components});
+        stats.start();
+        bool ok = generate_uvf(view, *out, options);
+        stats.finish();
+        return ok;
+    }
+
+    vtkSmartPointer<vtkPolyData> poly;
+    std::string stl;
+    if (c.input == "stl") stl = to_stl(m, c);
+    else poly = to_polydata(m, c);
+
+    stats.start();
+    if (c.input == "stl") {
+        UVFStageTimer parse(options, "parse");
+        poly = parse_polydata_buffer(stl.data(), stl.size(), "stl");
+        parse.add_bytes(stl.size());
+        parse.add_items(1);
+    }
+    bool ok = poly && generate_uvf(poly, *out, options);
+    stats.finish();
+    return ok;
+}
+
+double rate(double amount, double seconds) {
+    return seconds > 0 ? amount / seconds : 0;
+}
+
+std::string result_json(const BenchCase& c, const SyntheticMesh& m, const Options& opts, const UVFConversionStats& s) {
+    std::ostringstream oss;
+    oss.setf(std::ios::fixed);
+    oss.precision(6);
+    oss << "{\"case\":\"" << c.name << "\",\"input\":\"" << c.input << "\",\"points\":" << s.points()
+        << ",\"triangles\":" << s.triangles() << ",\"cells\":" << m.cell_count << ",\"arity\":" << c.arity
+        << ",\"arrays\":" << c.arrays << ",\"components\":" << c.components << ",\"faces\":" << c.faces
+        << ",\"lines\":" << (c.lines ? "true" : "false") << ",\"threads\":" << opts.threads
+        << ",\"total_seconds\":" << s.total_seconds()
+        << ",\"points_per_s\":" << rate(static_cast<double>(s.points()), s.total_seconds())
+        << ",\"output_mb_per_s\":" << rate(s.bytes_written() / 1e6, s.total_seconds())
+        << ",\"bytes_written\":" << s.bytes_written() << ",\"peak_rss_bytes\":" << s.peak_rss_bytes() << ",\"stages\":[";
+    auto stages = s.stages();
+    for (size_t i = 0; i < stages.size(); ++i) {
+        const auto& st = stages[i];
+        if (i) oss << ",";
+        oss << "{\"name\":\"" << st.name << "\",\"seconds\":" << st.seconds << ",\"items\":" << st.items
+            << ",\"items_per_s\":" << rate(static_cast<double>(st.items), st.seconds) << ",\"bytes\":" << st.bytes
+            << ",\"mb_per_s\":" << rate(st.bytes / 1e6, st.seconds) << "}";
+    }
+    oss << "]}";
+    return oss.str();
+}
+
+bool run_case(const BenchCase& c, const Options& opts) {
+    SyntheticMesh m = build_mesh(c);
+    UVFConversionStats stats;
+    std::string best;
+    double best_seconds = -1;
+    for (int r = 0; r < std::max(1, opts.repeat); ++r) {
+        if (!run_once(m, c, opts, stats)) {
+            std::cerr << "Conversion failed for case " << c.name << std::endl;
+            return false;
+        }
+        if (best_seconds < 0 || stats.total_seconds() < best_seconds) {
+            best_seconds = stats.total_seconds();
+            best = result_json(c, m, opts, stats);
+        }
+    }
+    std::cout << best << std::endl;
+    return true;
+}
+
+// Cases covering the hot paths at a given size
+std::vector<BenchCase> default_suite(size_t points) {
+    std::vector<BenchCase> suite;
+    auto add = [&](const char* name, int arity, int arrays, int components, int faces, bool lines, const char* input) {
+        BenchCase c;
+        c.name = name;
+        c.points = points;
+        c.arity = arity;
+        c.arrays = arrays;
+        c.components = components;
+        c.faces = faces;
+        c.lines = lines;
+        c.input = input;
+        suite.push_back(c);
+    };
+    add("triangles", 3, 1, 1, 0, false, "vtk");
+    add("quads", 4, 1, 1, 0, false, "vtk");
+    add("polygons8", 8, 1, 1, 0, false, "vtk");
+    add("wide_fields", 3, 8, 3, 0, false, "vtk");
+    add("face_segments", 3, 1, 1, 256, false, "vtk");
+    add("lines", 16, 1, 1, 0, true, "vtk");
+    add("stl", 3, 0, 1, 0, false, "stl");
+    add("raw_mesh", 3, 4, 1, 0, false, "mesh");
+    return suite;
+}
+
+bool parse_size(const char* text, size_t& out) {
+    char* end = nullptr;
+    double v = std::strtod(text, &end);
+    if (end == text || v < 0) return false;
+    out = static_cast<size_t>(v); // accepts 1e6 style sizes
+    return true;
+}
+
+void usage(const char* argv0) {
+    std::cout << "Usage: " << argv0 << " [options]" << std::endl;
+    std::cout << "Without case options runs the default suite; prints one JSON object per case." << std::endl;
+    std::cout << "  --points=N        Approximate vertex count (default 1e6)" << std::endl;
+    std::cout << "  --cells=N         Polygon/polyline count (default: fill the grid)" << std::endl;
+    std::cout << "  --arity=K         Vertices per polygon or polyline (default 3)" << std::endl;
+    std::cout << "  --arrays=N        Point-data arrays (default 1)" << std::endl;
+    std::cout << "  --components=N    Components per array (default 1)" << std::endl;
+    std::cout << "  --faces=N         FaceIndex segments (default 0)" << std::endl;
+    std::cout << "  --lines           Polylines only" << std::endl;
+    std::cout << "  --input=vtk|stl|mesh  Conversion entry point (default vtk)" << std::endl;
+    std::cout << "  --repeat=N        Runs per case, best reported (default 3)" << std::endl;
+    std::cout << "  --threads=N       Worker threads (default: all cores)" << std::endl;
+    std::cout << "  --output=DIR      Write to DIR instead of memory" << std::endl;
+    std::cout << "  --compression=none|deflate  Bin section compression (default none)" << std::endl;
+    std::cout << "  --mesh-codecs     Delta-varint indices, byte-plane positions" << std::endl;
+    std::cout << "  --reorder=none|morton  Spatial vertex and triangle reordering (default none)" << std::endl;
+    std::cout << "  --normals=none|float32|oct16  Precomputed vertex normals (default none)" << std::endl;
+    std::cout << "  --vertex-layout=separate|interleaved|both  Vertex section layout (default separate)" << std::endl;
+    std::cout << "  --bvh             Build the BVH sections" << std::endl;
+    std::cout << "  --feature-edges   Extract boundary, non-manifold and feature edges" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    BenchCase custom;
+    bool has_case = false;
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        bool ok = true;
+        if (std::strncmp(a, "--points=", 9) == 0) ok = parse_size(a + 9, custom.points);
+        else if (std::strncmp(a, "--cells=", 8) == 0) { ok = parse_size(a + 8, custom.cells); has_case = true; }
+        else if (std::strncmp(a, "--arity=", 8) == 0) { custom.arity = std::atoi(a + 8); has_case = true; }
+        else if (std::strncmp(a, "--arrays=", 9) == 0) { custom.arrays = std::atoi(a + 9); has_case = true; }
+        else if (std::strncmp(a, "--components=", 13) == 0) { custom.components = std::max(1, std::atoi(a + 13)); has_case = true; }
+        else if (std::strncmp(a, "--faces=", 8) == 0) { custom.faces = std::atoi(a + 8); has_case = true; }
+        else if (std::strcmp(a, "--lines") == 0) { custom.lines = true; has_case = true; }
+        else if (std::strncmp(a, "--input=", 8) == 0) {
+            custom.input = a + 8;
+            ok = custom.input == "vtk" || custom.input == "stl" || custom.input == "mesh";
+            has_case = true;
+        }
+        else if (std::strncmp(a, "--repeat=", 9) == 0) opts.repeat = std::atoi(a + 9);
+        else if (std::strncmp(a, "--threads=", 10) == 0) opts.threads = std::atoi(a + 10);
+        else if (std::strncmp(a, "--output=", 9) == 0) opts.output = a + 9;
+        else if (std::strncmp(a, "--compression=", 14) == 0) { opts.compression = a + 14; ok = is_known_compression(opts.compression); }
+        else if (std::strcmp(a, "--mesh-codecs") == 0) opts.mesh_codecs = true;
+        else if (std::strcmp(a, "--bvh") == 0) opts.bvh = true;
+        else if (std::strcmp(a, "--feature-edges") == 0) opts.feature_edges = true;
+        else if (std::strncmp(a, "--reorder=", 10) == 0) { opts.reorder = a + 10; ok = is_known_reorder_mode(opts.reorder); }
+        else if (std::strncmp(a, "--vertex-layout=", 16) == 0) {
+            opts.vertex_layout = a + 16;
+            ok = opts.vertex_layout == "separate" || opts.vertex_layout == "interleaved" || opts.vertex_layout == "both";
+        }
+        else if (std::strncmp(a, "--normals=", 10) == 0) { opts.normals = a + 10; ok = is_known_normals_mode(opts.normals); }
+        else { usage(argv[0]); return std::strcmp(a, "--help") == 0 ? 0 : 1; }
+        if (!ok) {
+            std::cerr << "Invalid value: " << a << std::endl;
+            return 1;
+        }
+    }
+    if (custom.lines && custom.input == "stl") {
+        std::cerr << "STL input has no polylines" << std::endl;
+        return 1;
+    }
+
+    std::vector<BenchCase> cases = has_case ? std::vector<BenchCase>{custom} : default_suite(custom.points);
+    for (const auto& c : cases) {
+        if (!run_case(c, opts)) return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,210 @@
+#include "binary_manifest.h"
+#include "vtp_to_uvf.h"
+#include <cstring>
+
+// Record sizes in words for the fixed-size tables, indexed by table
+static const uint32_t kRecordWords[UVF_BM_TABLE_COUNT] = {
+    1, UVF_BM_GROUP_WORDS, UVF_BM_SOLID_WORDS, UVF_BM_FACE_WORDS, UVF_BM_SECTION_WORDS, 1, 1, UVF_BM_EDGE_WORDS, UVF_BM_ATTRIBUTE_WORDS, 0
+};
+
+uint32_t UVFBinaryManifestBuilder::intern(const std::string& s) {
+    auto it = string_ids_.find(s);
+    if (it != string_ids_.end()) return it->second;
+    uint32_t id = static_cast<uint32_t>(string_offsets_.size() - 1);
+    string_data_ += s;
+    string_offsets_.push_back(static_cast<uint32_t>(string_data_.size()));
+    string_ids_.emplace(s, id);
+    return id;
+}
+
+void UVFBinaryManifestBuilder::push64(std::vector<uint32_t>& v, uint64_t x) {
+    v.push_back(static_cast<uint32_t>(x));
+    v.push_back(static_cast<uint32_t>(x >> 32));
+}
+
+uint32_t UVFBinaryManifestBuilder::float_bits(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, 4);
+    return bits;
+}
+
+void UVFBinaryManifestBuilder::add_group(const std::string& id, bool identity_transform) {
+    if (!enabled_) return;
+    groups_.insert(groups_.end(), {intern(id), identity_transform ? 1u : 0u,
+                                   static_cast<uint32_t>(refs_.size()), 0});
+}
+
+void UVFBinaryManifestBuilder::add_group_member(const std::string& id) {
+    if (!enabled_) return;
+    refs_.push_back(intern(id));
+    groups_.back() += 1;
+}
+
+void UVFBinaryManifestBuilder::add_solid(const std::string& id, const std::string* geom_kind, const std::string* path) {
+    if (!enabled_) return;
+    uint32_t first_ref = static_cast<uint32_t>(refs_.size());
+    solids_.insert(solids_.end(), {intern(id), geom_kind ? intern(*geom_kind) : UVF_BM_NONE, path ? intern(*path) : UVF_BM_NONE,
+                                   static_cast<uint32_t>(sections_.size() / UVF_BM_SECTION_WORDS), 0,
+                                   first_ref, 0, first_ref, 0, 0});
+}
+
+void UVFBinaryManifestBuilder::add_solid_sections(const UVFOffsets& offsets, const std::map<std::string, std::pair<float, float>>* ranges) {
+    if (!enabled_) return;
+    uint32_t* solid = &solids_[solids_.size() - UVF_BM_SOLID_WORDS];
+    for (const auto& kv : offsets.fields) {
+        sections_.push_back(intern(kv.second.dType));
+        sections_.push_back(intern(kv.first));
+        sections_.push_back(static_cast<uint32_t>(kv.second.dimension));
+        auto r = ranges ? ranges->find(kv.first) : std::map<std::string, std::pair<float, float>>::const_iterator();
+        bool has_range = ranges && r != ranges->end();
+        const UVFSectionBlocks& blocks = kv.second.blocks;
+        bool compressed = !blocks.codec.empty();
+        sections_.push_back((has_range ? 1u : 0u) | (compressed ? 2u : 0u));
+        push64(sections_, kv.second.offset);
+        push64(sections_, kv.second.length);
+        sections_.push_back(has_range ? float_bits(r->second.first) : 0);
+        sections_.push_back(has_range ? float_bits(r->second.second) : 0);
+        sections_.push_back(compressed ? intern(blocks.codec) : UVF_BM_NONE);
+        sections_.push_back(blocks.block_size);
+        sections_.push_back(static_cast<uint32_t>(blocks_.size()));
+        sections_.push_back(static_cast<uint32_t>(blocks.sizes.size()));
+        uint64_t raw_length = compressed ? blocks.raw_length : kv.second.length;
+        push64(sections_, raw_length);
+        bool encoded = !kv.second.encoding.empty();
+        sections_.push_back(encoded ? intern(kv.second.encoding) : UVF_BM_NONE);
+        push64(sections_, encoded ? kv.second.decoded_length : raw_length);
+        sections_.push_back(kv.second.constant_bits);
+        sections_.push_back(static_cast<uint32_t>(attributes_.size() / UVF_BM_ATTRIBUTE_WORDS));
+        sections_.push_back(static_cast<uint32_t>(kv.second.interleaved.size()));
+        for (const UVFInterleavedAttribute& a : kv.second.interleaved) {
+            auto ar = ranges ? ranges->find(a.name) : std::map<std::string, std::pair<float, float>>::const_iterator();
+            bool attribute_range = ranges && ar != ranges->end();
+            attributes_.insert(attributes_.end(), {intern(a.name), a.offset, static_cast<uint32_t>(a.dimension),
+                                                   attribute_range ? 1u : 0u,
+                                                   attribute_range ? float_bits(ar->second.first) : 0,
+                                                   attribute_range ? float_bits(ar->second.second) : 0});
+        }
+        blocks_.insert(blocks_.end(), blocks.sizes.begin(), blocks.sizes.end());
+        solid[4] += 1;
+    }
+}
+
+void UVFBinaryManifestBuilder::add_solid_edge(const std::string& id) {
+    if (!enabled_) return;
+    uint32_t* solid = &solids_[solids_.size() - UVF_BM_SOLID_WORDS];
+    if (solid[6] == 0) solid[5] = static_cast<uint32_t>(refs_.size());
+    refs_.push_back(intern(id));
+    solid[6] += 1;
+}
+
+void UVFBinaryManifestBuilder::add_solid_face(const std::string& id) {
+    if (!enabled_) return;
+    uint32_t* solid = &solids_[solids_.size() - UVF_BM_SOLID_WORDS];
+    if (solid[8] == 0) solid[7] = static_cast<uint32_t>(refs_.size());
+    refs_.push_back(intern(id));
+    solid[8] += 1;
+}
+
+void UVFBinaryManifestBuilder::add_face(const std::string& id, const std::string& parent, uint32_t color, float alpha) {
+    if (!enabled_) return;
+    faces_.insert(faces_.end(), {intern(id), intern(parent), color, float_bits(alpha),
+                                 UVF_BM_NONE, UVF_BM_NONE, UVF_BM_NONE, UVF_BM_NONE});
+}
+
+void UVFBinaryManifestBuilder::add_face(const std::string& id, const std::string& parent, uint32_t color, float alpha,
+                                        uint64_t start_index, uint64_t end_index) {
+    if (!enabled_) return;
+    faces_.insert(faces_.end(), {intern(id), intern(parent), color, float_bits(alpha)});
+    push64(faces_, start_index);
+    push64(faces_, end_index);
+}
+
+void UVFBinaryManifestBuilder::add_edge(const std::string& id, const std::string& parent, uint32_t color, float alpha,
+                                        const std::string& section, uint64_t start_index, uint64_t end_index) {
+    if (!enabled_) return;
+    edges_.insert(edges_.end(), {intern(id), intern(parent), color, float_bits(alpha), intern(section)});
+    push64(edges_, start_index);
+    push64(edges_, end_index);
+}
+
+std::string UVFBinaryManifestBuilder::serialize() const {
+    const std::vector<uint32_t>* tables[UVF_BM_STRING_DATA] = {
+        &string_offsets_, &groups_, &solids_, &faces_, &sections_, &refs_, &blocks_, &edges_, &attributes_
+    };
+    uint32_t header[UVF_BM_HEADER_WORDS] = {UVF_BM_MAGIC, UVF_BM_VERSION, 0, 0};
+    size_t offset = sizeof(header);
+    for (int t = 0; t < UVF_BM_STRING_DATA; ++t) {
+        header[4 + t * 2] = static_cast<uint32_t>(offset);
+        header[5 + t * 2] = static_cast<uint32_t>(t == UVF_BM_STRINGS ? string_offsets_.size() - 1
+                                                                        : tables[t]->size() / kRecordWords[t]);
+        offset += tables[t]->size() * 4;
+    }
+    header[4 + UVF_BM_STRING_DATA * 2] = static_cast<uint32_t>(offset);
+    header[5 + UVF_BM_STRING_DATA * 2] = static_cast<uint32_t>(string_data_.size());
+    // String bytes are padded so the file size stays a multiple of 4
+    size_t total = offset + ((string_data_.size() + 3) & ~size_t(3));
+    header[2] = static_cast<uint32_t>(total);
+
+    std::string out;
+    out.reserve(total);
+    out.append(reinterpret_cast<const char*>(header), sizeof(header));
+    for (int t = 0; t < UVF_BM_STRING_DATA; ++t) {
+        out.append(reinterpret_cast<const char*>(tables[t]->data()), tables[t]->size() * 4);
+    }
+    out += string_data_;
+    out.resize(total, '\0');
+    return out;
+}
+
+bool UVFBinaryManifestView::parse(const void* data, size_t size, std::string& error) {
+    const uint32_t* words = static_cast<const uint32_t*>(data);
+    if (size < UVF_BM_HEADER_WORDS * 4 || words[0] != UVF_BM_MAGIC) {
+        error = "not a binary UVF manifest";
+        return false;
+    }
+    if (words[1] != UVF_BM_VERSION) {
+        error = "unsupported binary manifest version " + std::to_string(words[1]);
+        return false;
+    }
+    if (words[2] != size) {
+        error = "binary manifest size mismatch";
+        return false;
+    }
+    for (int t = 0; t < UVF_BM_TABLE_COUNT; ++t) {
+        uint32_t offset = words[4 + t * 2];
+        uint32_t count = words[5 + t * 2];
+        uint64_t bytes = t == UVF_BM_STRING_DATA ? count
+                       : (static_cast<uint64_t>(count) + (t == UVF_BM_STRINGS ? 1 : 0)) * kRecordWords[t] * 4;
+        if (offset % 4 != 0 || offset + bytes > size) {
+            error = "binary manifest table " + std::to_string(t) + " out of bounds";
+            return false;
+        }
+        tables_[t] = reinterpret_cast<const uint32_t*>(static_cast<const char*>(data) + offset);
+        counts_[t] = count;
+    }
+    string_data_ = reinterpret_cast<const char*>(tables_[UVF_BM_STRING_DATA]);
+    const uint32_t* offs = tables_[UVF_BM_STRINGS];
+    for (uint32_t i = 0; i < counts_[UVF_BM_STRINGS]; ++i) {
+        if (offs[i] > offs[i + 1] || offs[i + 1] > counts_[UVF_BM_STRING_DATA]) {
+            error = "binary manifest string table is corrupt";
+            return false;
+        }
+    }
+    return true;
+}
+
+const uint32_t* UVFBinaryManifestView::record(UVFBinaryManifestTable table, size_t i) const {
+    return tables_[table] + i * kRecordWords[table];
+}
+
+std::string UVFBinaryManifestView::string_at(uint32_t id) const {
+    if (id >= counts_[UVF_BM_STRINGS]) return std::string();
+    const uint32_t* offs = tables_[UVF_BM_STRINGS];
+    return std::string(string_data_ + offs[id], offs[id + 1] - offs[id]);
+}
+
+float UVFBinaryManifestView::f32(uint32_t word) {
+    float f;
+    std::memcpy(&f, &word, 4);
+    return f;
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct UVFOffsets;
+
+// Binary twin of manifest.json (manifest.uvfm) for viewers that cannot afford
+// to download and JSON.parse hundreds of thousands of Face entries.
+//
+// Every field is a little-endian 32-bit word (uint32, or float32 where noted),
+// so each table can be viewed in place with a Uint32Array/Float32Array.
+// 64-bit values are stored as lo, hi word pairs. Absent strings/values are
+// UVF_BM_NONE. Layout:
+//
+//   header   24 words: magic "UVFM", version, file size, reserved, then
+//            (offset in bytes, count) for the 10 tables below
+//   strings  count+1 byte offsets into the string data (string i spans
+//            [off[i], off[i+1]), UTF-8, not terminated)
+//   groups   GeometryGroup: id, flags (1 = identity transform), members first, members count
+//   solids   SolidGeometry: id, geomKind, buffer path, sections first, sections count,
+//            edges first, edges count, faces first, faces count, reserved
+//   faces    Face: id, packedParentId, color, alpha (float32), startIndex lo, hi,
+//            endIndex lo, hi (all four NONE without bufferLocations; bufNum is 0)
+//   sections dType, name, dimension, flags (1 = has range, 2 = compressed),
+//            offset lo, hi, length lo, hi, rangeMin (float32), rangeMax (float32),
+//            compression, block size, blocks first, blocks count, raw length lo, hi,
+//            encoding, decoded length lo, hi, constant bits, attributes first,
+//            attributes count (compression NONE and raw length = length for
+//            sections stored raw; encoding NONE and decoded length = raw length
+//            for sections without an encoding; constant bits is the repeated
+//            element of "constant" sections, else 0; attributes count is 0
+//            unless the section is interleaved)
+//   refs     string ids referenced by group members and solid edge/face lists
+//   blocks   compressed block sizes of compressed sections (see section_codec.h)
+//   edges    Edge: id, packedParentId, color, alpha (float32), section name,
+//            startIndex lo, hi, endIndex lo, hi (uint32 element range of the
+//            named line-index section, see mesh_edges.h)
+//   attributes  interleaved section attribute: name, byte offset in the
+//            element, dimension, flags (1 = has range), rangeMin (float32),
+//            rangeMax (float32); the element stride is the section's
+//            dimension * 4 bytes
+//   data     string bytes
+//
+// Ids and names are string table indices. Faces and edges inherit geomKind
+// from their parent solid.
+constexpr uint32_t UVF_BM_MAGIC = 0x4D465655; // "UVFM"
+constexpr uint32_t UVF_BM_VERSION = 6;
+constexpr uint32_t UVF_BM_NONE = 0xFFFFFFFFu;
+constexpr uint32_t UVF_BM_HEADER_WORDS = 24;
+constexpr uint32_t UVF_BM_GROUP_WORDS = 4;
+constexpr uint32_t UVF_BM_SOLID_WORDS = 10;
+constexpr uint32_t UVF_BM_FACE_WORDS = 8;
+constexpr uint32_t UVF_BM_SECTION_WORDS = 22;
+constexpr uint32_t UVF_BM_EDGE_WORDS = 9;
+constexpr uint32_t UVF_BM_ATTRIBUTE_WORDS = 6;
+
+enum UVFBinaryManifestTable {
+    UVF_BM_STRINGS = 0,
+    UVF_BM_GROUPS,
+    UVF_BM_SOLIDS,
+    UVF_BM_FACES,
+    UVF_BM_SECTIONS,
+    UVF_BM_REFS,
+    UVF_BM_BLOCKS,
+    UVF_BM_EDGES,
+    UVF_BM_ATTRIBUTES,
+    UVF_BM_STRING_DATA,
+    UVF_BM_TABLE_COUNT
+};
+
+// Collects manifest nodes in the order the JSON generators emit them.
+// Member/edge/face ids of one record must be added before the next record of
+// the same kind is started. A disabled builder ignores every call, so the
+// generators can feed it unconditionally.
+class UVFBinaryManifestBuilder {
+public:
+    explicit UVFBinaryManifestBuilder(bool enabled = true) : enabled_(enabled) {}
+
+    void add_group(const std::string& id, bool identity_transform);
+    void add_group_member(const std::string& id);
+
+    // geom_kind and path may be null (no geomKind property / no buffers resource)
+    void add_solid(const std::string& id, const std::string* geom_kind, const std::string* path);
+    void add_solid_sections(const UVFOffsets& offsets, const std::map<std::string, std::pair<float, float>>* ranges = nullptr);
+    void add_solid_edge(const std::string& id);
+    void add_solid_face(const std::string& id);
+
+    // Without a location the face has no bufferLocations entry
+    void add_face(const std::string& id, const std::string& parent, uint32_t color, float alpha);
+    void add_face(const std::string& id, const std::string& parent, uint32_t color, float alpha,
+                  uint64_t start_index, uint64_t end_index);
+
+    // Edge over [start_index, end_index) of the line-index section `section`
+    void add_edge(const std::string& id, const std::string& parent, uint32_t color, float alpha,
+                  const std::string& section, uint64_t start_index, uint64_t end_index);
+
+    // The complete file
+    std::string serialize() const;
+
+private:
+    uint32_t intern(const std::string& s);
+    static void push64(std::vector<uint32_t>& v, uint64_t x);
+    static uint32_t float_bits(float f);
+
+    bool enabled_;
+    std::unordered_map<std::string, uint32_t> string_ids_;
+    std::vector<uint32_t> string_offsets_{0};
+    std::string string_data_;
+    std::vector<uint32_t> groups_;
+    std::vector<uint32_t> solids_;
+    std::vector<uint32_t> faces_;
+    std::vector<uint32_t> sections_;
+    std::vector<uint32_t> refs_;
+    std::vector<uint32_t> blocks_;
+    std::vector<uint32_t> edges_;
+    std::vector<uint32_t> attributes_;
+};
+
+// Zero-copy view of a manifest.uvfm image; the tables point into the buffer
+// passed to parse(), which must stay alive and 4-byte aligned
+class UVFBinaryManifestView {
+public:
+    bool parse(const void* data, size_t size, std::string& error);
+
+    size_t count(UVFBinaryManifestTable table) const { return counts_[table]; }
+    // First word of record i of a fixed-size table (groups, solids, faces, sections, refs, blocks, edges, attributes)
+    const uint32_t* record(UVFBinaryManifestTable table, size_t i) const;
+    std::string string_at(uint32_t id) const;
+
+    static uint64_t u64(const uint32_t* words) { return words[0] | (static_cast<uint64_t>(words[1]) << 32); }
+    static float f32(uint32_t word);
+
+private:
+    const uint32_t* tables_[UVF_BM_TABLE_COUNT] = {};
+    uint32_t counts_[UVF_BM_TABLE_COUNT] = {};
+    const char* string_data_ = nullptr;
+};
@@ -0,0 +1,217 @@
+#include "conversion_cache.h"
+#include "hash_utils.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <cstdio>
+
+namespace fs = std::filesystem;
+
+static const char* CACHE_HEADER = "uvf-conversion-cache 1";
+
+namespace {
+    // Fields are tab separated; escape the few characters that would break that
+    string escape_field(const string& s) {
+        string out;
+        out.reserve(s.size());
+        for (char c : s) {
+            if (c == '\\') out += "\\\\";
+            else if (c == '\t') out += "\\t";
+            else if (c == '\n') out += "\\n";
+            else out += c;
+        }
+        return out;
+    }
+
+    string unescape_field(const string& s) {
+        string out;
+        out.reserve(s.size());
+        for (size_t i = 0; i < s.size(); ++i) {
+            if (s[i] == '\\' && i + 1 < s.size()) {
+                char n = s[++i];
+                out += (n == 't') ? '\t' : (n == 'n') ? '\n' : n;
+            } else {
+                out += s[i];
+            }
+        }
+        return out;
+    }
+
+    vector<string> split_tabs(const string& line) {
+        vector<string> parts;
+        size_t start = 0;
+        while (true) {
+            size_t tab = line.find('\t', start);
+            parts.push_back(unescape_field(line.substr(start, tab == string::npos ? string::npos : tab - start)));
+            if (tab == string::npos) break;
+            start = tab + 1;
+        }
+        return parts;
+    }
+
+    // Furthest byte referenced by any section
+    uint64_t sections_extent(const UVFOffsets& offsets) {
+        uint64_t extent = 0;
+        for (const auto& kv : offsets.fields) {
+            uint64_t end = kv.second.offset + kv.second.length;
+            if (end > extent) extent = end;
+        }
+        return extent;
+    }
+}
+
+string conversion_cache_path(const string& uvf_dir) {
+    return uvf_dir + "/.uvf_cache";
+}
+
+bool fingerprint_file(const string& path, FileFingerprint& fp, bool with_hash) {
+    std::error_code ec;
+    auto size = fs::file_size(path, ec);
+    if (ec) return false;
+    auto mtime = fs::last_write_time(path, ec);
+    if (ec) return false;
+    fp.size = size;
+    fp.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    fp.content_hash = 0;
+    return !with_hash || hash_file_content(path, fp.content_hash);
+}
+
+bool hash_file_content(const string& path, uint64_t& hash) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) return false;
+    UVFHasher hasher;
+    std::vector<char> buf(1 << 20);
+    while (ifs) {
+        ifs.read(buf.data(), buf.size());
+        std::streamsize got = ifs.gcount();
+        if (got > 0) hasher.update(buf.data(), static_cast<size_t>(got));
+    }
+    hash = hasher.digest();
+    return true;
+}
+
+bool ConversionCache::load(const string& cache_path) {
+    entries_.clear();
+    std::ifstream ifs(cache_path);
+    if (!ifs) return false;
+    string line;
+    if (!std::getline(ifs, line) || line != CACHE_HEADER) return false;
+    ConversionCacheEntry* current = nullptr;
+    try {
+        while (std::getline(ifs, line)) {
+            auto parts = split_tabs(line);
+            if (parts[0] == "entry" && parts.size() == 7) {
+                ConversionCacheEntry e;
+                e.input_path = parts[1];
+                e.fingerprint.size = std::stoull(parts[2]);
+                e.fingerprint.mtime = std::stoll(parts[3]);
+                e.fingerprint.content_hash = std::stoull(parts[4], nullptr, 16);
+                e.options_key = parts[5];
+                e.label = parts[6];
+                current = &(entries_[e.input_path] = e);
+            } else if (parts[0] == "field" && (parts.size() == 6 || parts.size() == 10 || parts.size() == 12 ||
+                                                  parts.size() == 13) && current) {
+                UVFOffsets::Info info;
+                info.offset = std::stoull(parts[2]);
+                info.length = std::stoull(parts[3]);
+                info.dType = parts[4];
+                info.dimension = std::stoi(parts[5]);
+                if (parts.size() >= 10 && !parts[6].empty()) {
+                    // Compressed section: codec, raw length, block size, comma-separated block sizes
+                    info.blocks.codec = parts[6];
+                    info.blocks.raw_length = std::stoull(parts[7]);
+                    info.blocks.block_size = static_cast<uint32_t>(std::stoul(parts[8]));
+                    std::istringstream sizes(parts[9]);
+                    string size;
+                    while (std::getline(sizes, size, ',')) info.blocks.sizes.push_back(static_cast<uint32_t>(std::stoul(size)));
+                }
+                if (parts.size() >= 12) {
+                    // Encoding and decoded length
+                    info.encoding = parts[10];
+                    info.decoded_length = std::stoull(parts[11]);
+                }
+                if (parts.size() == 13) info.constant_bits = static_cast<uint32_t>(std::stoul(parts[12]));
+                current->offsets.fields[parts[1]] = info;
+            } else if (parts[0] == "attribute" && parts.size() == 5 && current) {
+                // Interleaved attribute of the preceding field: section, name, offset, dimension
+                UVFInterleavedAttribute a;
+                a.name = parts[2];
+                a.offset = static_cast<uint32_t>(std::stoul(parts[3]));
+                a.dimension = std::stoi(parts[4]);
+                current->offsets.fields[parts[1]].interleaved.push_back(a);
+            }
+        }
+    } catch (const std::exception&) {
+        // Corrupt cache: start from scratch rather than trusting partial data
+        entries_.clear();
+        return false;
+    }
+    return true;
+}
+
+bool ConversionCache::save(const string& cache_path) const {
+    string tmp_path = cache_path + ".tmp";
+    {
+        std::ofstream ofs(tmp_path);
+        if (!ofs) return false;
+        ofs << CACHE_HEADER << "\n";
+        for (const auto& kv : entries_) {
+            const auto& e = kv.second;
+            ofs << "entry\t" << escape_field(e.input_path) << "\t" << e.fingerprint.size << "\t"
+                << e.fingerprint.mtime << "\t" << hash_to_hex(e.fingerprint.content_hash) << "\t"
+                << escape_field(e.options_key) << "\t" << escape_field(e.label) << "\n";
+            for (const auto& f : e.offsets.fields) {
+                ofs << "field\t" << escape_field(f.first) << "\t" << f.second.offset << "\t"
+                    << f.second.length << "\t" << escape_field(f.second.dType) << "\t"
+                    << f.second.dimension;
+                const UVFSectionBlocks& blocks = f.second.blocks;
+                if (!blocks.codec.empty() || !f.second.encoding.empty()) {
+                    ofs << "\t" << escape_field(blocks.codec) << "\t" << blocks.raw_length << "\t" << blocks.block_size << "\t";
+                    for (size_t b = 0; b < blocks.sizes.size(); ++b) ofs << (b ? "," : "") << blocks.sizes[b];
+                }
+                if (!f.second.encoding.empty()) {
+                    ofs << "\t" << escape_field(f.second.encoding) << "\t" << f.second.decoded_length;
+                    if (f.second.encoding == UVF_CONSTANT_ENCODING) ofs << "\t" << f.second.constant_bits;
+                }
+                ofs << "\n";
+                for (const auto& a : f.second.interleaved) {
+                    ofs << "attribute\t" << escape_field(f.first) << "\t" << escape_field(a.name) << "\t"
+                        << a.offset << "\t" << a.dimension << "\n";
+                }
+            }
+        }
+        ofs.close();
+        if (!ofs) { std::remove(tmp_path.c_str()); return false; }
+    }
+    std::error_code ec;
+    fs::rename(tmp_path, cache_path, ec);
+    if (ec) { std::remove(tmp_path.c_str()); return false; }
+    return true;
+}
+
+bool ConversionCache::lookup(const string& input_path, const FileFingerprint& current, const string& label,
+                             const string& options_key, const string& bin_path, ConversionCacheEntry& out) const {
+    auto it = entries_.find(input_path);
+    if (it == entries_.end()) return false;
+    const auto& cached = it->second;
+    if (cached.label != label || cached.options_key != options_key) return false;
+    if (current.size != cached.fingerprint.size) return false;
+
+    std::error_code ec;
+    auto bin_size = fs::file_size(bin_path, ec);
+    if (ec || bin_size < sections_extent(cached.offsets)) return false;
+
+    out = cached;
+    if (current.mtime == cached.fingerprint.mtime) return true;
+    // Touched but possibly identical: confirm by content
+    FileFingerprint fp = current;
+    if (!hash_file_content(input_path, fp.content_hash)) return false;
+    if (fp.content_hash != cached.fingerprint.content_hash) return false;
+    out.fingerprint = fp;
+    return true;
+}
+
+void ConversionCache::store(const ConversionCacheEntry& entry) {
+    entries_[entry.input_path] = entry;
+}
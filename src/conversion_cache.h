@@ -0,0 +1,54 @@
+#pragma once
+#include "vtp_to_uvf.h"
+#include <cstdint>
+#include <string>
+#include <map>
+
+// Identity of an input file as seen by the conversion cache
+struct FileFingerprint {
+    uint64_t size = 0;
+    int64_t mtime = 0;         // filesystem clock ticks
+    uint64_t content_hash = 0; // 0 when not computed
+};
+
+// One converted input: where its sections were written and how
+struct ConversionCacheEntry {
+    string input_path;
+    FileFingerprint fingerprint;
+    string options_key;
+    string label;       // bin file stem inside the output directory
+    UVFOffsets offsets;
+};
+
+// Persistent per-output-directory record of converted inputs
+class ConversionCache {
+public:
+    // Missing or unreadable cache files load as empty
+    bool load(const string& cache_path);
+    // Written to a temporary file and renamed into place
+    bool save(const string& cache_path) const;
+
+    // Succeeds when input_path, whose size and mtime are in current (as stat'ed
+    // by the caller), still matches its recorded fingerprint (falling back to
+    // the content hash when only mtime moved), was produced with the same
+    // options and label, and its bin is still present. On success the returned
+    // entry carries the refreshed fingerprint.
+    bool lookup(const string& input_path, const FileFingerprint& current, const string& label,
+                const string& options_key, const string& bin_path, ConversionCacheEntry& out) const;
+
+    void store(const ConversionCacheEntry& entry);
+    size_t size() const { return entries_.size(); }
+    const map<string, ConversionCacheEntry>& entries() const { return entries_; }
+
+private:
+    map<string, ConversionCacheEntry> entries_; // keyed by input path
+};
+
+// Default cache location for an output directory
+string conversion_cache_path(const string& uvf_dir);
+
+// Stat a file; with_hash also reads it fully to compute the content hash
+bool fingerprint_file(const string& path, FileFingerprint& fp, bool with_hash);
+
+// Read a file fully and hash its content
+bool hash_file_content(const string& path, uint64_t& hash);
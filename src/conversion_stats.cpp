@@ -0,0 +1,129 @@
+#include "conversion_stats.h"
+#include <sstream>
+#include <iomanip>
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+uint64_t current_peak_rss_bytes() {
+#if defined(__linux__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024; // kilobytes on Linux
+#elif defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return static_cast<uint64_t>(usage.ru_maxrss); // bytes on macOS
+#else
+    return 0;
+#endif
+}
+
+void UVFConversionStats::reset() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    stages_.clear();
+    points_ = triangles_ = files_ = groups_ = bytes_written_ = peak_rss_ = 0;
+    total_seconds_ = 0;
+    running_ = false;
+}
+
+void UVFConversionStats::start() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    start_ = std::chrono::steady_clock::now();
+    running_ = true;
+    sample_rss_locked();
+}
+
+void UVFConversionStats::finish() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (running_) {
+        std::chrono::duration<double> d = std::chrono::steady_clock::now() - start_;
+        total_seconds_ = d.count();
+        running_ = false;
+    }
+    sample_rss_locked();
+}
+
+void UVFConversionStats::sample_rss_locked() {
+    uint64_t rss = current_peak_rss_bytes();
+    if (rss > peak_rss_) peak_rss_ = rss;
+}
+
+void UVFConversionStats::add_stage(const std::string& name, double seconds, uint64_t bytes, uint64_t items) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    UVFStageStats* stage = nullptr;
+    for (auto& s : stages_) {
+        if (s.name == name) { stage = &s; break; }
+    }
+    if (!stage) {
+        stages_.push_back(UVFStageStats());
+        stage = &stages_.back();
+        stage->name = name;
+    }
+    stage->seconds += seconds;
+    stage->bytes += bytes;
+    stage->items += items;
+    stage->calls += 1;
+    sample_rss_locked();
+}
+
+void UVFConversionStats::add_counts(uint64_t points, uint64_t triangles, uint64_t files) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    points_ += points;
+    triangles_ += triangles;
+    files_ += files;
+}
+
+void UVFConversionStats::set_groups(uint64_t groups) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    groups_ = groups;
+}
+
+void UVFConversionStats::add_bytes_written(uint64_t bytes) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    bytes_written_ += bytes;
+}
+
+std::vector<UVFStageStats> UVFConversionStats::stages() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return stages_;
+}
+
+uint64_t UVFConversionStats::points() const { std::lock_guard<std::mutex> lk(mutex_); return points_; }
+uint64_t UVFConversionStats::triangles() const { std::lock_guard<std::mutex> lk(mutex_); return triangles_; }
+uint64_t UVFConversionStats::files() const { std::lock_guard<std::mutex> lk(mutex_); return files_; }
+uint64_t UVFConversionStats::groups() const { std::lock_guard<std::mutex> lk(mutex_); return groups_; }
+uint64_t UVFConversionStats::bytes_written() const { std::lock_guard<std::mutex> lk(mutex_); return bytes_written_; }
+uint64_t UVFConversionStats::peak_rss_bytes() const { std::lock_guard<std::mutex> lk(mutex_); return peak_rss_; }
+double UVFConversionStats::total_seconds() const { std::lock_guard<std::mutex> lk(mutex_); return total_seconds_; }
+
+uint64_t UVFConversionStats::bytes_read() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    for (const auto& s : stages_) {
+        if (s.name == "parse") return s.bytes;
+    }
+    return 0;
+}
+
+std::string UVFConversionStats::to_json() const {
+    std::vector<UVFStageStats> stages = this->stages();
+    std::ostringstream oss;
+    oss << std::setprecision(6) << std::fixed;
+    oss << "{\"total_seconds\":" << total_seconds();
+    oss << ",\"points\":" << points();
+    oss << ",\"triangles\":" << triangles();
+    oss << ",\"files\":" << files();
+    oss << ",\"groups\":" << groups();
+    oss << ",\"bytes_read\":" << bytes_read();
+    oss << ",\"bytes_written\":" << bytes_written();
+    oss << ",\"peak_rss_bytes\":" << peak_rss_bytes();
+    oss << ",\"stages\":[";
+    for (size_t i = 0; i < stages.size(); ++i) {
+        const auto& s = stages[i];
+        if (i) oss << ",";
+        oss << "{\"name\":\"" << s.name << "\",\"seconds\":" << s.seconds
+            << ",\"bytes\":" << s.bytes << ",\"items\":" << s.items << ",\"calls\":" << s.calls << "}";
+    }
+    oss << "]}";
+    return oss.str();
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "uvf_options.h"
+#include "conversion_trace.h"
+
+// Accumulated cost of one conversion stage. In directory mode stages run on
+// several workers, so seconds is the sum over workers.
+struct UVFStageStats {
+    std::string name;   // parse, extract, triangulate, segment, write, manifest
+    double seconds = 0;
+    uint64_t bytes = 0; // input bytes for parse, output bytes for write/manifest
+    uint64_t items = 0; // files parsed, points extracted, triangles produced, ...
+    uint64_t calls = 0;
+};
+
+// Counters and stage timings of one conversion. Safe to update from workers.
+class UVFConversionStats {
+public:
+    void reset();
+
+    // Wall-clock span of the whole conversion
+    void start();
+    void finish();
+
+    void add_stage(const std::string& name, double seconds, uint64_t bytes, uint64_t items);
+    void add_counts(uint64_t points, uint64_t triangles, uint64_t files);
+    void set_groups(uint64_t groups);
+    void add_bytes_written(uint64_t bytes);
+
+    // Snapshot of the current values (stages in first-recorded order)
+    std::vector<UVFStageStats> stages() const;
+    uint64_t points() const;
+    uint64_t triangles() const;
+    uint64_t files() const;
+    uint64_t groups() const;
+    uint64_t bytes_read() const;
+    uint64_t bytes_written() const;
+    uint64_t peak_rss_bytes() const;
+    double total_seconds() const;
+
+    // {"total_seconds":..,"points":..,...,"stages":[{"name":..,"seconds":..}]}
+    std::string to_json() const;
+
+private:
+    void sample_rss_locked();
+
+    mutable std::mutex mutex_;
+    std::vector<UVFStageStats> stages_;
+    uint64_t points_ = 0;
+    uint64_t triangles_ = 0;
+    uint64_t files_ = 0;
+    uint64_t groups_ = 0;
+    uint64_t bytes_written_ = 0;
+    uint64_t peak_rss_ = 0;
+    double total_seconds_ = 0;
+    std::chrono::steady_clock::time_point start_;
+    bool running_ = false;
+};
+
+// Peak resident set size of the process so far (0 where unsupported)
+uint64_t current_peak_rss_bytes();
+
+// Times a stage from construction to stop() or destruction into the stats and
+// trace hooks of the options; no-op when neither is set
+class UVFStageTimer {
+public:
+    UVFStageTimer(const UVFOptions& options, const char* stage)
+        : stats_(options.stats), trace_(options.trace), stage_(stage) {
+        if (stats_ || trace_) start_ = std::chrono::steady_clock::now();
+    }
+    ~UVFStageTimer() { stop(); }
+
+    void add_bytes(uint64_t n) { bytes_ += n; }
+    void add_items(uint64_t n) { items_ += n; }
+
+    void stop() {
+        if (!stats_ && !trace_) return;
+        auto end = std::chrono::steady_clock::now();
+        if (stats_) stats_->add_stage(stage_, std::chrono::duration<double>(end - start_).count(), bytes_, items_);
+        if (trace_) trace_->add_span(stage_, "stage", start_, end, std::this_thread::get_id(), std::string());
+        stats_ = nullptr;
+        trace_ = nullptr;
+    }
+
+private:
+    UVFConversionStats* stats_;
+    UVFTraceRecorder* trace_;
+    const char* stage_;
+    std::chrono::steady_clock::time_point start_;
+    uint64_t bytes_ = 0;
+    uint64_t items_ = 0;
+};
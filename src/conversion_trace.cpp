@@ -0,0 +1,91 @@
+#include "conversion_trace.h"
+#include "file_utils.h"
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <iomanip>
+
+namespace {
+    void write_json_string(std::ostream& os, const std::string& s) {
+        os << '"';
+        for (char c : s) {
+            switch (c) {
+            case '"': os << "\\\""; break;
+            case '\\': os << "\\\\"; break;
+            case '\n': os << "\\n"; break;
+            case '\t': os << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    os << buf;
+                } else {
+                    os << c;
+                }
+            }
+        }
+        os << '"';
+    }
+}
+
+UVFTraceRecorder::UVFTraceRecorder() : epoch_(std::chrono::steady_clock::now()) {
+    threads_.emplace(std::this_thread::get_id(), 0);
+}
+
+int UVFTraceRecorder::thread_index_locked(std::thread::id thread) {
+    auto it = threads_.find(thread);
+    if (it != threads_.end()) return it->second;
+    int index = static_cast<int>(threads_.size());
+    threads_.emplace(thread, index);
+    return index;
+}
+
+void UVFTraceRecorder::add_span(const char* name, const char* category, std::chrono::steady_clock::time_point begin,
+                                std::chrono::steady_clock::time_point end, std::thread::id thread,
+                                const std::string& detail) {
+    std::chrono::duration<double, std::micro> ts = begin - epoch_;
+    std::chrono::duration<double, std::micro> dur = end - begin;
+    std::lock_guard<std::mutex> lk(mutex_);
+    spans_.push_back({name, category, ts.count(), dur.count(), thread_index_locked(thread), detail});
+}
+
+size_t UVFTraceRecorder::span_count() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return spans_.size();
+}
+
+std::string UVFTraceRecorder::to_json() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    std::vector<const Span*> ordered;
+    ordered.reserve(spans_.size());
+    for (const auto& s : spans_) ordered.push_back(&s);
+    // Outer spans end last; sorting by start keeps viewers from re-nesting them
+    std::stable_sort(ordered.begin(), ordered.end(), [](const Span* a, const Span* b) { return a->ts_us < b->ts_us; });
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3);
+    oss << "{\"traceEvents\":[";
+    oss << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"uvf\"}}";
+    for (const auto& kv : threads_) {
+        oss << ",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << kv.second << ",\"args\":{\"name\":\"";
+        if (kv.second == 0) oss << "main";
+        else oss << "worker " << kv.second;
+        oss << "\"}}";
+    }
+    for (const Span* s : ordered) {
+        oss << ",{\"name\":\"" << s->name << "\",\"cat\":\"" << s->category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << s->tid
+            << ",\"ts\":" << s->ts_us << ",\"dur\":" << s->dur_us;
+        if (!s->detail.empty()) {
+            oss << ",\"args\":{\"detail\":";
+            write_json_string(oss, s->detail);
+            oss << "}";
+        }
+        oss << "}";
+    }
+    oss << "],\"displayTimeUnit\":\"ms\"}";
+    return oss.str();
+}
+
+bool UVFTraceRecorder::write(const std::string& path) const {
+    return write_file_atomic(path, to_json());
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Collects timed spans from any thread and writes them as Chrome trace-event
+// JSON (open in Perfetto or chrome://tracing). Only enabled runs pay for it:
+// every instrumentation point checks for a null recorder first.
+class UVFTraceRecorder {
+public:
+    UVFTraceRecorder();
+
+    // Record a finished span. ts/dur are relative to the recorder's creation;
+    // detail (may be empty) is shown as the span's "detail" argument.
+    void add_span(const char* name, const char* category, std::chrono::steady_clock::time_point begin,
+                  std::chrono::steady_clock::time_point end, std::thread::id thread, const std::string& detail);
+
+    size_t span_count() const;
+
+    // {"traceEvents":[...],"displayTimeUnit":"ms"}
+    std::string to_json() const;
+    bool write(const std::string& path) const;
+
+private:
+    struct Span {
+        const char* name;
+        const char* category;
+        double ts_us;
+        double dur_us;
+        int tid;
+        std::string detail;
+    };
+
+    int thread_index_locked(std::thread::id thread);
+
+    mutable std::mutex mutex_;
+    std::chrono::steady_clock::time_point epoch_;
+    std::vector<Span> spans_;
+    std::unordered_map<std::thread::id, int> threads_; // small stable ids, 0 = creating thread
+};
+
+// Records one span from construction to end() or destruction; no-op without a recorder
+class UVFTraceSpan {
+public:
+    UVFTraceSpan(UVFTraceRecorder* trace, const char* name, const char* category = "stage")
+        : trace_(trace), name_(name), category_(category) {
+        if (trace_) begin_ = std::chrono::steady_clock::now();
+    }
+    UVFTraceSpan(UVFTraceRecorder* trace, const char* name, const char* category, const std::string& detail)
+        : UVFTraceSpan(trace, name, category) {
+        if (trace_) detail_ = detail;
+    }
+    ~UVFTraceSpan() { end(); }
+
+    void end() {
+        if (!trace_) return;
+        trace_->add_span(name_, category_, begin_, std::chrono::steady_clock::now(), std::this_thread::get_id(), detail_);
+        trace_ = nullptr;
+    }
+
+private:
+    UVFTraceRecorder* trace_;
+    const char* name_;
+    const char* category_;
+    std::chrono::steady_clock::time_point begin_;
+    std::string detail_;
+};
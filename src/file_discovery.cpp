@@ -0,0 +1,142 @@
+#include "file_discovery.h"
+#include "parallel_utils.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+
+namespace fs = std::filesystem;
+
+namespace {
+    bool glob_match_at(const char* p, const char* s) {
+        while (*p) {
+            if (p[0] == '*' && p[1] == '*') {
+                // '**/' may also match zero directories
+                const char* rest = p + 2;
+                if (*rest == '/') {
+                    if (glob_match_at(rest + 1, s)) return true;
+                }
+                for (const char* t = s; ; ++t) {
+                    if (glob_match_at(rest, t)) return true;
+                    if (!*t) return false;
+                }
+            }
+            if (*p == '*') {
+                for (const char* t = s; ; ++t) {
+                    if (glob_match_at(p + 1, t)) return true;
+                    if (!*t || *t == '/') return false;
+                }
+            }
+            if (!*s) return false;
+            if (*p == '?') {
+                if (*s == '/') return false;
+            } else if (*p != *s) {
+                return false;
+            }
+            ++p;
+            ++s;
+        }
+        return *s == 0;
+    }
+
+    bool matches_any(const std::vector<std::string>& globs, const std::string& rel) {
+        for (const auto& g : globs) {
+            if (glob_match(g, rel)) return true;
+        }
+        return false;
+    }
+}
+
+bool glob_match(const std::string& pattern, const std::string& path) {
+    if (pattern.find('/') == std::string::npos) {
+        auto slash = path.find_last_of('/');
+        std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+        return glob_match_at(pattern.c_str(), name.c_str());
+    }
+    return glob_match_at(pattern.c_str(), path.c_str());
+}
+
+bool is_supported_input(const std::string& path) {
+    std::string ext = fs::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".vtk" || ext == ".vtp" || ext == ".stl";
+}
+
+bool discover_input_files(const std::string& root, const UVFOptions& options, std::vector<DiscoveredFile>& files) {
+    files.clear();
+    std::error_code ec;
+    if (!fs::is_directory(root, ec)) return false;
+
+    // Shared work queue of directories (relative to root); a worker that lists a
+    // directory also stats its files, so slow metadata calls overlap
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<std::string> queue;
+    size_t busy = 0;
+    bool failed = false;
+    queue.push_back("");
+
+    auto worker = [&]() {
+        std::vector<DiscoveredFile> local;
+        while (true) {
+            std::string rel_dir;
+            {
+                std::unique_lock<std::mutex> lk(mtx);
+                cv.wait(lk, [&] { return !queue.empty() || busy == 0; });
+                if (queue.empty()) break;
+                rel_dir = std::move(queue.front());
+                queue.pop_front();
+                ++busy;
+            }
+            std::vector<std::string> subdirs;
+            std::error_code dir_ec;
+            fs::path dir = rel_dir.empty() ? fs::path(root) : fs::path(root) / rel_dir;
+            for (fs::directory_iterator it(dir, dir_ec), end; !dir_ec && it != end; it.increment(dir_ec)) {
+                const auto& entry = *it;
+                std::string name = entry.path().filename().string();
+                std::string rel = rel_dir.empty() ? name : rel_dir + "/" + name;
+                std::error_code st_ec;
+                // Do not follow directory symlinks: avoids cycles in case trees
+                if (entry.is_directory(st_ec) && !entry.is_symlink(st_ec)) {
+                    if (options.recursive && !matches_any(options.exclude_globs, rel)) subdirs.push_back(rel);
+                    continue;
+                }
+                if (!entry.is_regular_file(st_ec) || !is_supported_input(name)) continue;
+                if (!options.include_globs.empty() && !matches_any(options.include_globs, rel)) continue;
+                if (matches_any(options.exclude_globs, rel)) continue;
+                DiscoveredFile f;
+                f.path = entry.path().string();
+                f.relative_path = rel;
+                f.size = entry.file_size(st_ec);
+                auto mtime = entry.last_write_time(st_ec);
+                if (!st_ec) f.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+                local.push_back(std::move(f));
+            }
+            {
+                std::lock_guard<std::mutex> lk(mtx);
+                if (dir_ec && rel_dir.empty()) failed = true;
+                for (auto& d : subdirs) queue.push_back(std::move(d));
+                --busy;
+            }
+            cv.notify_all();
+        }
+        std::lock_guard<std::mutex> lk(mtx);
+        for (auto& f : local) files.push_back(std::move(f));
+    };
+
+    int threads = options.recursive ? resolve_thread_count(options.threads) : 1;
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+
+    if (failed) {
+        std::cerr << "Error reading directory: " << root << std::endl;
+        return false;
+    }
+    std::sort(files.begin(), files.end(),
+              [](const DiscoveredFile& a, const DiscoveredFile& b) { return a.relative_path < b.relative_path; });
+    return true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "uvf_options.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// An input file found under a directory root
+struct DiscoveredFile {
+    std::string path;          // full path as passed to the readers
+    std::string relative_path; // relative to the root, '/' separated
+    // Stat'ed during discovery; directory mode's progress and incremental
+    // cache use them instead of stat'ing again
+    uint64_t size = 0;
+    int64_t mtime = 0;         // filesystem clock ticks
+};
+
+// Find convertible inputs (.vtk/.vtp/.stl) under root. Subdirectories are walked
+// in parallel (options.threads) when options.recursive is set; each file is
+// stat'ed by the worker that listed it. options.include_globs (if any) must match
+// and options.exclude_globs must not. Results are sorted by relative_path.
+bool discover_input_files(
+    const std::string& root,
+    const UVFOptions& options,
+    std::vector<DiscoveredFile>& files
+);
+
+// Glob match against a '/' separated relative path: '*' and '?' stay within one
+// path segment, '**' spans segments. Patterns without '/' match the file name.
+bool glob_match(const std::string& pattern, const std::string& path);
+
+// True for extensions the converters accept (.vtk, .vtp, .stl; case-insensitive)
+bool is_supported_input(const std::string& path);
@@ -0,0 +1,29 @@
+#include "file_utils.h"
+#include <filesystem>
+#include <fstream>
+#include <cstdio>
+
+bool write_file_atomic(const std::string& path, const std::string& content) {
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream ofs(tmp_path, std::ios::binary);
+        if (!ofs) return false;
+        ofs << content;
+        ofs.close();
+        if (!ofs) {
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+    }
+    return commit_file(tmp_path, path);
+}
+
+bool commit_file(const std::string& tmp_path, const std::string& path) {
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
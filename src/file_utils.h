@@ -0,0 +1,9 @@
+#pragma once
+#include <string>
+
+// Write content to a sibling temporary file and rename it over path, so readers
+// never observe a partially written file
+bool write_file_atomic(const std::string& path, const std::string& content);
+
+// Rename a fully written temporary file over its final path (replacing it)
+bool commit_file(const std::string& tmp_path, const std::string& path);
@@ -0,0 +1,83 @@
+#include "hash_utils.h"
+#include <cstring>
+
+namespace {
+    const uint64_t P1 = 11400714785074694791ULL;
+    const uint64_t P2 = 14029467366897019727ULL;
+    const uint64_t P3 = 1609587929392839161ULL;
+    const uint64_t P4 = 9650029242287828579ULL;
+    const uint64_t P5 = 2870177450012600261ULL;
+
+    inline uint64_t rotl(uint64_t x, int r){ return (x << r) | (x >> (64 - r)); }
+    inline uint64_t read64(const unsigned char* p){ uint64_t v; std::memcpy(&v, p, 8); return v; }
+    inline uint32_t read32(const unsigned char* p){ uint32_t v; std::memcpy(&v, p, 4); return v; }
+    inline uint64_t round(uint64_t acc, uint64_t input){ acc += input * P2; acc = rotl(acc, 31); return acc * P1; }
+    inline uint64_t merge(uint64_t acc, uint64_t val){ acc ^= round(0, val); return acc * P1 + P4; }
+}
+
+UVFHasher::UVFHasher(uint64_t seed) : seed_(seed) {
+    acc_[0] = seed + P1 + P2;
+    acc_[1] = seed + P2;
+    acc_[2] = seed;
+    acc_[3] = seed - P1;
+}
+
+void UVFHasher::update(const void* data, size_t len) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    total_ += len;
+    // Top up a partially filled stripe first
+    if (buf_len_ > 0) {
+        size_t take = 32 - buf_len_;
+        if (take > len) take = len;
+        std::memcpy(buf_ + buf_len_, p, take);
+        buf_len_ += take; p += take; len -= take;
+        if (buf_len_ < 32) return;
+        for (int i = 0; i < 4; ++i) acc_[i] = round(acc_[i], read64(buf_ + i * 8));
+        buf_len_ = 0;
+    }
+    while (len >= 32) {
+        acc_[0] = round(acc_[0], read64(p));
+        acc_[1] = round(acc_[1], read64(p + 8));
+        acc_[2] = round(acc_[2], read64(p + 16));
+        acc_[3] = round(acc_[3], read64(p + 24));
+        p += 32; len -= 32;
+    }
+    if (len > 0) { std::memcpy(buf_, p, len); buf_len_ = len; }
+}
+
+uint64_t UVFHasher::digest() const {
+    uint64_t h;
+    if (total_ >= 32) {
+        h = rotl(acc_[0], 1) + rotl(acc_[1], 7) + rotl(acc_[2], 12) + rotl(acc_[3], 18);
+        for (int i = 0; i < 4; ++i) h = merge(h, acc_[i]);
+    } else {
+        h = seed_ + P5;
+    }
+    h += total_;
+    const unsigned char* p = buf_;
+    size_t len = buf_len_;
+    while (len >= 8) { h ^= round(0, read64(p)); h = rotl(h, 27) * P1 + P4; p += 8; len -= 8; }
+    if (len >= 4) { h ^= static_cast<uint64_t>(read32(p)) * P1; h = rotl(h, 23) * P2 + P3; p += 4; len -= 4; }
+    while (len > 0) { h ^= (*p) * P5; h = rotl(h, 11) * P1; ++p; --len; }
+    h ^= h >> 33; h *= P2;
+    h ^= h >> 29; h *= P3;
+    h ^= h >> 32;
+    return h;
+}
+
+std::string UVFHasher::hex_digest() const {
+    return hash_to_hex(digest());
+}
+
+uint64_t hash_bytes(const void* data, size_t len, uint64_t seed) {
+    UVFHasher h(seed);
+    h.update(data, len);
+    return h.digest();
+}
+
+std::string hash_to_hex(uint64_t h) {
+    static const char digits[] = "0123456789abcdef";
+    std::string out(16, '0');
+    for (int i = 15; i >= 0; --i) { out[i] = digits[h & 0xF]; h >>= 4; }
+    return out;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// Streaming 64-bit content hash (xxHash64 layout); chunking does not affect the digest
+class UVFHasher {
+public:
+    explicit UVFHasher(uint64_t seed = 0);
+
+    void update(const void* data, size_t len);
+    uint64_t digest() const;
+    // 16 lowercase hex characters, suitable for file names
+    std::string hex_digest() const;
+
+private:
+    uint64_t acc_[4];
+    uint64_t seed_;
+    uint64_t total_ = 0;
+    unsigned char buf_[32];
+    size_t buf_len_ = 0;
+};
+
+// One-shot helper over a single buffer
+uint64_t hash_bytes(const void* data, size_t len, uint64_t seed = 0);
+
+// Format a 64-bit hash as 16 lowercase hex characters
+std::string hash_to_hex(uint64_t h);
@@ -0,0 +1,152 @@
+#include "json_writer.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+UVFJsonWriter::UVFJsonWriter(std::ostream* os) : os_(os) {
+    needs_comma_.reserve(16);
+}
+
+UVFJsonWriter::~UVFJsonWriter() { flush(); }
+
+void UVFJsonWriter::drain() {
+    if (len_ == 0) return;
+    if (os_ && ok_) {
+        os_->write(buf_, static_cast<std::streamsize>(len_));
+        if (!*os_) ok_ = false;
+    }
+    len_ = 0;
+}
+
+bool UVFJsonWriter::flush() {
+    drain();
+    if (os_ && ok_) {
+        os_->flush();
+        if (!*os_) ok_ = false;
+    }
+    return ok_;
+}
+
+void UVFJsonWriter::put(std::string_view s) {
+    bytes_ += s.size();
+    while (!s.empty()) {
+        if (len_ == sizeof(buf_)) drain();
+        size_t n = std::min(s.size(), sizeof(buf_) - len_);
+        std::memcpy(buf_ + len_, s.data(), n);
+        len_ += n;
+        s.remove_prefix(n);
+    }
+}
+
+void UVFJsonWriter::before_value() {
+    if (after_key_) {
+        after_key_ = false;
+        return;
+    }
+    if (!needs_comma_.empty()) {
+        if (needs_comma_.back()) put(',');
+        needs_comma_.back() = true;
+    }
+}
+
+void UVFJsonWriter::begin_object() {
+    before_value();
+    put('{');
+    needs_comma_.push_back(false);
+}
+
+void UVFJsonWriter::end_object() {
+    needs_comma_.pop_back();
+    put('}');
+}
+
+void UVFJsonWriter::begin_array() {
+    before_value();
+    put('[');
+    needs_comma_.push_back(false);
+}
+
+void UVFJsonWriter::end_array() {
+    needs_comma_.pop_back();
+    put(']');
+}
+
+void UVFJsonWriter::key(std::string_view name) {
+    before_value();
+    write_escaped(name);
+    put(':');
+    after_key_ = true;
+}
+
+void UVFJsonWriter::value(std::string_view s) {
+    before_value();
+    write_escaped(s);
+}
+
+void UVFJsonWriter::value(bool b) {
+    before_value();
+    put(b ? std::string_view("true") : std::string_view("false"));
+}
+
+void UVFJsonWriter::value(double d) {
+    before_value();
+    if (!std::isfinite(d)) {
+        put("null");
+        return;
+    }
+    char tmp[32];
+    auto res = std::to_chars(tmp, tmp + sizeof(tmp), d, std::chars_format::general, 6);
+    put(std::string_view(tmp, static_cast<size_t>(res.ptr - tmp)));
+}
+
+void UVFJsonWriter::write_int(int64_t v) {
+    before_value();
+    char tmp[24];
+    auto res = std::to_chars(tmp, tmp + sizeof(tmp), v);
+    put(std::string_view(tmp, static_cast<size_t>(res.ptr - tmp)));
+}
+
+void UVFJsonWriter::write_uint(uint64_t v) {
+    before_value();
+    char tmp[24];
+    auto res = std::to_chars(tmp, tmp + sizeof(tmp), v);
+    put(std::string_view(tmp, static_cast<size_t>(res.ptr - tmp)));
+}
+
+void UVFJsonWriter::raw_value(std::string_view json) {
+    before_value();
+    put(json);
+}
+
+void UVFJsonWriter::write_escaped(std::string_view s) {
+    static const char hex[] = "0123456789abcdef";
+    put('"');
+    // Copy runs of plain characters in one go; only quotes, backslashes and
+    // control characters need rewriting (UTF-8 passes through unchanged)
+    size_t run = 0;
+    for (size_t i = 0; i < s.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        put(s.substr(run, i - run));
+        char esc[6] = {'\\', 0, 0, 0, 0, 0};
+        size_t n = 2;
+        switch (c) {
+            case '"':  esc[1] = '"'; break;
+            case '\\': esc[1] = '\\'; break;
+            case '\b': esc[1] = 'b'; break;
+            case '\f': esc[1] = 'f'; break;
+            case '\n': esc[1] = 'n'; break;
+            case '\r': esc[1] = 'r'; break;
+            case '\t': esc[1] = 't'; break;
+            default:
+                esc[1] = 'u'; esc[2] = '0'; esc[3] = '0';
+                esc[4] = hex[c >> 4]; esc[5] = hex[c & 0xf];
+                n = 6;
+        }
+        put(std::string_view(esc, n));
+        run = i + 1;
+    }
+    put(s.substr(run));
+    put('"');
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Streaming JSON writer used by all manifest generators. Output goes through a
+// small fixed buffer straight into an ostream (or is only counted when the
+// stream is null, to size an entry before writing it). Strings are escaped,
+// numbers are formatted with std::to_chars, commas are inserted automatically.
+class UVFJsonWriter {
+public:
+    explicit UVFJsonWriter(std::ostream* os);
+    ~UVFJsonWriter();
+
+    UVFJsonWriter(const UVFJsonWriter&) = delete;
+    UVFJsonWriter& operator=(const UVFJsonWriter&) = delete;
+
+    void begin_object();
+    void end_object();
+    void begin_array();
+    void end_array();
+
+    // Object member name; the next value call supplies its value
+    void key(std::string_view name);
+
+    void value(std::string_view s);
+    void value(const char* s) { value(std::string_view(s)); }
+    void value(const std::string& s) { value(std::string_view(s)); }
+    void value(bool b);
+    // Shortest %g-style form with 6 significant digits (matches ostream defaults);
+    // NaN and infinities are written as null
+    void value(double d);
+    void value(float f) { value(static_cast<double>(f)); }
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+    void value(T v) {
+        if (std::is_signed<T>::value) write_int(static_cast<int64_t>(v));
+        else write_uint(static_cast<uint64_t>(v));
+    }
+
+    // Pre-formatted JSON (a literal such as 1.0 or a constant array)
+    void raw_value(std::string_view json);
+
+    // Push buffered bytes to the stream; false once any write has failed
+    bool flush();
+    bool ok() const { return ok_; }
+
+    // Bytes produced so far, including those still buffered
+    uint64_t bytes_written() const { return bytes_; }
+
+private:
+    void before_value();
+    void write_int(int64_t v);
+    void write_uint(uint64_t v);
+    void write_escaped(std::string_view s);
+    void put(char c) {
+        if (len_ == sizeof(buf_)) drain();
+        buf_[len_++] = c;
+        ++bytes_;
+    }
+    void put(std::string_view s);
+    void drain();
+
+    std::ostream* os_;
+    char buf_[16384];
+    size_t len_ = 0;
+    uint64_t bytes_ = 0;
+    bool ok_ = true;
+    bool after_key_ = false;
+    std::vector<bool> needs_comma_; // one entry per open container
+};
@@ -1,17 +1,44 @@
 #include "vtp_to_uvf.h"
 #include "vtk_structured_parser.h"
 #include "multi_file_parser.h"
+#include "time_series.h"
+#include "watch_mode.h"
+#include "conversion_stats.h"
+#include "conversion_trace.h"
 #include <vtkXMLPolyDataReader.h>
 #include <vtkSmartPointer.h>
 #include <iostream>
 #include <string>
+#include <sstream>
 #include <cstring>
+#include <cstdlib>
 #include <filesystem>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+
+// Set by SIGINT/SIGTERM: ends watch mode, or cancels a running conversion
+static std::atomic<bool> g_stop_requested(false);
+
+static void handle_stop_signal(int) {
+    g_stop_requested = true;
+}
+
+// One-line progress display on stderr
+static void print_progress(const UVFProgress& p) {
+    std::cerr << "\r[" << p.stage << "]";
+    if (p.items_total > 0) std::cerr << " " << p.items_done << "/" << p.items_total;
+    if (p.bytes_total > 0) std::cerr << " " << (p.bytes_done * 100 / p.bytes_total) << "%";
+    std::cerr << "        " << std::flush;
+    if (std::strcmp(p.stage, "manifest") == 0) std::cerr << std::endl;
+}
 
 int main(int argc, char** argv) {
     if (argc < 3) {
         std::cout << "Usage: " << argv[0] << " input.[vtp|vtk|stl] output_dir [--structured]" << std::endl;
         std::cout << "   or: " << argv[0] << " input_dir/ output_dir --directory" << std::endl;
+        std::cout << "   or: " << argv[0] << " series.pvd|steps_dir/ output_dir --time-series" << std::endl;
         std::cout << std::endl;
         std::cout << "Supported input formats:" << std::endl;
         std::cout << "  .vtp  - VTK XML PolyData" << std::endl;
@@ -21,6 +48,33 @@ int main(int argc, char** argv) {
         std::cout << "Options:" << std::endl;
         std::cout << "  --structured  Use structured parsing based on field names" << std::endl;
         std::cout << "  --directory   Process all VTK files in input directory with structured parsing" << std::endl;
+        std::cout << "  --content-hash  Name bin files by content hash (stable across re-conversions)" << std::endl;
+        std::cout << "  --binary-manifest  Also write manifest.uvfm, a compact binary manifest for fast viewer startup" << std::endl;
+        std::cout << "  --container     Pack the output into a single scene.uvfc file (mmap/range-request friendly)" << std::endl;
+        std::cout << "  --compression=none|deflate  Compress bin sections in independently decodable blocks" << std::endl;
+        std::cout << "  --compression-block-size=N  Raw bytes per compressed block (default: 1048576)" << std::endl;
+        std::cout << "  --mesh-codecs   Delta-varint indices and byte-plane positions (use with --compression=deflate)" << std::endl;
+        std::cout << "  --reorder=none|morton  Sort vertices along a Morton curve and triangles by index for locality" << std::endl;
+        std::cout << "  --normals=none|float32|oct16  Precompute per-face vertex normals as a \"normal\" section" << std::endl;
+        std::cout << "  --bvh           Add a flat BVH (\"bvhNodes\", \"bvhTriangles\") for ray picking and culling" << std::endl;
+        std::cout << "  --feature-edges[=DEG]  Boundary, non-manifold and sharp edges (default 30 degrees) as Edge nodes" << std::endl;
+        std::cout << "  --vertex-layout=separate|interleaved|both  Interleave per-vertex arrays into a \"vertices\" section" << std::endl;
+        std::cout << "  --interleave=A,B,...  Attributes interleaved after position (default: normal, then all by name)" << std::endl;
+        std::cout << "  --face-ids      Add a per-triangle \"faceId\" section mapping picked triangles to faces" << std::endl;
+        std::cout << "  --elide-sections  Store constant arrays in the manifest and alias duplicate arrays" << std::endl;
+        std::cout << "  --incremental   With --directory, only reconvert inputs changed since the last run" << std::endl;
+        std::cout << "  --watch         With --directory, keep running and reconvert inputs as they change" << std::endl;
+        std::cout << "  --recursive     With --directory, also convert inputs in subdirectories" << std::endl;
+        std::cout << "  --include=GLOB  With --directory, only convert matching relative paths (repeatable)" << std::endl;
+        std::cout << "  --exclude=GLOB  With --directory, skip matching files and subdirectories (repeatable)" << std::endl;
+        std::cout << "  --threads=N     Worker threads for parallel stages (default: all cores)" << std::endl;
+        std::cout << "  --progress      Report conversion progress on stderr" << std::endl;
+        std::cout << "  --stats=json    Print stage timings, counters and peak memory as JSON (last line of stdout)" << std::endl;
+        std::cout << "  --trace=FILE    Write stage and per-file spans as Chrome trace-event JSON (open in Perfetto)" << std::endl;
+        std::cout << "  --time-series   Convert a .pvd collection (or a directory of steps, in name order)" << std::endl;
+        std::cout << "                  writing shared geometry once and per-step scalar sections" << std::endl;
+        std::cout << "  --time-encoding=none|delta|xor  Encode step scalars against the previous step" << std::endl;
+        std::cout << "  --keyframe-interval=N           Store every Nth step unencoded" << std::endl;
         return 1;
     }
 
@@ -28,6 +82,13 @@ int main(int argc, char** argv) {
     const char* uvf_dir = argv[2];
     bool use_structured = false;
     bool use_directory = false;
+    bool use_time_series = false;
+    bool use_watch = false;
+    bool print_stats = false;
+    UVFOptions options;
+    UVFConversionStats stats;
+    UVFTraceRecorder trace;
+    const char* trace_path = nullptr;
 
     // Check for flags
     for (int i = 3; i < argc; ++i) {
@@ -35,16 +96,138 @@ int main(int argc, char** argv) {
             use_structured = true;
         } else if (strcmp(argv[i], "--directory") == 0) {
             use_directory = true;
+        } else if (strcmp(argv[i], "--content-hash") == 0) {
+            options.content_hash_names = true;
+        } else if (strcmp(argv[i], "--binary-manifest") == 0) {
+            options.binary_manifest = true;
+        } else if (strcmp(argv[i], "--container") == 0) {
+            options.container = true;
+        } else if (strncmp(argv[i], "--compression=", 14) == 0) {
+            if (!set_uvf_option(options, "compression", argv[i] + 14)) {
+                std::cerr << "Unsupported compression: " << (argv[i] + 14) << " (expected none or deflate)" << std::endl;
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--compression-block-size=", 25) == 0) {
+            if (!set_uvf_option(options, "compression_block_size", argv[i] + 25)) {
+                std::cerr << "Invalid compression block size: " << (argv[i] + 25) << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--mesh-codecs") == 0) {
+            options.mesh_codecs = true;
+        } else if (strncmp(argv[i], "--reorder=", 10) == 0) {
+            if (!set_uvf_option(options, "reorder", argv[i] + 10)) {
+                std::cerr << "Unknown reorder mode: " << (argv[i] + 10) << " (expected none or morton)" << std::endl;
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--normals=", 10) == 0) {
+            if (!set_uvf_option(options, "normals", argv[i] + 10)) {
+                std::cerr << "Unknown normals mode: " << (argv[i] + 10) << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--bvh") == 0) {
+            options.bvh = true;
+        } else if (strcmp(argv[i], "--feature-edges") == 0) {
+            options.feature_edges = true;
+        } else if (strncmp(argv[i], "--feature-edges=", 16) == 0) {
+            options.feature_edges = true;
+            if (!set_uvf_option(options, "feature_angle", argv[i] + 16)) {
+                std::cerr << "Invalid feature angle: " << (argv[i] + 16) << std::endl;
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--vertex-layout=", 16) == 0) {
+            if (!set_uvf_option(options, "vertex_layout", argv[i] + 16)) {
+                std::cerr << "Unknown vertex layout: " << (argv[i] + 16) << " (expected separate, interleaved or both)" << std::endl;
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--interleave=", 13) == 0) {
+            std::stringstream names(argv[i] + 13);
+            std::string name;
+            while (std::getline(names, name, ',')) {
+                if (!name.empty()) set_uvf_option(options, "interleaved_attribute", name);
+            }
+        } else if (strcmp(argv[i], "--face-ids") == 0) {
+            options.face_ids = true;
+        } else if (strcmp(argv[i], "--elide-sections") == 0) {
+            options.elide_sections = true;
+        } else if (strcmp(argv[i], "--incremental") == 0) {
+            options.incremental = true;
+        } else if (strcmp(argv[i], "--watch") == 0) {
+            use_watch = true;
+        } else if (strcmp(argv[i], "--recursive") == 0) {
+            options.recursive = true;
+        } else if (strncmp(argv[i], "--include=", 10) == 0) {
+            options.include_globs.push_back(argv[i] + 10);
+        } else if (strncmp(argv[i], "--exclude=", 10) == 0) {
+            options.exclude_globs.push_back(argv[i] + 10);
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            if (!set_uvf_option(options, "threads", argv[i] + 10)) {
+                std::cerr << "Invalid thread count: " << (argv[i] + 10) << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--progress") == 0) {
+            options.progress = print_progress;
+        } else if (strcmp(argv[i], "--stats=json") == 0) {
+            print_stats = true;
+            options.stats = &stats;
+        } else if (strncmp(argv[i], "--trace=", 8) == 0) {
+            trace_path = argv[i] + 8;
+            options.trace = &trace;
+        } else if (strncmp(argv[i], "--stats=", 8) == 0) {
+            std::cerr << "Unsupported stats format: " << (argv[i] + 8) << " (expected json)" << std::endl;
+            return 1;
+        } else if (strcmp(argv[i], "--time-series") == 0) {
+            use_time_series = true;
+        } else if (strncmp(argv[i], "--time-encoding=", 16) == 0) {
+            if (!set_uvf_option(options, "time_encoding", argv[i] + 16)) {
+                std::cerr << "Unknown time encoding: " << (argv[i] + 16) << " (expected none, delta or xor)" << std::endl;
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--keyframe-interval=", 20) == 0) {
+            if (!set_uvf_option(options, "time_keyframe_interval", argv[i] + 20)) {
+                std::cerr << "Invalid keyframe interval: " << (argv[i] + 20) << std::endl;
+                return 1;
+            }
         }
     }
 
     bool success = false;
 
-    if (use_directory) {
+    // Ctrl-C stops a conversion cleanly instead of leaving partial output
+    std::signal(SIGINT, handle_stop_signal);
+    std::signal(SIGTERM, handle_stop_signal);
+    options.cancel = &g_stop_requested;
+    stats.start();
+
+    if (use_time_series) {
+        std::vector<std::string> files;
+        std::vector<double> times;
+        if (std::filesystem::is_directory(input_path)) {
+            for (const auto& entry : std::filesystem::directory_iterator(input_path)) {
+                std::string ext = entry.path().extension().string();
+                std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+                if (entry.is_regular_file() && (ext == ".vtp" || ext == ".vtk" || ext == ".stl")) {
+                    files.push_back(entry.path().string());
+                }
+            }
+            std::sort(files.begin(), files.end());
+            for (size_t i = 0; i < files.size(); ++i) times.push_back(static_cast<double>(i));
+        } else if (!parse_pvd_collection(input_path, files, times)) {
+            std::cerr << "Failed to read time series collection: " << input_path << std::endl;
+            return 2;
+        }
+        std::cout << "Processing time series: " << files.size() << " steps" << std::endl;
+        success = generate_time_series_uvf(files, times, uvf_dir, options);
+    } else if (use_directory && use_watch) {
+        // The stop flag ends watching; each reconversion runs to completion
+        options.cancel = nullptr;
+        options.stats = nullptr;
+        options.trace = nullptr;
+        success = watch_directory(input_path, uvf_dir, options, &g_stop_requested);
+    } else if (use_directory) {
         std::cout << "Processing directory: " << input_path << std::endl;
-        success = process_directory_structure(input_path, uvf_dir);
+        success = process_directory_structure(input_path, uvf_dir, options);
     } else {
-        auto poly = parse_vtp_file(input_path);
+        auto poly = parse_vtp_file(input_path, options);
         if (!poly) {
             std::cerr << "Failed to read input file: " << input_path << std::endl;
             return 2;
@@ -52,18 +235,26 @@ int main(int argc, char** argv) {
 
         if (use_structured) {
             std::cout << "Using structured parsing..." << std::endl;
-            success = generate_structured_uvf(poly, uvf_dir);
+            success = generate_structured_uvf(poly, uvf_dir, options);
+            stats.add_counts(poly->GetNumberOfPoints(), count_triangles(poly), 0);
+            stats.set_groups(2);
         } else {
             std::cout << "Using basic parsing..." << std::endl;
-            success = generate_uvf(poly, uvf_dir);
+            success = generate_uvf(poly, uvf_dir, options);
+            stats.set_groups(1);
         }
+        stats.add_counts(0, 0, 1);
     }
 
+    stats.finish();
+    if (trace_path && options.trace && !trace.write(trace_path)) {
+        std::cerr << "Failed to write trace: " << trace_path << std::endl;
+    }
     if (!success) {
         std::cerr << "Failed to generate UVF in: " << uvf_dir << std::endl;
-        return 3;
+    } else {
+        std::cout << "Success! Output in: " << uvf_dir << std::endl;
     }
-
-    std::cout << "Success! Output in: " << uvf_dir << std::endl;
-    return 0;
+    if (print_stats) std::cout << stats.to_json() << std::endl;
+    return success ? 0 : 3;
 }
@@ -0,0 +1,317 @@
+#include "mesh_bvh.h"
+#include "parallel_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr int BIN_COUNT = 16;
+// Nodes at least this large reduce their bounds on several workers
+constexpr size_t PARALLEL_NODE_SIZE = size_t(1) << 16;
+// Subtrees at most this large are handed to a worker whole
+constexpr size_t SUBTREE_SIZE = size_t(1) << 14;
+
+struct Box {
+    float min[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+    float max[3] = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+    void grow(const float* lo, const float* hi) {
+        for (int a = 0; a < 3; ++a) {
+            min[a] = std::min(min[a], lo[a]);
+            max[a] = std::max(max[a], hi[a]);
+        }
+    }
+    void grow(const Box& b) { grow(b.min, b.max); }
+    // Half the surface area; 0 for an empty box
+    float area() const {
+        if (min[0] > max[0]) return 0;
+        float dx = max[0] - min[0], dy = max[1] - min[1], dz = max[2] - min[2];
+        return dx * dy + dy * dz + dz * dx;
+    }
+};
+
+struct Prim {
+    float min[3];
+    float max[3];
+    float centroid[3];
+};
+
+struct Builder {
+    const std::vector<Prim>& prims;
+    std::vector<uint32_t>& ids;
+    int threads;
+
+    // Bounds of the triangles and of their centroids in ids[begin, end)
+    void bounds(size_t begin, size_t end, Box& box, Box& centroids) const {
+        auto reduce = [&](size_t b, size_t e, Box& bx, Box& cx) {
+            for (size_t i = b; i < e; ++i) {
+                const Prim& p = prims[ids[i]];
+                bx.grow(p.min, p.max);
+                cx.grow(p.centroid, p.centroid);
+            }
+        };
+        if (end - begin < PARALLEL_NODE_SIZE || threads == 1) {
+            reduce(begin, end, box, centroids);
+            return;
+        }
+        // Min/max are exact, so merging per-chunk results in any order is deterministic
+        const size_t chunk = PARALLEL_NODE_SIZE / 4;
+        size_t chunks = (end - begin + chunk - 1) / chunk;
+        std::vector<Box> boxes(chunks), cboxes(chunks);
+        parallel_for(chunks, threads, [&](size_t c) {
+            reduce(begin + c * chunk, std::min(end, begin + (c + 1) * chunk), boxes[c], cboxes[c]);
+        });
+        for (size_t c = 0; c < chunks; ++c) {
+            box.grow(boxes[c]);
+            centroids.grow(cboxes[c]);
+        }
+    }
+
+    struct Bins {
+        Box box[3][BIN_COUNT];
+        size_t count[3][BIN_COUNT] = {};
+    };
+
+    // Bin the triangles of ids[begin, end) by centroid on all three axes
+    void bin(size_t begin, size_t end, const Box& centroids, Bins& out) const {
+        float lo[3], scale[3];
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = centroids.min[a];
+            float extent = centroids.max[a] - lo[a];
+            scale[a] = extent > 0 ? BIN_COUNT / extent : 0.0f;
+        }
+        auto fill = [&](size_t b, size_t e, Bins& bins) {
+            for (size_t i = b; i < e; ++i) {
+                const Prim& p = prims[ids[i]];
+                for (int a = 0; a < 3; ++a) {
+                    int k = std::min(BIN_COUNT - 1, static_cast<int>((p.centroid[a] - lo[a]) * scale[a]));
+                    bins.box[a][k].grow(p.min, p.max);
+                    ++bins.count[a][k];
+                }
+            }
+        };
+        if (end - begin < PARALLEL_NODE_SIZE || threads == 1) {
+            fill(begin, end, out);
+            return;
+        }
+        const size_t chunk = PARALLEL_NODE_SIZE / 4;
+        size_t chunks = (end - begin + chunk - 1) / chunk;
+        std::vector<Bins> partial(chunks);
+        parallel_for(chunks, threads, [&](size_t c) {
+            fill(begin + c * chunk, std::min(end, begin + (c + 1) * chunk), partial[c]);
+        });
+        for (const Bins& p : partial) {
+            for (int a = 0; a < 3; ++a) {
+                for (int k = 0; k < BIN_COUNT; ++k) {
+                    out.box[a][k].grow(p.box[a][k]);
+                    out.count[a][k] += p.count[a][k];
+                }
+            }
+        }
+    }
+
+    // Split ids[begin, end) by binned SAH; returns the split position, or
+    // begin when a leaf is cheaper (and allowed)
+    size_t split(size_t begin, size_t end, const Box& box, const Box& centroids) const {
+        const size_t count = end - begin;
+        if (count <= UVF_BVH_MIN_LEAF_TRIANGLES) return begin;
+        int best_axis = -1, best_bin = 0;
+        float best_cost = std::numeric_limits<float>::max();
+        Bins bins;
+        bin(begin, end, centroids, bins);
+        for (int a = 0; a < 3; ++a) {
+            if (!(centroids.max[a] > centroids.min[a])) continue;
+            // Right-to-left sweep, then evaluate every plane left to right
+            float right_area[BIN_COUNT];
+            size_t right_count[BIN_COUNT];
+            Box acc;
+            size_t n = 0;
+            for (int k = BIN_COUNT - 1; k > 0; --k) {
+                acc.grow(bins.box[a][k]);
+                n += bins.count[a][k];
+                right_area[k] = acc.area();
+                right_count[k] = n;
+            }
+            Box left;
+            size_t left_count = 0;
+            for (int k = 1; k < BIN_COUNT; ++k) {
+                left.grow(bins.box[a][k - 1]);
+                left_count += bins.count[a][k - 1];
+                if (left_count == 0 || right_count[k] == 0) continue;
+                float cost = left.area() * left_count + right_area[k] * right_count[k];
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_axis = a;
+                    best_bin = k;
+                }
+            }
+        }
+        // Traversal costs as much as one triangle test
+        float parent_area = box.area();
+        bool leaf_cheaper = best_axis < 0 || parent_area <= 0 || 1.0f + best_cost / parent_area >= static_cast<float>(count);
+        if (count <= UVF_BVH_MAX_LEAF_TRIANGLES && leaf_cheaper) return begin;
+        if (best_axis < 0) return begin + count / 2; // coincident centroids: split the list
+        // Same bin formula as bin(), so both sides match the evaluated counts
+        float lo = centroids.min[best_axis];
+        float scale = BIN_COUNT / (centroids.max[best_axis] - lo);
+        auto mid = std::partition(ids.begin() + begin, ids.begin() + end, [&](uint32_t id) {
+            int k = std::min(BIN_COUNT - 1, static_cast<int>((prims[id].centroid[best_axis] - lo) * scale));
+            return k < best_bin;
+        });
+        return static_cast<size_t>(mid - ids.begin());
+    }
+
+    // Append the subtree over ids[begin, end) to nodes, depth first. With
+    // deferred set, subtrees of at most SUBTREE_SIZE triangles become
+    // placeholders (count = UINT32_MAX, offset = position in deferred).
+    void build(size_t begin, size_t end, std::vector<UVFBvhNode>& nodes,
+               std::vector<std::pair<size_t, size_t>>* deferred) const {
+        Box box, centroids;
+        bounds(begin, end, box, centroids);
+        size_t index = nodes.size();
+        nodes.push_back(UVFBvhNode{{box.min[0], box.min[1], box.min[2]}, {box.max[0], box.max[1], box.max[2]}, 0, 0});
+        if (deferred && end - begin <= SUBTREE_SIZE) {
+            nodes[index].offset = static_cast<uint32_t>(deferred->size());
+            nodes[index].count = std::numeric_limits<uint32_t>::max();
+            deferred->push_back({begin, end});
+            return;
+        }
+        size_t mid = split(begin, end, box, centroids);
+        if (mid == begin) {
+            nodes[index].offset = static_cast<uint32_t>(begin);
+            nodes[index].count = static_cast<uint32_t>(end - begin);
+            return;
+        }
+        build(begin, mid, nodes, deferred);
+        nodes[index].offset = static_cast<uint32_t>(nodes.size());
+        build(mid, end, nodes, deferred);
+    }
+};
+
+}
+
+void build_mesh_bvh(const UVFMeshView& mesh, int threads, std::vector<UVFBvhNode>& nodes,
+                    std::vector<uint32_t>& triangles) {
+    nodes.clear();
+    triangles.clear();
+    const size_t tri_count = mesh.index_count / 3;
+    if (tri_count == 0) return;
+    std::vector<Prim> prims(tri_count);
+    parallel_for_chunks(tri_count, threads, size_t(1) << 14, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t) {
+            Prim& p = prims[t];
+            for (int a = 0; a < 3; ++a) {
+                float v0 = mesh.positions[size_t(mesh.indices[t * 3]) * 3 + a];
+                float v1 = mesh.positions[size_t(mesh.indices[t * 3 + 1]) * 3 + a];
+                float v2 = mesh.positions[size_t(mesh.indices[t * 3 + 2]) * 3 + a];
+                p.min[a] = std::min(v0, std::min(v1, v2));
+                p.max[a] = std::max(v0, std::max(v1, v2));
+                p.centroid[a] = (p.min[a] + p.max[a]) * 0.5f;
+            }
+        }
+    });
+    triangles.resize(tri_count);
+    for (size_t t = 0; t < tri_count; ++t) triangles[t] = static_cast<uint32_t>(t);
+    Builder builder{prims, triangles, resolve_thread_count(threads)};
+
+    // Top of the tree on this thread, then the small subtrees on the workers
+    // (they partition disjoint ranges of triangles)
+    std::vector<UVFBvhNode> top;
+    std::vector<std::pair<size_t, size_t>> deferred;
+    builder.build(0, tri_count, top, &deferred);
+    std::vector<std::vector<UVFBvhNode>> subtrees(deferred.size());
+    parallel_for(deferred.size(), threads, [&](size_t i) {
+        builder.build(deferred[i].first, deferred[i].second, subtrees[i], nullptr);
+    });
+
+    // Splice the subtrees in place of their placeholders, keeping depth-first order
+    std::vector<uint32_t> moved(top.size());
+    size_t total = 0;
+    for (size_t i = 0; i < top.size(); ++i) {
+        moved[i] = static_cast<uint32_t>(total);
+        bool placeholder = top[i].count == std::numeric_limits<uint32_t>::max();
+        total += placeholder ? subtrees[top[i].offset].size() : 1;
+    }
+    nodes.reserve(total);
+    for (size_t i = 0; i < top.size(); ++i) {
+        if (top[i].count == std::numeric_limits<uint32_t>::max()) {
+            uint32_t base = moved[i];
+            for (UVFBvhNode n : subtrees[top[i].offset]) {
+                if (n.count == 0) n.offset += base;
+                nodes.push_back(n);
+            }
+        } else {
+            UVFBvhNode n = top[i];
+            if (n.count == 0) n.offset = moved[n.offset];
+            nodes.push_back(n);
+        }
+    }
+}
+
+// Möller-Trumbore; returns the distance or a negative value on a miss
+static float intersect_triangle(const float* o, const float* d, const float* a, const float* b, const float* c) {
+    float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    float p[3] = {d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0]};
+    float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+    if (std::fabs(det) < 1e-20f) return -1;
+    float inv = 1.0f / det;
+    float s[3] = {o[0] - a[0], o[1] - a[1], o[2] - a[2]};
+    float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inv;
+    if (u < 0 || u > 1) return -1;
+    float q[3] = {s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0]};
+    float v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * inv;
+    if (v < 0 || u + v > 1) return -1;
+    return (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inv;
+}
+
+// Entry distance of the ray into the node's box, or +inf when it misses
+// before `limit`
+static float intersect_box(const UVFBvhNode& n, const float* o, const float* inv_d, float limit) {
+    float t0 = 0, t1 = limit;
+    for (int a = 0; a < 3; ++a) {
+        float n0 = (n.min[a] - o[a]) * inv_d[a];
+        float f0 = (n.max[a] - o[a]) * inv_d[a];
+        if (n0 > f0) std::swap(n0, f0);
+        // NaN (0 * inf on a slab boundary) keeps the current interval
+        t0 = n0 > t0 ? n0 : t0;
+        t1 = f0 < t1 ? f0 : t1;
+        if (t0 > t1) return std::numeric_limits<float>::infinity();
+    }
+    return t0;
+}
+
+int64_t intersect_mesh_bvh(const UVFMeshView& mesh, const std::vector<UVFBvhNode>& nodes,
+                           const std::vector<uint32_t>& triangles, const float origin[3], const float dir[3], float& t) {
+    int64_t hit = -1;
+    t = std::numeric_limits<float>::max();
+    if (nodes.empty()) return hit;
+    const float inv_d[3] = {1.0f / dir[0], 1.0f / dir[1], 1.0f / dir[2]};
+    std::vector<uint32_t> stack = {0};
+    while (!stack.empty()) {
+        const UVFBvhNode& n = nodes[stack.back()];
+        uint32_t index = stack.back();
+        stack.pop_back();
+        if (intersect_box(n, origin, inv_d, t) == std::numeric_limits<float>::infinity()) continue;
+        if (n.count == 0) {
+            // Visit the nearer child first
+            uint32_t near_child = index + 1, far_child = n.offset;
+            if (intersect_box(nodes[far_child], origin, inv_d, t) < intersect_box(nodes[near_child], origin, inv_d, t)) {
+                std::swap(near_child, far_child);
+            }
+            stack.push_back(far_child);
+            stack.push_back(near_child);
+            continue;
+        }
+        for (uint32_t k = n.offset; k < n.offset + n.count; ++k) {
+            const uint32_t* tri = mesh.indices + size_t(triangles[k]) * 3;
+            float d = intersect_triangle(origin, dir, mesh.positions + size_t(tri[0]) * 3,
+                                         mesh.positions + size_t(tri[1]) * 3, mesh.positions + size_t(tri[2]) * 3);
+            if (d > 0 && d < t) {
+                t = d;
+                hit = triangles[k];
+            }
+        }
+    }
+    return hit;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "vtp_to_uvf.h"
+#include <cstdint>
+#include <vector>
+
+// Bounding volume hierarchy over the triangles of a mesh (options.bvh),
+// written as two sections so clients can pick and cull without building a
+// tree on load:
+//
+//   bvhNodes      uint32, dimension 8 per node: minX, minY, minZ, maxX, maxY,
+//                 maxZ (float32 bit patterns: view the same bytes as a
+//                 Float32Array), then offset and count. count == 0: inner
+//                 node, its left child is the next node and its right child
+//                 is node `offset`. count > 0: leaf holding triangles
+//                 bvhTriangles[offset, offset + count). Node 0 is the root and
+//                 nodes are stored depth first.
+//   bvhTriangles  uint32 triangle numbers (first index / 3) in leaf order
+//
+// Built top-down with binned SAH (16 bins on each axis). Node bounds are
+// parallel reductions over large nodes, and subtrees below a size threshold
+// are built on separate workers; the tree itself does not depend on the
+// thread count.
+struct UVFBvhNode {
+    float min[3];
+    float max[3];
+    uint32_t offset;
+    uint32_t count;
+};
+static_assert(sizeof(UVFBvhNode) == 32, "bvhNodes records are 8 words");
+
+// Nodes of at most MIN triangles are always leaves, nodes of more than MAX
+// are always split; SAH decides in between
+constexpr uint32_t UVF_BVH_MIN_LEAF_TRIANGLES = 4;
+constexpr uint32_t UVF_BVH_MAX_LEAF_TRIANGLES = 8;
+
+// Build the hierarchy over mesh.index_count / 3 triangles on up to `threads`
+// workers. Leaves nodes empty for a mesh without triangles.
+void build_mesh_bvh(const UVFMeshView& mesh, int threads, std::vector<UVFBvhNode>& nodes,
+                    std::vector<uint32_t>& triangles);
+
+// Nearest triangle hit by the ray origin + t * dir (t > 0), or -1; t receives
+// the distance in units of dir
+int64_t intersect_mesh_bvh(const UVFMeshView& mesh, const std::vector<UVFBvhNode>& nodes,
+                           const std::vector<uint32_t>& triangles, const float origin[3], const float dir[3], float& t);
@@ -0,0 +1,68 @@
+#include "mesh_codec.h"
+#include "parallel_utils.h"
+#include <cstring>
+
+void encode_indices_delta_varint(const uint32_t* indices, size_t count, std::string& out) {
+    out.reserve(out.size() + count * 2);
+    int64_t prev = 0;
+    for (size_t i = 0; i < count; ++i) {
+        int64_t delta = static_cast<int64_t>(indices[i]) - prev;
+        prev = indices[i];
+        uint64_t v = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+        while (v >= 0x80) {
+            out += static_cast<char>((v & 0x7F) | 0x80);
+            v >>= 7;
+        }
+        out += static_cast<char>(v);
+    }
+}
+
+bool decode_indices_delta_varint(const void* data, size_t bytes, uint32_t* out, size_t count) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + bytes;
+    int64_t prev = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t v = 0;
+        int shift = 0;
+        while (true) {
+            if (p == end || shift > 35) return false; // deltas need at most 5 bytes
+            uint8_t b = *p++;
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            shift += 7;
+            if (!(b & 0x80)) break;
+        }
+        int64_t delta = static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+        prev += delta;
+        if (prev < 0 || prev > 0xFFFFFFFFll) return false;
+        out[i] = static_cast<uint32_t>(prev);
+    }
+    return p == end;
+}
+
+void encode_byteplane_delta(const float* values, size_t count, int dimension, char* out, int threads) {
+    parallel_for_chunks(count, threads, size_t(1) << 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            for (int c = 0; c < dimension; ++c) {
+                uint32_t cur, prev = 0;
+                std::memcpy(&cur, &values[i * dimension + c], 4);
+                if (i > 0) std::memcpy(&prev, &values[(i - 1) * dimension + c], 4);
+                uint32_t d = cur - prev;
+                for (int k = 0; k < 4; ++k) out[(c * 4 + k) * count + i] = static_cast<char>(d >> (8 * k));
+            }
+        }
+    });
+}
+
+void decode_byteplane_delta(const void* data, size_t count, int dimension, float* out) {
+    const uint8_t* in = static_cast<const uint8_t*>(data);
+    for (int c = 0; c < dimension; ++c) {
+        const uint8_t* plane = in + static_cast<size_t>(c) * 4 * count;
+        uint32_t prev = 0;
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t d = plane[i] | (plane[count + i] << 8) | (plane[2 * count + i] << 16) |
+                         (static_cast<uint32_t>(plane[3 * count + i]) << 24);
+            prev += d;
+            std::memcpy(&out[i * dimension + c], &prev, 4);
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Mesh-aware section encodings (options.mesh_codecs). Both are lossless and
+// are applied before block compression, which they exist to feed:
+//
+//   delta-varint    indices: each index minus the previous one (the first
+//                   minus 0), zigzag-mapped and written as LEB128 varints.
+//                   Neighbouring triangles share vertices, so most deltas
+//                   fit in one byte.
+//   byteplane-delta float vectors of `dimension` components: per component,
+//                   the IEEE bit pattern minus the previous vertex's (mod
+//                   2^32), split into 4 byte planes (least significant
+//                   first). Planes are stored component-major, each holding
+//                   one byte of every vertex, so the slowly varying sign and
+//                   exponent bytes form long runs.
+//
+// The manifest keeps the logical dType/dimension, names the encoding and adds
+// decodedLength (bytes after decoding).
+constexpr const char* UVF_INDEX_ENCODING = "delta-varint";
+constexpr const char* UVF_VECTOR_ENCODING = "byteplane-delta";
+
+// Append the delta-varint encoding of count indices to out
+void encode_indices_delta_varint(const uint32_t* indices, size_t count, std::string& out);
+
+// Decode exactly count indices; fails on truncated or overlong input
+bool decode_indices_delta_varint(const void* data, size_t bytes, uint32_t* out, size_t count);
+
+// Encode count vectors of dimension floats into count * dimension * 4 bytes at
+// out, on up to `threads` workers
+void encode_byteplane_delta(const float* values, size_t count, int dimension, char* out, int threads);
+
+// Inverse of encode_byteplane_delta
+void decode_byteplane_delta(const void* data, size_t count, int dimension, float* out);
@@ -0,0 +1,133 @@
+#include "mesh_edges.h"
+#include "parallel_utils.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr int BUCKET_BITS = 8;
+constexpr size_t BUCKET_COUNT = size_t(1) << BUCKET_BITS;
+constexpr size_t CHUNK_TRIANGLES = size_t(1) << 14;
+
+// One use of an edge by a triangle
+struct HalfEdge {
+    uint64_t key; // lower vertex << 32 | higher vertex
+    uint32_t triangle;
+};
+
+size_t bucket_of(uint64_t key) {
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> (64 - BUCKET_BITS));
+}
+
+bool degenerate(const uint32_t* tri) {
+    return tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2];
+}
+
+void triangle_normal(const UVFMeshView& mesh, uint32_t t, double n[3]) {
+    const float* a = mesh.positions + size_t(mesh.indices[size_t(t) * 3]) * 3;
+    const float* b = mesh.positions + size_t(mesh.indices[size_t(t) * 3 + 1]) * 3;
+    const float* c = mesh.positions + size_t(mesh.indices[size_t(t) * 3 + 2]) * 3;
+    double u[3] = {double(b[0]) - a[0], double(b[1]) - a[1], double(b[2]) - a[2]};
+    double v[3] = {double(c[0]) - a[0], double(c[1]) - a[1], double(c[2]) - a[2]};
+    n[0] = u[1] * v[2] - u[2] * v[1];
+    n[1] = u[2] * v[0] - u[0] * v[2];
+    n[2] = u[0] * v[1] - u[1] * v[0];
+}
+
+}
+
+void extract_feature_edges(const UVFMeshView& mesh, float feature_angle_degrees, int threads, UVFMeshEdges& out) {
+    for (auto& lines : out.lines) lines.clear();
+    const size_t tri_count = mesh.index_count / 3;
+    if (tri_count == 0) return;
+
+    // Face segment of every triangle, when there is more than one
+    std::vector<uint32_t> tri_face;
+    if (mesh.faces.size() > 1) {
+        tri_face.assign(tri_count, static_cast<uint32_t>(mesh.faces.size()));
+        for (size_t f = 0; f < mesh.faces.size(); ++f) {
+            size_t end = std::min(mesh.faces[f].endIndex / 3, tri_count);
+            for (size_t t = mesh.faces[f].startIndex / 3; t < end; ++t) tri_face[t] = static_cast<uint32_t>(f);
+        }
+    }
+
+    // Hash the half-edges into buckets: count per (chunk, bucket), then scatter
+    const size_t chunks = (tri_count + CHUNK_TRIANGLES - 1) / CHUNK_TRIANGLES;
+    auto for_each_half_edge = [&](size_t chunk, auto&& fn) {
+        size_t end = std::min(tri_count, (chunk + 1) * CHUNK_TRIANGLES);
+        for (size_t t = chunk * CHUNK_TRIANGLES; t < end; ++t) {
+            const uint32_t* tri = mesh.indices + t * 3;
+            if (degenerate(tri)) continue;
+            for (int e = 0; e < 3; ++e) {
+                uint32_t a = tri[e], b = tri[(e + 1) % 3];
+                uint64_t key = (uint64_t(std::min(a, b)) << 32) | std::max(a, b);
+                fn(HalfEdge{key, static_cast<uint32_t>(t)});
+            }
+        }
+    };
+    std::vector<size_t> counts(chunks * BUCKET_COUNT, 0);
+    parallel_for(chunks, threads, [&](size_t c) {
+        size_t* row = &counts[c * BUCKET_COUNT];
+        for_each_half_edge(c, [&](const HalfEdge& h) { ++row[bucket_of(h.key)]; });
+    });
+    // Bucket-major prefix sums: chunk c of bucket b starts at counts[c][b]
+    std::vector<size_t> bucket_start(BUCKET_COUNT + 1, 0);
+    size_t total = 0;
+    for (size_t b = 0; b < BUCKET_COUNT; ++b) {
+        bucket_start[b] = total;
+        for (size_t c = 0; c < chunks; ++c) {
+            size_t n = counts[c * BUCKET_COUNT + b];
+            counts[c * BUCKET_COUNT + b] = total;
+            total += n;
+        }
+    }
+    bucket_start[BUCKET_COUNT] = total;
+    std::vector<HalfEdge> half_edges(total);
+    parallel_for(chunks, threads, [&](size_t c) {
+        size_t* row = &counts[c * BUCKET_COUNT];
+        for_each_half_edge(c, [&](const HalfEdge& h) { half_edges[row[bucket_of(h.key)]++] = h; });
+    });
+
+    // Sort and classify every bucket on its own
+    const double cos_limit = std::cos(double(feature_angle_degrees) * 3.14159265358979323846 / 180.0);
+    std::vector<UVFMeshEdges> per_bucket(BUCKET_COUNT);
+    parallel_for(BUCKET_COUNT, threads, [&](size_t b) {
+        auto first = half_edges.begin() + bucket_start[b];
+        auto last = half_edges.begin() + bucket_start[b + 1];
+        std::sort(first, last, [](const HalfEdge& x, const HalfEdge& y) {
+            return x.key != y.key ? x.key < y.key : x.triangle < y.triangle;
+        });
+        UVFMeshEdges& edges = per_bucket[b];
+        for (auto run = first; run != last;) {
+            auto next = run;
+            while (next != last && next->key == run->key) ++next;
+            size_t uses = static_cast<size_t>(next - run);
+            int cls = -1;
+            if (uses == 1) {
+                cls = UVF_BOUNDARY_EDGES;
+            } else if (uses > 2) {
+                cls = UVF_NON_MANIFOLD_EDGES;
+            } else if (!tri_face.empty() && tri_face[run->triangle] != tri_face[(run + 1)->triangle]) {
+                cls = UVF_FEATURE_EDGES;
+            } else {
+                double n0[3], n1[3];
+                triangle_normal(mesh, run->triangle, n0);
+                triangle_normal(mesh, (run + 1)->triangle, n1);
+                double len = std::sqrt((n0[0] * n0[0] + n0[1] * n0[1] + n0[2] * n0[2]) *
+                                       (n1[0] * n1[0] + n1[1] * n1[1] + n1[2] * n1[2]));
+                if (len > 0 && (n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2]) < cos_limit * len) cls = UVF_FEATURE_EDGES;
+            }
+            if (cls >= 0) {
+                edges.lines[cls].push_back(static_cast<uint32_t>(run->key >> 32));
+                edges.lines[cls].push_back(static_cast<uint32_t>(run->key));
+            }
+            run = next;
+        }
+    });
+    for (int cls = 0; cls < UVF_EDGE_CLASS_COUNT; ++cls) {
+        size_t n = 0;
+        for (const auto& e : per_bucket) n += e.lines[cls].size();
+        out.lines[cls].reserve(n);
+        for (const auto& e : per_bucket) out.lines[cls].insert(out.lines[cls].end(), e.lines[cls].begin(), e.lines[cls].end());
+    }
+}
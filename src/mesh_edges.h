@@ -0,0 +1,30 @@
+#pragma once
+#include "vtp_to_uvf.h"
+#include <cstdint>
+#include <vector>
+
+// Feature edge extraction (options.feature_edges). Every edge of the
+// triangles is classified by the triangles sharing it (degenerate triangles,
+// i.e. line segments stored as (a,b,b), are skipped):
+//
+//   boundaryEdges     used by one triangle
+//   nonManifoldEdges  used by three or more
+//   featureEdges      used by two whose normals differ by more than the
+//                     feature angle, or which belong to different face segments
+//
+// Smooth interior edges are dropped. Each non-empty class is written as a
+// uint32 section of dimension 2 (vertex pairs, lower index first) and
+// referenced by an Edge node listed in the SolidGeometry's "edges"
+// attribution, whose bufferLocations name the section.
+enum UVFEdgeClass { UVF_BOUNDARY_EDGES = 0, UVF_NON_MANIFOLD_EDGES, UVF_FEATURE_EDGES, UVF_EDGE_CLASS_COUNT };
+constexpr const char* UVF_EDGE_SECTION_NAMES[UVF_EDGE_CLASS_COUNT] = {"boundaryEdges", "nonManifoldEdges", "featureEdges"};
+
+// Vertex pairs of each edge class
+struct UVFMeshEdges {
+    std::vector<uint32_t> lines[UVF_EDGE_CLASS_COUNT];
+};
+
+// Extract and classify the edges of mesh on up to `threads` workers. Edges are
+// hashed into a fixed number of buckets that are sorted and classified
+// independently, so the result does not depend on the thread count.
+void extract_feature_edges(const UVFMeshView& mesh, float feature_angle_degrees, int threads, UVFMeshEdges& out);
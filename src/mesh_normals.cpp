@@ -0,0 +1,140 @@
+#include "mesh_normals.h"
+#include "parallel_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+bool is_known_normals_mode(const std::string& mode) {
+    return mode == "none" || mode == "float32" || mode == UVF_OCT_NORMAL_ENCODING;
+}
+
+// Face segment of every triangle (faces.size() for triangles outside all faces)
+static std::vector<uint32_t> triangle_faces(const UVFMeshView& mesh) {
+    const size_t tri_count = mesh.index_count / 3;
+    std::vector<uint32_t> tri_face(tri_count, static_cast<uint32_t>(mesh.faces.size()));
+    for (size_t f = 0; f < mesh.faces.size(); ++f) {
+        size_t end = std::min(mesh.faces[f].endIndex / 3, tri_count);
+        for (size_t t = mesh.faces[f].startIndex / 3; t < end; ++t) tri_face[t] = static_cast<uint32_t>(f);
+    }
+    return tri_face;
+}
+
+bool split_face_vertices(const UVFMeshView& mesh, std::vector<uint32_t>& indices, std::vector<uint32_t>& source) {
+    indices.clear();
+    source.clear();
+    bool one_group = mesh.faces.empty() || (mesh.faces.size() == 1 && mesh.faces[0].startIndex == 0 &&
+                                            mesh.faces[0].endIndex >= mesh.index_count);
+    if (one_group) return false;
+    const std::vector<uint32_t> tri_face = triangle_faces(mesh);
+    const uint32_t unowned = 0xFFFFFFFFu;
+    std::vector<uint32_t> owner(mesh.vertex_count, unowned);
+    std::unordered_map<uint64_t, uint32_t> copies; // vertex << 32 | face -> copy
+    indices.assign(mesh.indices, mesh.indices + mesh.index_count);
+    for (size_t i = 0; i < tri_face.size() * 3; ++i) {
+        uint32_t v = mesh.indices[i], face = tri_face[i / 3];
+        if (owner[v] == unowned) owner[v] = face;
+        if (owner[v] == face) continue;
+        auto it = copies.emplace((uint64_t(v) << 32) | face, static_cast<uint32_t>(mesh.vertex_count + source.size())).first;
+        if (it->second == mesh.vertex_count + source.size()) source.push_back(v);
+        indices[i] = it->second;
+    }
+    if (source.empty()) indices.clear();
+    return !source.empty();
+}
+
+void compute_vertex_normals(const UVFMeshView& mesh, int threads, float* out) {
+    const size_t vertex_count = mesh.vertex_count;
+    const size_t tri_count = mesh.index_count / 3;
+    const uint32_t* idx = mesh.indices;
+    const float* pos = mesh.positions;
+    const std::vector<uint32_t> tri_face = triangle_faces(mesh);
+
+    // Unnormalised triangle normals: their length is twice the area
+    std::vector<float> tri_normal(tri_count * 3);
+    parallel_for_chunks(tri_count, threads, size_t(1) << 14, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t) {
+            const float* a = pos + size_t(idx[t * 3]) * 3;
+            const float* b = pos + size_t(idx[t * 3 + 1]) * 3;
+            const float* c = pos + size_t(idx[t * 3 + 2]) * 3;
+            float ux = b[0] - a[0], uy = b[1] - a[1], uz = b[2] - a[2];
+            float vx = c[0] - a[0], vy = c[1] - a[1], vz = c[2] - a[2];
+            tri_normal[t * 3] = uy * vz - uz * vy;
+            tri_normal[t * 3 + 1] = uz * vx - ux * vz;
+            tri_normal[t * 3 + 2] = ux * vy - uy * vx;
+        }
+    });
+
+    // Triangles of every vertex in ascending order (CSR), so the per-vertex
+    // sums below need no atomics and always add in the same order
+    std::vector<size_t> first(vertex_count + 1, 0);
+    for (size_t i = 0; i < tri_count * 3; ++i) ++first[idx[i] + 1];
+    for (size_t v = 0; v < vertex_count; ++v) first[v + 1] += first[v];
+    std::vector<uint32_t> vertex_tris(tri_count * 3);
+    {
+        std::vector<size_t> fill(first.begin(), first.end() - 1);
+        for (size_t i = 0; i < tri_count * 3; ++i) vertex_tris[fill[idx[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    parallel_for_chunks(vertex_count, threads, size_t(1) << 14, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            float nx = 0, ny = 0, nz = 0;
+            if (first[v] < first[v + 1]) {
+                uint32_t owner = tri_face[vertex_tris[first[v]]];
+                for (size_t k = first[v]; k < first[v + 1]; ++k) {
+                    uint32_t t = vertex_tris[k];
+                    if (tri_face[t] != owner) continue;
+                    nx += tri_normal[size_t(t) * 3];
+                    ny += tri_normal[size_t(t) * 3 + 1];
+                    nz += tri_normal[size_t(t) * 3 + 2];
+                }
+            }
+            float len = std::sqrt(nx * nx + ny * ny + nz * nz);
+            float inv = len > 0 ? 1.0f / len : 0.0f;
+            out[v * 3] = nx * inv;
+            out[v * 3 + 1] = ny * inv;
+            out[v * 3 + 2] = nz * inv;
+        }
+    });
+}
+
+static int16_t to_snorm16(float v) {
+    v = std::max(-1.0f, std::min(1.0f, v));
+    return static_cast<int16_t>(std::lround(v * 32767.0f));
+}
+
+void encode_normals_oct16(const float* normals, size_t count, int16_t* out, int threads) {
+    parallel_for_chunks(count, threads, size_t(1) << 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            float x = normals[i * 3], y = normals[i * 3 + 1], z = normals[i * 3 + 2];
+            float l1 = std::fabs(x) + std::fabs(y) + std::fabs(z);
+            float px = l1 > 0 ? x / l1 : 0.0f, py = l1 > 0 ? y / l1 : 0.0f;
+            if (z < 0) {
+                float fx = (1.0f - std::fabs(py)) * (px >= 0 ? 1.0f : -1.0f);
+                float fy = (1.0f - std::fabs(px)) * (py >= 0 ? 1.0f : -1.0f);
+                px = fx;
+                py = fy;
+            }
+            out[i * 2] = to_snorm16(px);
+            out[i * 2 + 1] = to_snorm16(py);
+        }
+    });
+}
+
+void decode_normals_oct16(const int16_t* data, size_t count, float* out) {
+    for (size_t i = 0; i < count; ++i) {
+        float x = std::max(-1.0f, data[i * 2] / 32767.0f);
+        float y = std::max(-1.0f, data[i * 2 + 1] / 32767.0f);
+        float z = 1.0f - std::fabs(x) - std::fabs(y);
+        if (z < 0) {
+            float fx = (1.0f - std::fabs(y)) * (x >= 0 ? 1.0f : -1.0f);
+            float fy = (1.0f - std::fabs(x)) * (y >= 0 ? 1.0f : -1.0f);
+            x = fx;
+            y = fy;
+        }
+        float len = std::sqrt(x * x + y * y + z * z);
+        out[i * 3] = x / len;
+        out[i * 3 + 1] = y / len;
+        out[i * 3 + 2] = z / len;
+    }
+}
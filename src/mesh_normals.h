@@ -0,0 +1,47 @@
+#pragma once
+#include "vtp_to_uvf.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Precomputed vertex normals (options.normals), written as the "normal"
+// section after "position":
+//
+//   float32  3 floats per vertex
+//   oct16    2 snorm16 per vertex: the unit vector projected onto the
+//            octahedron |x|+|y|+|z| = 1, the lower half folded over the
+//            upper one (x, y stored; z recovered from them). The manifest
+//            keeps dType float32/dimension 3, names encoding "oct16" and
+//            gives decodedLength, as the mesh codecs do.
+//
+// Normals are area weighted (the sum of the unnormalised cross products of the
+// triangles using the vertex) and only combine triangles of one face segment.
+// Vertices shared by several faces are split first (split_face_vertices), so
+// every face shades with its own normals and edges between CAD faces stay
+// hard. Vertices without area (unused, or on line segments only) get 0
+// (oct16: +z).
+constexpr const char* UVF_OCT_NORMAL_ENCODING = "oct16";
+
+// "none", "float32" or "oct16"
+bool is_known_normals_mode(const std::string& mode);
+
+// Give every face segment its own copy of the vertices it shares with other
+// faces (triangles outside all faces count as one more group). The group of a
+// vertex's first triangle keeps the vertex; copies are appended after
+// mesh.vertex_count in order of first use, so original indices stay valid.
+// indices receives the remapped triangles and source the original vertex of
+// each copy. Returns false, leaving both empty, when no vertex is shared.
+bool split_face_vertices(const UVFMeshView& mesh, std::vector<uint32_t>& indices, std::vector<uint32_t>& source);
+
+// Compute mesh.vertex_count unit normals (xyz) into out on up to `threads`
+// workers. A vertex used by several faces gets the normal of the face of its
+// first triangle (split_face_vertices avoids such vertices). Each vertex sums
+// its triangles in index order, so the result does not depend on the thread
+// count.
+void compute_vertex_normals(const UVFMeshView& mesh, int threads, float* out);
+
+// Encode count unit normals into 2 * count snorm16 values
+void encode_normals_oct16(const float* normals, size_t count, int16_t* out, int threads);
+
+// Inverse of encode_normals_oct16 (unit vectors)
+void decode_normals_oct16(const int16_t* data, size_t count, float* out);
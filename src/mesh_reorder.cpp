@@ -0,0 +1,112 @@
+#include "mesh_reorder.h"
+#include "parallel_utils.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+bool is_known_reorder_mode(const std::string& mode) {
+    return mode == "none" || mode == "morton";
+}
+
+// Spread the low 21 bits of v to every third bit
+static uint64_t spread_bits(uint64_t v) {
+    v &= 0x1FFFFF;
+    v = (v | v << 32) & 0x1F00000000FFFFull;
+    v = (v | v << 16) & 0x1F0000FF0000FFull;
+    v = (v | v << 8) & 0x100F00F00F00F00Full;
+    v = (v | v << 4) & 0x10C30C30C30C30C3ull;
+    v = (v | v << 2) & 0x1249249249249249ull;
+    return v;
+}
+
+void reorder_mesh_morton(const UVFMeshView& mesh, int threads, UVFReorderedMesh& out) {
+    const size_t n = mesh.vertex_count;
+    const float* pos = mesh.positions;
+
+    // Morton code of every vertex over the bounding box
+    float lo[3] = {0, 0, 0}, hi[3] = {0, 0, 0};
+    if (n > 0) std::copy(pos, pos + 3, lo), std::copy(pos, pos + 3, hi);
+    for (size_t v = 1; v < n; ++v) {
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = std::min(lo[a], pos[v * 3 + a]);
+            hi[a] = std::max(hi[a], pos[v * 3 + a]);
+        }
+    }
+    // One cubic grid over the largest extent, so a thin axis does not weigh as
+    // much as a wide one
+    double extent = 0.0;
+    for (int a = 0; a < 3; ++a) extent = std::max(extent, double(hi[a]) - lo[a]);
+    const double scale = extent > 0.0 ? double(0x1FFFFF) / extent : 0.0;
+    std::vector<std::pair<uint64_t, uint32_t>> keys(n);
+    parallel_for_chunks(n, threads, size_t(1) << 16, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            uint64_t code = 0;
+            for (int a = 0; a < 3; ++a) {
+                double q = (double(pos[v * 3 + a]) - lo[a]) * scale;
+                uint64_t cell = std::isfinite(q) ? static_cast<uint64_t>(std::min(std::max(q, 0.0), double(0x1FFFFF))) : 0;
+                code |= spread_bits(cell) << a;
+            }
+            keys[v] = {code, static_cast<uint32_t>(v)};
+        }
+    });
+    std::sort(keys.begin(), keys.end());
+
+    // Gather vertices and attributes in the new order
+    std::vector<uint32_t> new_index(n);
+    out.positions.resize(n * 3);
+    parallel_for_chunks(n, threads, size_t(1) << 16, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            uint32_t old = keys[v].second;
+            new_index[old] = static_cast<uint32_t>(v);
+            for (int a = 0; a < 3; ++a) out.positions[v * 3 + a] = pos[size_t(old) * 3 + a];
+        }
+    });
+    out.attributes.assign(mesh.attributes.size(), std::vector<float>());
+    for (size_t i = 0; i < mesh.attributes.size(); ++i) {
+        const UVFAttributeView& a = mesh.attributes[i];
+        std::vector<float>& dst = out.attributes[i];
+        dst.resize(a.count);
+        const size_t comps = static_cast<size_t>(std::max(a.components, 1));
+        if (a.count != n * comps) {
+            std::copy(a.data, a.data + a.count, dst.begin());
+            continue;
+        }
+        parallel_for_chunks(n, threads, size_t(1) << 16, [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                std::copy(a.data + keys[v].second * comps, a.data + (keys[v].second + 1) * comps, dst.begin() + v * comps);
+            }
+        });
+    }
+
+    // Remap and rotate triangles, then sort them within each face segment
+    const size_t tri_count = mesh.index_count / 3;
+    std::vector<std::array<uint32_t, 3>> tris(tri_count);
+    parallel_for_chunks(tri_count, threads, size_t(1) << 16, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t) {
+            std::array<uint32_t, 3> tri = {new_index[mesh.indices[t * 3]], new_index[mesh.indices[t * 3 + 1]],
+                                           new_index[mesh.indices[t * 3 + 2]]};
+            bool line = tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2];
+            if (!line) std::rotate(tri.begin(), std::min_element(tri.begin(), tri.end()), tri.end());
+            tris[t] = tri;
+        }
+    });
+    // Face ranges may overlap: cut at every face boundary and sort the disjoint
+    // pieces, each of which lies inside the same set of faces
+    std::vector<size_t> cuts = {0, tri_count};
+    for (const auto& f : mesh.faces) {
+        cuts.push_back(std::min(f.startIndex / 3, tri_count));
+        cuts.push_back(std::min(f.endIndex / 3, tri_count));
+    }
+    std::sort(cuts.begin(), cuts.end());
+    cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+    parallel_for(cuts.size() - 1, threads, [&](size_t r) {
+        std::sort(tris.begin() + cuts[r], tris.begin() + cuts[r + 1]);
+    });
+    out.indices.resize(tri_count * 3);
+    for (size_t t = 0; t < tri_count; ++t) std::copy(tris[t].begin(), tris[t].end(), out.indices.begin() + t * 3);
+
+    out.view = mesh;
+    out.view.positions = out.positions.data();
+    out.view.indices = out.indices.data();
+    for (size_t i = 0; i < mesh.attributes.size(); ++i) out.view.attributes[i].data = out.attributes[i].data();
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "vtp_to_uvf.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Spatial reordering (options.reorder = "morton"), applied before any section
+// is built:
+//
+//   vertices   sorted by the Morton code (21 bits per axis, interleaved) of
+//              their position on a cubic grid over the bounding box, ties
+//              by original index; per-vertex attributes follow their vertex
+//   triangles  indices remapped, each triangle rotated to start at its
+//              smallest index (winding kept; line segments (a,b,b) left
+//              as they are), then sorted by their indices between face
+//              boundaries so every face keeps its triangles (also when face
+//              ranges overlap)
+//
+// Neighbouring vertices get neighbouring indices, which keeps caches warm
+// downstream and makes index deltas small for the mesh codecs and deflate.
+bool is_known_reorder_mode(const std::string& mode);
+
+// Reordered copies of a mesh's arrays; view borrows them and keeps the
+// faces and geom_kind of the input
+struct UVFReorderedMesh {
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+    std::vector<std::vector<float>> attributes; // in mesh.attributes order
+    UVFMeshView view;
+};
+
+// Reorder mesh on up to `threads` workers; the result does not depend on the
+// thread count. Attributes whose size does not match the vertex count are
+// copied unchanged.
+void reorder_mesh_morton(const UVFMeshView& mesh, int threads, UVFReorderedMesh& out);
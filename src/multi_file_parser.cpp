@@ -1,6 +1,17 @@
 #include "vtk_structured_parser.h"
 #include "vtp_to_uvf.h"
 #include "id_utils.h"
+#include "multi_file_parser.h"
+#include "conversion_cache.h"
+#include "file_utils.h"
+#include "file_discovery.h"
+#include "parallel_utils.h"
+#include "progress.h"
+#include "conversion_stats.h"
+#include "conversion_trace.h"
+#include "json_writer.h"
+#include "binary_manifest.h"
+#include "uvf_container.h"
 #include <vtkSmartPointer.h>
 #include <vtkPolyData.h>
 #include <vtkPointData.h>
@@ -15,6 +26,9 @@
 #include <filesystem>
 #include <sstream>
 #include <utility>
+#include <mutex>
+#include <atomic>
+#include <cstdio>
 
 using std::vector;
 using std::string;
@@ -22,15 +36,90 @@ using std::map;
 using std::set;
 using std::pair;
 
+// Substring heuristics mapping a file label to its geometry group
+static string classify_label_group(const string& label) {
+    string lower_label = label;
+    std::transform(lower_label.begin(), lower_label.end(), lower_label.begin(), ::tolower);
+    
+    if (lower_label.find("slice") != string::npos || 
+        lower_label.find("plane") != string::npos ||
+        lower_label.find("xy") != string::npos ||
+        lower_label.find("xz") != string::npos ||
+        lower_label.find("yz") != string::npos) {
+        return "slices";
+    }
+    else if (lower_label.find("surface") != string::npos ||
+             lower_label.find("boundary") != string::npos ||
+             lower_label.find("internal") != string::npos) {
+        return "surfaces";
+    }
+    else if (lower_label.find("iso") != string::npos ||
+             lower_label.find("value") != string::npos ||
+             lower_label.find("level") != string::npos) {
+        return "isosurfaces";
+    }
+    else if (lower_label.find("stream") != string::npos ||
+             lower_label.find("line") != string::npos ||
+             lower_label.find("seed") != string::npos) {
+        return "streamlines";
+    }
+    return "surfaces"; // default
+}
+
+static bool convert_file_list(
+    const vector<string>& vtk_files,
+    const vector<string>& file_labels,
+    const vector<string>& file_dirs,
+    const vector<FileFingerprint>& fingerprints,
+    const char* uvf_dir,
+    const UVFOptions& options
+);
+
 // Multi-file UVF generator based on your diagram structure
 bool generate_multi_file_uvf(
     const vector<string>& vtk_files,
     const vector<string>& file_labels,
     const char* uvf_dir
 ) {
-    if (vtk_files.empty() || vtk_files.size() != file_labels.size()) {
+    return generate_multi_file_uvf(vtk_files, file_labels, uvf_dir, UVFOptions());
+}
+
+bool generate_multi_file_uvf(
+    const vector<string>& vtk_files,
+    const vector<string>& file_labels,
+    const char* uvf_dir,
+    const UVFOptions& options
+) {
+    return generate_multi_file_uvf(vtk_files, file_labels, vector<string>(vtk_files.size()), uvf_dir, options);
+}
+
+bool generate_multi_file_uvf(
+    const vector<string>& vtk_files,
+    const vector<string>& file_labels,
+    const vector<string>& file_dirs,
+    const char* uvf_dir,
+    const UVFOptions& options
+) {
+    vector<FileFingerprint> fingerprints(vtk_files.size());
+    for (size_t i = 0; i < vtk_files.size(); ++i) fingerprint_file(vtk_files[i], fingerprints[i], false);
+    return convert_file_list(vtk_files, file_labels, file_dirs, fingerprints, uvf_dir, options);
+}
+
+// The multi-file generator; fingerprints holds each input's size and mtime as
+// already stat'ed by the caller (no hash), so inputs are not stat'ed again
+static bool convert_file_list(
+    const vector<string>& vtk_files,
+    const vector<string>& file_labels,
+    const vector<string>& file_dirs,
+    const vector<FileFingerprint>& fingerprints,
+    const char* uvf_dir,
+    const UVFOptions& options
+) {
+    if (vtk_files.empty() || vtk_files.size() != file_labels.size() || vtk_files.size() != file_dirs.size() ||
+        vtk_files.size() != fingerprints.size()) {
         return false;
     }
+    UVFTraceSpan run_span(options.trace, "generate_multi_file_uvf", "convert");
     
     string out_dir = string(uvf_dir);
     string resources_dir = out_dir + "/";
@@ -40,241 +129,426 @@ bool generate_multi_file_uvf(
     make_dirs(out_dir + "/resources");
     make_dirs(resources_dir);
     
-    // Categorize files based on labels and contents
-    map<string, vector<pair<string, string>>> groups; // group_name -> [(file_path, label)]
+    // Categorize files based on labels and contents. Files in subdirectories are
+    // grouped under "<subdir>/<group>", classified by their own file name.
+    map<string, vector<pair<string, string>>> groups; // group_id -> [(file_path, label)]
+    map<string, FileFingerprint> fingerprint_of;      // file_path -> size and mtime
     
     for (size_t i = 0; i < vtk_files.size(); ++i) {
         const string& file_path = vtk_files[i];
         const string& label = file_labels[i];
-        string lower_label = label;
-        std::transform(lower_label.begin(), lower_label.end(), lower_label.begin(), ::tolower);
-        
-        string group_name = "surfaces"; // default
-        
-        if (lower_label.find("slice") != string::npos || 
-            lower_label.find("plane") != string::npos ||
-            lower_label.find("xy") != string::npos ||
-            lower_label.find("xz") != string::npos ||
-            lower_label.find("yz") != string::npos) {
-            group_name = "slices";
-        }
-        else if (lower_label.find("surface") != string::npos ||
-                 lower_label.find("boundary") != string::npos ||
-                 lower_label.find("internal") != string::npos) {
-            group_name = "surfaces";
-        }
-        else if (lower_label.find("iso") != string::npos ||
-                 lower_label.find("value") != string::npos ||
-                 lower_label.find("level") != string::npos) {
-            group_name = "isosurfaces";
+        fingerprint_of[file_path] = fingerprints[i];
+        if (file_dirs[i].empty()) {
+            groups[classify_label_group(label)].push_back({file_path, label});
+        } else {
+            string stem = std::filesystem::path(file_path).stem().string();
+            groups[file_dirs[i] + "/" + classify_label_group(stem)].push_back({file_path, label});
         }
-        else if (lower_label.find("stream") != string::npos ||
-                 lower_label.find("line") != string::npos ||
-                 lower_label.find("seed") != string::npos) {
-            group_name = "streamlines";
+    }
+
+    // Every '/' prefix of a group id is an enclosing GeometryGroup
+    map<string, set<string>> child_groups; // group_id -> nested group ids
+    set<string> top_groups;
+    for (const auto& group : groups) {
+        string id = group.first;
+        size_t slash;
+        while ((slash = id.find_last_of('/')) != string::npos) {
+            string parent = id.substr(0, slash);
+            child_groups[parent].insert(id);
+            id = parent;
         }
-        
-        groups[group_name].push_back({file_path, label});
+        top_groups.insert(id);
     }
+    set<string> all_groups = top_groups;
+    for (const auto& group : groups) all_groups.insert(group.first);
+    for (const auto& kv : child_groups) all_groups.insert(kv.first);
     
     // Process each file and generate binary data
     map<string, UVFOffsets> all_offsets;
-    
+
+    // Incremental mode: previous run's record of converted inputs, and the one for this run
+    ConversionCache previous_cache;
+    ConversionCache cache;
+    string cache_path = conversion_cache_path(out_dir);
+    string options_key = uvf_options_key(options);
+    if (options.incremental) previous_cache.load(cache_path);
+    size_t reused = 0;
+
+    // Files that need converting; cache hits are resolved up front
+    vector<pair<string, string>> pending;
     for (const auto& group : groups) {
         for (const auto& file_info : group.second) {
             const string& file_path = file_info.first;
             const string& label = file_info.second;
-            
-            // Load VTK file
-            auto poly = parse_vtp_file(file_path.c_str());
-            if (!poly) {
-                std::cerr << "Failed to load: " << file_path << std::endl;
-                continue;
-            }
-            
-            // Extract geometry data
-            vector<float> vertices;
-            vector<uint32_t> indices;
-            map<string, vector<float>> scalar_data;
-            
-            if (!extract_geometry_data(poly, vertices, indices, scalar_data)) {
-                std::cerr << "Failed to extract data from: " << file_path << std::endl;
-                continue;
-            }
-            
-            // Write binary file
             string bin_path = resources_dir + "/" + label + ".bin";
-            UVFOffsets offsets;
-            if (!write_binary_data(vertices, indices, scalar_data, bin_path, offsets)) {
-                std::cerr << "Failed to write binary data for: " << label << std::endl;
-                continue;
+
+            if (options.incremental) {
+                ConversionCacheEntry hit;
+                if (previous_cache.lookup(file_path, fingerprint_of[file_path], label, options_key, bin_path, hit)) {
+                    all_offsets[label] = hit.offsets;
+                    cache.store(hit);
+                    ++reused;
+                    continue;
+                }
             }
-            
-            all_offsets[label] = offsets;
+            pending.push_back(file_info);
         }
     }
-    
-    // Generate manifest according to your diagram structure
-    std::ostringstream manifest_ss;
-    manifest_ss << "[";
-    
-    bool first = true;
-    
-    // 1. Root GeometryGroup
-    if (!first) manifest_ss << ",";
-    first = false;
-    manifest_ss << "{";
-    manifest_ss << "\"id\":\"root_group\",";
-    manifest_ss << "\"type\":\"GeometryGroup\",";
-    manifest_ss << "\"properties\":{\"type\":0,\"transform\":[1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1]},";
-    manifest_ss << "\"attributions\":{\"members\":[";
-    bool first_member = true;
-    for (const auto& group : groups) {
-        if (!first_member) manifest_ss << ",";
-        first_member = false;
-        manifest_ss << "\"" << group.first << "\"";
+
+    // Input sizes drive byte-level progress
+    UVFProgressReporter progress(options);
+    vector<uint64_t> input_sizes(pending.size(), 0);
+    uint64_t bytes_total = 0;
+    for (size_t k = 0; k < pending.size(); ++k) {
+        input_sizes[k] = fingerprint_of[pending[k].first].size;
+        bytes_total += input_sizes[k];
     }
-    manifest_ss << "]}";
-    manifest_ss << "}";
-    
-    // 2. Group-level GeometryGroups
-    for (const auto& group : groups) {
-        if (!first) manifest_ss << ",";
-        first = false;
-        manifest_ss << "{";
-        manifest_ss << "\"id\":\"" << group.first << "\",";
-        manifest_ss << "\"type\":\"GeometryGroup\",";
-        manifest_ss << "\"properties\":{\"type\":0},";
-        manifest_ss << "\"attributions\":{\"members\":[";
+    std::atomic<uint64_t> bytes_done(0);
+    std::atomic<uint64_t> files_done(0);
+    std::atomic<uint64_t> bytes_written(0);
+    progress.report("convert", 0, bytes_total, 0, pending.size());
+
+    // Convert independent files in parallel. Bins are written to temporaries and
+    // only committed once every file is done, so a cancelled run leaves the
+    // previous output untouched.
+    std::mutex log_mutex;
+    vector<UVFOffsets> results(pending.size());
+    vector<char> converted(pending.size(), 0);
+    vector<uint64_t> content_hashes(pending.size(), 0);
+    // Each file worker gets its share of the thread budget for the per-file
+    // passes (one thread once there are as many files as threads), so nested
+    // parallel loops never start threads x threads workers
+    const size_t budget = static_cast<size_t>(resolve_thread_count(options.threads));
+    const size_t file_workers = std::max<size_t>(1, std::min(budget, pending.size()));
+    UVFOptions file_options = options;
+    file_options.threads = static_cast<int>(budget / file_workers);
+    parallel_for(pending.size(), options.threads, [&](size_t k) {
+        if (progress.cancelled()) return;
+        const string& file_path = pending[k].first;
+        const string& label = pending[k].second;
+        string bin_path = resources_dir + "/" + label + ".bin";
+        UVFTraceSpan file_span(options.trace, "file", "file", file_path);
+
+        // The cache records the content hash of what is about to be converted:
+        // an input rewritten later no longer matches it, so its bin is redone
+        if (options.incremental && !hash_file_content(file_path, content_hashes[k])) {
+            std::lock_guard<std::mutex> lk(log_mutex);
+            std::cerr << "Failed to read: " << file_path << std::endl;
+            return;
+        }
         
-        bool first_sub_member = true;
-        for (const auto& file_info : group.second) {
-            if (!first_sub_member) manifest_ss << ",";
-            first_sub_member = false;
-            manifest_ss << "\"" << file_info.second << "\"";
+        // Load VTK file
+        auto poly = parse_vtp_file(file_path.c_str(), file_options);
+        if (!poly) {
+            std::lock_guard<std::mutex> lk(log_mutex);
+            std::cerr << "Failed to load: " << file_path << std::endl;
+            return;
         }
-        manifest_ss << "]}";
-        manifest_ss << "}";
         
+        // Extract geometry data
+        vector<float> vertices;
+        vector<uint32_t> indices;
+        map<string, vector<float>> scalar_data;
+        
+        UVFStageTimer extract_timer(options, "extract");
+        if (!extract_geometry_data(poly, vertices, indices, scalar_data)) {
+            std::lock_guard<std::mutex> lk(log_mutex);
+            std::cerr << "Failed to extract data from: " << file_path << std::endl;
+            return;
+        }
+        extract_timer.add_items(vertices.size() / 3);
+        extract_timer.stop();
+        
+        // Write binary file (via a temporary so a live viewer never reads a torn bin)
+        UVFStageTimer write_timer(options, "write");
+        if (!write_binary_data(vertices, indices, scalar_data, bin_path + ".tmp", results[k], file_options)) {
+            std::remove((bin_path + ".tmp").c_str());
+            std::lock_guard<std::mutex> lk(log_mutex);
+            std::cerr << "Failed to write binary data for: " << label << std::endl;
+            return;
+        }
+        const uint64_t bin_size = stored_sections_size(results[k]);
+        write_timer.add_bytes(bin_size);
+        write_timer.add_items(1);
+        converted[k] = 1;
+        bytes_written += bin_size;
+        uint64_t done_bytes = bytes_done += input_sizes[k];
+        uint64_t done_files = ++files_done;
+        progress.report("convert", done_bytes, bytes_total, done_files, pending.size());
+    });
+
+    if (progress.cancelled()) {
+        for (size_t k = 0; k < pending.size(); ++k) {
+            if (converted[k]) std::remove((resources_dir + "/" + pending[k].second + ".bin.tmp").c_str());
+        }
+        std::cerr << "Conversion cancelled" << std::endl;
+        return false;
+    }
+
+    for (size_t k = 0; k < pending.size(); ++k) {
+        if (!converted[k]) continue;
+        string bin_path = resources_dir + "/" + pending[k].second + ".bin";
+        if (!commit_file(bin_path + ".tmp", bin_path)) {
+            std::cerr << "Failed to write binary data for: " << pending[k].second << std::endl;
+            converted[k] = 0;
+        }
+    }
+
+    for (size_t k = 0; k < pending.size(); ++k) {
+        if (!converted[k]) continue;
+        const string& file_path = pending[k].first;
+        const string& label = pending[k].second;
+        all_offsets[label] = results[k];
+
+        if (options.incremental) {
+            ConversionCacheEntry entry;
+            entry.input_path = file_path;
+            entry.options_key = options_key;
+            entry.label = label;
+            entry.offsets = results[k];
+            entry.fingerprint = fingerprint_of[file_path];
+            entry.fingerprint.content_hash = content_hashes[k];
+            cache.store(entry);
+        }
+    }
+
+    if (options.incremental) {
+        std::cout << "Reused " << reused << " of " << vtk_files.size() << " cached conversions" << std::endl;
+        if (!cache.save(cache_path)) {
+            std::cerr << "Failed to write conversion cache: " << cache_path << std::endl;
+        }
+    }
+    
+    // Totals cover reused cache entries too, so they describe the whole output
+    if (options.stats) {
+        uint64_t points = 0, triangles = 0;
+        for (const auto& kv : all_offsets) {
+            auto pos = kv.second.fields.find("position");
+            if (pos == kv.second.fields.end()) pos = kv.second.fields.find(UVF_INTERLEAVED_SECTION);
+            if (pos != kv.second.fields.end()) points += section_element_count(pos->second) / pos->second.dimension;
+            auto idx = kv.second.fields.find("indices");
+            if (idx != kv.second.fields.end()) triangles += section_element_count(idx->second) / 3;
+        }
+        options.stats->add_counts(points, triangles, all_offsets.size());
+        options.stats->set_groups(all_groups.size());
+    }
+
+    // Generate manifest according to your diagram structure, streamed into a
+    // temporary file that atomically replaces manifest.json (watch mode
+    // rewrites it under live readers)
+    progress.report("manifest", bytes_total, bytes_total, pending.size(), pending.size());
+    UVFStageTimer manifest_timer(options, "manifest");
+    string manifest_path = out_dir + "/manifest.json";
+    string manifest_tmp = manifest_path + ".tmp";
+    std::ofstream manifest_ofs(manifest_tmp, std::ios::binary);
+    if (!manifest_ofs) return false;
+    UVFJsonWriter json(&manifest_ofs);
+    UVFBinaryManifestBuilder bm(options.binary_manifest);
+    json.begin_array();
+
+    // 1. Root GeometryGroup
+    json.begin_object();
+    json.key("id"); json.value("root_group");
+    json.key("type"); json.value("GeometryGroup");
+    json.key("properties"); json.begin_object();
+    json.key("type"); json.value(0);
+    json.key("transform"); json.raw_value("[1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1]");
+    json.end_object();
+    json.key("attributions"); json.begin_object();
+    json.key("members"); json.begin_array();
+    bm.add_group("root_group", true);
+    for (const auto& group_id : top_groups) {
+        json.value(group_id);
+        bm.add_group_member(group_id);
+    }
+    json.end_array();
+    json.end_object();
+    json.end_object();
+
+    // 2. Group-level GeometryGroups (nested groups first, then the files they hold)
+    for (const auto& group_id : all_groups) {
+        static const vector<pair<string, string>> no_files;
+        auto files_it = groups.find(group_id);
+        const auto& group_files = files_it != groups.end() ? files_it->second : no_files;
+
+        json.begin_object();
+        json.key("id"); json.value(group_id);
+        json.key("type"); json.value("GeometryGroup");
+        json.key("properties"); json.begin_object(); json.key("type"); json.value(0); json.end_object();
+        json.key("attributions"); json.begin_object();
+        json.key("members"); json.begin_array();
+        bm.add_group(group_id, false);
+        auto children_it = child_groups.find(group_id);
+        if (children_it != child_groups.end()) {
+            for (const auto& child : children_it->second) {
+                json.value(child);
+                bm.add_group_member(child);
+            }
+        }
+        for (const auto& file_info : group_files) {
+            json.value(file_info.second);
+            bm.add_group_member(file_info.second);
+        }
+        json.end_array();
+        json.end_object();
+        json.end_object();
+
         // 3. SolidGeometry for each file in the group
-        for (const auto& file_info : group.second) {
+        for (const auto& file_info : group_files) {
             const string& label = file_info.second;
             string geometry_id = generate_geometry_id(label);
             string face_id = generate_face_id(label);
-            
-            if (!first) manifest_ss << ",";
-            first = false;
-            manifest_ss << "{";
-            manifest_ss << "\"id\":\"" << geometry_id << "\",";
-            manifest_ss << "\"type\":\"SolidGeometry\",";
-            manifest_ss << "\"properties\":{},";
-            manifest_ss << "\"attributions\":{";
-            manifest_ss << "\"edges\":[],";
-            manifest_ss << "\"vertices\":[],";
-            manifest_ss << "\"faces\":[\"" << face_id << "\"]";
-            manifest_ss << "}";
-            
-            // Resources
             auto offset_it = all_offsets.find(label);
+
+            json.begin_object();
+            json.key("id"); json.value(geometry_id);
+            json.key("type"); json.value("SolidGeometry");
+            json.key("properties"); json.begin_object(); json.end_object();
+            vector<string> edge_ids;
+            if (offset_it != all_offsets.end()) edge_ids = edge_node_ids(offset_it->second, geometry_id);
+            json.key("attributions"); json.begin_object();
+            json.key("edges"); json.begin_array();
+            for (const auto& id : edge_ids) json.value(id);
+            json.end_array();
+            json.key("vertices"); json.begin_array(); json.end_array();
+            json.key("faces"); json.begin_array(); json.value(face_id); json.end_array();
+            json.end_object();
+            string bin_path = "/" + label + ".bin";
+            bm.add_solid(geometry_id, nullptr, offset_it != all_offsets.end() ? &bin_path : nullptr);
+            for (const auto& id : edge_ids) bm.add_solid_edge(id);
+            bm.add_solid_face(face_id);
+
+            // Resources
             if (offset_it != all_offsets.end()) {
-                manifest_ss << ",\"resources\":{\"buffers\":{";
-                manifest_ss << "\"path\":\"/" << label << ".bin\",";
-                manifest_ss << "\"sections\":[";
-                
-                bool first_section = true;
-                for (const auto& field : offset_it->second.fields) {
-                    if (!first_section) manifest_ss << ",";
-                    first_section = false;
-                    manifest_ss << "{";
-                    manifest_ss << "\"dType\":\"" << field.second.dType << "\",";
-                    manifest_ss << "\"dimension\":" << field.second.dimension << ",";
-                    manifest_ss << "\"length\":" << field.second.length << ",";
-                    manifest_ss << "\"name\":\"" << field.first << "\",";
-                    manifest_ss << "\"offset\":" << field.second.offset;
-                    manifest_ss << "}";
-                }
-                
-                manifest_ss << "],\"type\":\"buffers\"}}";
+                bm.add_solid_sections(offset_it->second);
+                json.key("resources"); json.begin_object();
+                json.key("buffers"); json.begin_object();
+                json.key("path"); json.value(bin_path);
+                json.key("sections"); write_sections_json(json, offset_it->second);
+                json.key("type"); json.value("buffers");
+                json.end_object();
+                json.end_object();
             }
-            
-            manifest_ss << "}";
-            
+            json.end_object();
+
             // 4. Face for each SolidGeometry
-            if (!first) manifest_ss << ",";
-            first = false;
-            manifest_ss << "{";
-            manifest_ss << "\"id\":\"" << face_id << "\",";
-            manifest_ss << "\"type\":\"Face\",";
-            manifest_ss << "\"properties\":{";
-            manifest_ss << "\"alpha\":1.0,";
-            manifest_ss << "\"color\":16777215";
-            
+            json.begin_object();
+            json.key("id"); json.value(face_id);
+            json.key("type"); json.value("Face");
+            json.key("properties"); json.begin_object();
+            json.key("alpha"); json.raw_value("1.0");
+            json.key("color"); json.value(16777215);
+
             // Buffer locations
-            auto offset_it2 = all_offsets.find(label);
-            if (offset_it2 != all_offsets.end()) {
-                auto indices_it = offset_it2->second.fields.find("indices");
-                if (indices_it != offset_it2->second.fields.end()) {
-                    size_t num_triangles = indices_it->second.length / sizeof(uint32_t) / 3;
-                    manifest_ss << ",\"bufferLocations\":{\"indices\":[{";
-                    manifest_ss << "\"bufNum\":0,";
-                    manifest_ss << "\"startIndex\":0,";
-                    manifest_ss << "\"endIndex\":" << num_triangles;
-                    manifest_ss << "}]}";
+            bool located = false;
+            if (offset_it != all_offsets.end()) {
+                auto indices_it = offset_it->second.fields.find("indices");
+                if (indices_it != offset_it->second.fields.end()) {
+                    size_t num_triangles = section_element_count(indices_it->second) / 3;
+                    bm.add_face(face_id, geometry_id, 16777215, 1.0f, 0, num_triangles);
+                    located = true;
+                    json.key("bufferLocations"); json.begin_object();
+                    json.key("indices"); json.begin_array();
+                    json.begin_object();
+                    json.key("bufNum"); json.value(0);
+                    json.key("startIndex"); json.value(0);
+                    json.key("endIndex"); json.value(num_triangles);
+                    json.end_object();
+                    json.end_array();
+                    json.end_object();
                 }
             }
-            
-            manifest_ss << "},";
-            manifest_ss << "\"attributions\":{\"packedParentId\":\"" << geometry_id << "\"}";
-            manifest_ss << "}";
+            if (!located) bm.add_face(face_id, geometry_id, 16777215, 1.0f);
+            json.end_object();
+            json.key("attributions"); json.begin_object();
+            json.key("packedParentId"); json.value(geometry_id);
+            json.end_object();
+            json.end_object();
+
+            // 5. Edge for each extracted edge class
+            if (offset_it != all_offsets.end()) {
+                write_edge_nodes_json(json, offset_it->second, geometry_id, nullptr);
+                add_binary_edge_nodes(bm, offset_it->second, geometry_id);
+            }
         }
     }
-    
-    manifest_ss << "]";
-    
-    // Write manifest
-    string manifest_path = out_dir + "/manifest.json";
-    std::ofstream ofs(manifest_path);
-    if (!ofs) return false;
-    
-    ofs << manifest_ss.str();
-    ofs.close();
-    
-    return true;
+    json.end_array();
+
+    bool manifest_ok = json.flush();
+    manifest_ofs.close();
+    if (!manifest_ok || !manifest_ofs) {
+        std::remove(manifest_tmp.c_str());
+        return false;
+    }
+    // The binary twin is replaced first so a reader that sees the new
+    // manifest.json never pairs it with an older manifest.uvfm
+    string binary_path = out_dir + "/manifest.uvfm";
+    uint64_t binary_size = 0;
+    if (options.binary_manifest) {
+        string binary = bm.serialize();
+        if (!write_file_atomic(binary_path, binary)) {
+            std::remove(manifest_tmp.c_str());
+            return false;
+        }
+        binary_size = binary.size();
+    } else {
+        std::remove(binary_path.c_str()); // stale from an earlier run with the option on
+    }
+    if (!commit_file(manifest_tmp, manifest_path)) return false;
+    manifest_timer.add_bytes(json.bytes_written() + binary_size);
+    manifest_timer.add_items(1);
+    manifest_timer.stop();
+    if (options.stats) options.stats->add_bytes_written(bytes_written + json.bytes_written() + binary_size);
+    return !options.container || pack_uvf_directory(out_dir, options);
 }
 
 // Enhanced CLI interface for multi-file processing
 bool process_directory_structure(const char* input_dir, const char* uvf_dir) {
-    vector<string> vtk_files;
-    vector<string> file_labels;
-    
-    try {
-        for (const auto& entry : std::filesystem::directory_iterator(input_dir)) {
-            if (entry.is_regular_file()) {
-                string ext = entry.path().extension().string();
-                std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-                
-                if (ext == ".vtk" || ext == ".vtp") {
-                    vtk_files.push_back(entry.path().string());
-                    string stem = entry.path().stem().string();
-                    string cleaned_stem = clean_id(stem);
-                    file_labels.push_back(cleaned_stem);
-                }
-            }
-        }
-    } catch (const std::exception& e) {
-        std::cerr << "Error reading directory: " << e.what() << std::endl;
+    return process_directory_structure(input_dir, uvf_dir, UVFOptions());
+}
+
+bool process_directory_structure(const char* input_dir, const char* uvf_dir, const UVFOptions& options) {
+    vector<DiscoveredFile> discovered;
+    if (!discover_input_files(input_dir, options, discovered)) {
         return false;
     }
     
-    if (vtk_files.empty()) {
+    if (discovered.empty()) {
         std::cerr << "No VTK files found in directory: " << input_dir << std::endl;
         return false;
     }
+    return process_directory_structure(discovered, uvf_dir, options);
+}
+
+bool process_directory_structure(const vector<DiscoveredFile>& discovered, const char* uvf_dir, const UVFOptions& options) {
+    if (discovered.empty()) return false;
+    vector<string> vtk_files;
+    vector<string> file_labels;
+    vector<string> file_dirs;
+    vector<FileFingerprint> fingerprints;
+    set<string> used_labels;
+    for (const auto& f : discovered) {
+        std::filesystem::path rel(f.relative_path);
+        string dir = rel.parent_path().generic_string();
+        // Nested files carry their subdirectory in the label so ids and bin names stay unique
+        string base = dir.empty() ? rel.stem().string() : dir + "/" + rel.stem().string();
+        std::replace(base.begin(), base.end(), '/', '_');
+        string label = clean_id(base);
+        for (int n = 2; used_labels.count(label); ++n) label = clean_id(base) + "_" + std::to_string(n);
+        used_labels.insert(label);
+        vtk_files.push_back(f.path);
+        file_labels.push_back(label);
+        file_dirs.push_back(dir);
+        FileFingerprint fp;
+        fp.size = f.size;
+        fp.mtime = f.mtime;
+        fingerprints.push_back(fp);
+    }
     
     std::cout << "Found " << vtk_files.size() << " VTK files:" << std::endl;
     for (size_t i = 0; i < vtk_files.size(); ++i) {
         std::cout << "  " << file_labels[i] << " -> " << vtk_files[i] << std::endl;
     }
     
-    return generate_multi_file_uvf(vtk_files, file_labels, uvf_dir);
+    return convert_file_list(vtk_files, file_labels, file_dirs, fingerprints, uvf_dir, options);
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "uvf_options.h"
+#include "file_discovery.h"
 #include <vector>
 #include <string>
 
@@ -10,5 +12,28 @@ bool generate_multi_file_uvf(
     const char* uvf_dir
 );
 
-// Process all VTK files in a directory
+bool generate_multi_file_uvf(
+    const std::vector<std::string>& vtk_files,
+    const std::vector<std::string>& file_labels,
+    const char* uvf_dir,
+    const UVFOptions& options
+);
+
+// As above; file_dirs holds each file's subdirectory relative to the scanned root
+// ("" for top-level files). Subdirectories become nested GeometryGroups above the
+// usual slices/surfaces/... groups.
+bool generate_multi_file_uvf(
+    const std::vector<std::string>& vtk_files,
+    const std::vector<std::string>& file_labels,
+    const std::vector<std::string>& file_dirs,
+    const char* uvf_dir,
+    const UVFOptions& options
+);
+
+// Process all VTK/STL files in a directory (and its subdirectories with options.recursive)
 bool process_directory_structure(const char* input_dir, const char* uvf_dir);
+bool process_directory_structure(const char* input_dir, const char* uvf_dir, const UVFOptions& options);
+
+// As above, for the (non-empty) result of discover_input_files; their stat'ed
+// size and mtime drive progress and incremental reuse without another stat
+bool process_directory_structure(const std::vector<DiscoveredFile>& files, const char* uvf_dir, const UVFOptions& options);
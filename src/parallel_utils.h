@@ -0,0 +1,54 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Worker count for a requested value (0 or negative = hardware concurrency)
+inline int resolve_thread_count(int requested) {
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    (void)requested;
+    return 1; // no threads in single-threaded wasm builds
+#else
+    if (requested > 0) return requested;
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw > 0 ? static_cast<int>(hw) : 1;
+#endif
+}
+
+// Run fn(i) for every i in [0, n) on up to `threads` workers. Items are handed
+// out dynamically, so uneven item costs (e.g. files of very different sizes)
+// still balance. fn must be safe to call concurrently for distinct i.
+template <class Fn>
+void parallel_for(size_t n, int threads, Fn&& fn) {
+    size_t workers = std::min(static_cast<size_t>(resolve_thread_count(threads)), n);
+    if (workers <= 1) {
+        for (size_t i = 0; i < n; ++i) fn(i);
+        return;
+    }
+    std::atomic<size_t> next(0);
+    auto run = [&]() {
+        for (size_t i = next.fetch_add(1); i < n; i = next.fetch_add(1)) fn(i);
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (size_t t = 1; t < workers; ++t) pool.emplace_back(run);
+    run();
+    for (auto& th : pool) th.join();
+}
+
+// Split [0, n) into contiguous chunks of at least min_chunk items and run
+// fn(begin, end) for each on up to `threads` workers
+template <class Fn>
+void parallel_for_chunks(size_t n, int threads, size_t min_chunk, Fn&& fn) {
+    if (n == 0) return;
+    size_t workers = static_cast<size_t>(resolve_thread_count(threads));
+    size_t chunks = std::max<size_t>(1, std::min(workers * 4, (n + min_chunk - 1) / std::max<size_t>(min_chunk, 1)));
+    size_t step = (n + chunks - 1) / chunks;
+    parallel_for(chunks, threads, [&](size_t c) {
+        size_t begin = c * step;
+        size_t end = std::min(n, begin + step);
+        if (begin < end) fn(begin, end);
+    });
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "uvf_options.h"
+#include <mutex>
+
+// Serialises progress reports from one conversion and exposes its cancel flag.
+// Cheap to call from hot loops: without a callback, report() is a branch.
+class UVFProgressReporter {
+public:
+    explicit UVFProgressReporter(const UVFOptions& options)
+        : callback_(options.progress), cancel_(options.cancel) {}
+
+    bool cancelled() const {
+        return cancel_ && cancel_->load(std::memory_order_relaxed);
+    }
+
+    void report(const char* stage, uint64_t bytes_done, uint64_t bytes_total,
+                uint64_t items_done, uint64_t items_total) {
+        if (!callback_) return;
+        UVFProgress p;
+        p.stage = stage;
+        p.bytes_done = bytes_done;
+        p.bytes_total = bytes_total;
+        p.items_done = items_done;
+        p.items_total = items_total;
+        std::lock_guard<std::mutex> lk(mutex_);
+        callback_(p);
+    }
+
+private:
+    const std::function<void(const UVFProgress&)>& callback_;
+    const std::atomic<bool>* cancel_;
+    std::mutex mutex_;
+};
@@ -0,0 +1,92 @@
+#include "section_codec.h"
+#include "parallel_utils.h"
+#include <vtk_zlib.h>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+
+uint64_t UVFCompressedSection::stored_length() const {
+    uint64_t total = 0;
+    for (uint32_t s : layout.sizes) total += s;
+    return total;
+}
+
+bool is_known_compression(const std::string& codec) {
+    return codec == "none" || codec == "deflate";
+}
+
+bool compress_sections(const std::vector<UVFSectionBytes>& sections, const std::string& codec,
+                       uint32_t block_size, int threads, std::vector<UVFCompressedSection>& out) {
+    if (codec != "deflate") {
+        std::cerr << "Unknown compression: " << codec << std::endl;
+        return false;
+    }
+    if (block_size < UVF_MIN_COMPRESSION_BLOCK_SIZE || block_size > UVF_MAX_COMPRESSION_BLOCK_SIZE) {
+        std::cerr << "Compression block size out of range: " << block_size << std::endl;
+        return false;
+    }
+    // One job per (section, block); jobs of all sections share the workers
+    struct Job { size_t section; size_t block; };
+    std::vector<Job> jobs;
+    out.assign(sections.size(), UVFCompressedSection());
+    for (size_t s = 0; s < sections.size(); ++s) {
+        size_t count = (sections[s].bytes + block_size - 1) / block_size;
+        out[s].layout.codec = codec;
+        out[s].layout.raw_length = sections[s].bytes;
+        out[s].layout.block_size = block_size;
+        out[s].layout.sizes.resize(count);
+        out[s].blocks.resize(count);
+        for (size_t b = 0; b < count; ++b) jobs.push_back({s, b});
+    }
+    // Fastest level: on float fields it compresses as well as the default
+    // level at about three times the speed
+    std::atomic<bool> ok(true);
+    parallel_for(jobs.size(), threads, [&](size_t j) {
+        const Job& job = jobs[j];
+        const UVFSectionBytes& src = sections[job.section];
+        size_t begin = job.block * block_size;
+        uLong n = static_cast<uLong>(std::min<size_t>(block_size, src.bytes - begin));
+        std::string& dst = out[job.section].blocks[job.block];
+        uLongf stored = compressBound(n);
+        dst.resize(stored);
+        if (compress2(reinterpret_cast<Bytef*>(&dst[0]), &stored,
+                      static_cast<const Bytef*>(src.data) + begin, n, Z_BEST_SPEED) != Z_OK) {
+            ok = false;
+            return;
+        }
+        dst.resize(stored);
+        out[job.section].layout.sizes[job.block] = static_cast<uint32_t>(stored);
+    });
+    if (!ok) std::cerr << "Section compression failed" << std::endl;
+    return ok;
+}
+
+bool decompress_section(const void* data, uint64_t stored_length, const UVFSectionBlocks& layout,
+                        void* out, int threads, std::string& error) {
+    if (layout.codec != "deflate") {
+        error = "unknown compression '" + layout.codec + "'";
+        return false;
+    }
+    uint64_t expected = layout.block_size ? (layout.raw_length + layout.block_size - 1) / layout.block_size : 0;
+    if (layout.sizes.size() != expected || (layout.raw_length > 0 && layout.block_size == 0)) {
+        error = "block count does not match the section length";
+        return false;
+    }
+    std::vector<uint64_t> starts(layout.sizes.size() + 1, 0);
+    for (size_t b = 0; b < layout.sizes.size(); ++b) starts[b + 1] = starts[b] + layout.sizes[b];
+    if (starts.back() != stored_length) {
+        error = "block sizes do not add up to the stored length";
+        return false;
+    }
+    std::atomic<bool> ok(true);
+    parallel_for(layout.sizes.size(), threads, [&](size_t b) {
+        uint64_t begin = b * static_cast<uint64_t>(layout.block_size);
+        uLongf n = static_cast<uLongf>(std::min<uint64_t>(layout.block_size, layout.raw_length - begin));
+        uLongf got = n;
+        int rc = uncompress(static_cast<Bytef*>(out) + begin, &got,
+                            static_cast<const Bytef*>(data) + starts[b], static_cast<uLong>(layout.sizes[b]));
+        if (rc != Z_OK || got != n) ok = false;
+    });
+    if (!ok) error = "corrupt compressed block";
+    return ok;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Block-wise section compression (options.compression). A compressed section
+// is cut into blocks of block_size raw bytes (the last one may be shorter),
+// each compressed on its own and stored back to back. Block i starts at the
+// sum of the sizes before it and inflates to min(block_size, raw_length -
+// i * block_size) bytes, so readers can decode blocks in parallel or only
+// the ones they need.
+//
+// Codecs: "deflate" (zlib streams, RFC 1950; DecompressionStream('deflate')
+// in browsers).
+constexpr uint32_t UVF_DEFAULT_COMPRESSION_BLOCK_SIZE = 1u << 20;
+constexpr uint32_t UVF_MIN_COMPRESSION_BLOCK_SIZE = 4096;
+constexpr uint32_t UVF_MAX_COMPRESSION_BLOCK_SIZE = 64u << 20;
+
+// Block layout of a stored section; an empty codec means stored raw
+struct UVFSectionBlocks {
+    std::string codec;
+    uint64_t raw_length = 0;
+    uint32_t block_size = 0;
+    std::vector<uint32_t> sizes; // compressed size of each block
+};
+
+// Raw bytes of one section, borrowed from the caller
+struct UVFSectionBytes {
+    const void* data = nullptr;
+    size_t bytes = 0;
+};
+
+// Compressed blocks of one section, ready to be written in order
+struct UVFCompressedSection {
+    UVFSectionBlocks layout;
+    std::vector<std::string> blocks;
+    uint64_t stored_length() const;
+};
+
+// True for a value options.compression accepts ("none" or a codec above)
+bool is_known_compression(const std::string& codec);
+
+// Compress every section with codec in blocks of block_size bytes. Blocks of
+// all sections are spread over up to `threads` workers together, so a batch
+// of small sections parallelises as well as one large section.
+bool compress_sections(const std::vector<UVFSectionBytes>& sections, const std::string& codec,
+                       uint32_t block_size, int threads, std::vector<UVFCompressedSection>& out);
+
+// Inflate a stored section (stored_length bytes at data) into out, which must
+// hold layout.raw_length bytes. Fails on corrupt or truncated blocks.
+bool decompress_section(const void* data, uint64_t stored_length, const UVFSectionBlocks& layout,
+                        void* out, int threads, std::string& error);
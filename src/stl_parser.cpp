@@ -1,7 +1,14 @@
 #include "stl_parser.h"
 #include <vtkSTLReader.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
 #include <string>
 #include <algorithm>
+#include <array>
+#include <cstring>
+#include <cstdint>
+#include <map>
+#include <sstream>
 
 vtkSmartPointer<vtkPolyData> parse_stl_file(const char* path) {
     if (!path) return nullptr;
@@ -18,3 +25,81 @@ vtkSmartPointer<vtkPolyData> parse_stl_file(const char* path) {
     return output;
 }
 
+
+namespace {
+    // Builds triangles while merging exactly coincident points
+    struct STLMeshBuilder {
+        vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+        vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+        std::map<std::array<float, 3>, vtkIdType> ids;
+
+        vtkIdType point(const std::array<float, 3>& p) {
+            auto it = ids.find(p);
+            if (it != ids.end()) return it->second;
+            vtkIdType id = points->InsertNextPoint(p[0], p[1], p[2]);
+            ids.emplace(p, id);
+            return id;
+        }
+
+        void triangle(const std::array<float, 3>* v) {
+            vtkIdType a = point(v[0]), b = point(v[1]), c = point(v[2]);
+            if (a == b || b == c || a == c) return; // degenerate after merging
+            polys->InsertNextCell(3);
+            polys->InsertCellPoint(a);
+            polys->InsertCellPoint(b);
+            polys->InsertCellPoint(c);
+        }
+
+        vtkSmartPointer<vtkPolyData> finish() {
+            if (points->GetNumberOfPoints() == 0) return nullptr;
+            auto poly = vtkSmartPointer<vtkPolyData>::New();
+            poly->SetPoints(points);
+            poly->SetPolys(polys);
+            return poly;
+        }
+    };
+
+    bool is_binary_stl(const char* bytes, size_t size) {
+        if (size < 84) return false;
+        uint32_t count = 0;
+        std::memcpy(&count, bytes + 80, 4);
+        // Exact size match wins even when the header starts with "solid"
+        if (84 + static_cast<uint64_t>(count) * 50 == size) return true;
+        return !(size >= 5 && std::strncmp(bytes, "solid", 5) == 0);
+    }
+}
+
+vtkSmartPointer<vtkPolyData> parse_stl_buffer(const void* data, size_t size) {
+    if (!data || size == 0) return nullptr;
+    const char* bytes = static_cast<const char*>(data);
+    STLMeshBuilder mesh;
+
+    if (is_binary_stl(bytes, size)) {
+        if (size < 84) return nullptr;
+        uint32_t count = 0;
+        std::memcpy(&count, bytes + 80, 4);
+        if (84 + static_cast<uint64_t>(count) * 50 > size) return nullptr;
+        const char* p = bytes + 84;
+        for (uint32_t t = 0; t < count; ++t, p += 50) {
+            std::array<float, 3> v[3];
+            std::memcpy(v, p + 12, 36); // skip the facet normal
+            mesh.triangle(v);
+        }
+        return mesh.finish();
+    }
+
+    std::istringstream in(std::string(bytes, size));
+    std::string token;
+    std::array<float, 3> v[3];
+    int n = 0;
+    while (in >> token) {
+        if (token == "vertex") {
+            if (n < 3 && (in >> v[n][0] >> v[n][1] >> v[n][2])) ++n;
+            else return nullptr;
+        } else if (token == "endloop") {
+            if (n == 3) mesh.triangle(v);
+            n = 0;
+        }
+    }
+    return mesh.finish();
+}
@@ -9,3 +9,12 @@
  */
 vtkSmartPointer<vtkPolyData> parse_stl_file(const char* path);
 
+
+/**
+ * Parse an in-memory STL image (ASCII or Binary format) into vtkPolyData.
+ * Coincident vertices are merged, as vtkSTLReader does for files.
+ * @param data STL bytes
+ * @param size Number of bytes
+ * @return vtkPolyData containing the mesh, or nullptr on failure
+ */
+vtkSmartPointer<vtkPolyData> parse_stl_buffer(const void* data, size_t size);
@@ -0,0 +1,322 @@
+#include "time_series.h"
+#include "vtk_structured_parser.h"
+#include "vtp_to_uvf.h"
+#include "conversion_stats.h"
+#include "json_writer.h"
+#include "uvf_container.h"
+#include "progress.h"
+#include "file_utils.h"
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <sstream>
+
+namespace {
+    // Attribute value inside a single XML tag, e.g. file="a.vtp"
+    bool xml_attr(const string& tag, const string& key, string& value) {
+        string needle = " " + key + "=\"";
+        auto pos = tag.find(needle);
+        if (pos == string::npos) return false;
+        pos += needle.size();
+        auto end = tag.find('"', pos);
+        if (end == string::npos) return false;
+        value = tag.substr(pos, end - pos);
+        return true;
+    }
+
+    struct StepGeometry {
+        string bin_name;
+        UVFOffsets offsets;
+        size_t index_count = 0;
+    };
+
+    struct StepRecord {
+        double time = 0;
+        size_t geometry = 0;
+        bool keyframe = true;
+        string bin_name;
+        UVFOffsets offsets;
+        map<string, std::pair<float, float>> ranges;
+    };
+
+    // Encode cur against prev in place of bit patterns; both encodings are exactly reversible
+    void encode_against(const vector<float>& prev, const vector<float>& cur, vector<uint32_t>& out, bool use_xor) {
+        out.resize(cur.size());
+        for (size_t i = 0; i < cur.size(); ++i) {
+            uint32_t a, b;
+            std::memcpy(&a, &prev[i], 4);
+            std::memcpy(&b, &cur[i], 4);
+            out[i] = use_xor ? (b ^ a) : (b - a);
+        }
+    }
+}
+
+bool parse_pvd_collection(const char* pvd_path, vector<string>& files, vector<double>& times) {
+    files.clear();
+    times.clear();
+    if (!pvd_path) return false;
+    std::ifstream ifs(pvd_path);
+    if (!ifs) return false;
+    string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    std::filesystem::path base = std::filesystem::path(pvd_path).parent_path();
+
+    vector<std::pair<double, string>> steps;
+    size_t pos = 0;
+    while ((pos = content.find("<DataSet", pos)) != string::npos) {
+        auto end = content.find('>', pos);
+        if (end == string::npos) break;
+        string tag = content.substr(pos, end - pos);
+        pos = end;
+        string file, timestep, part;
+        if (!xml_attr(tag, "file", file)) continue;
+        if (xml_attr(tag, "part", part) && part != "0") continue;
+        double t = static_cast<double>(steps.size());
+        if (xml_attr(tag, "timestep", timestep)) {
+            try { t = std::stod(timestep); } catch (const std::exception&) {}
+        }
+        std::filesystem::path fp(file);
+        if (fp.is_relative()) fp = base / fp;
+        steps.push_back({t, fp.string()});
+    }
+    std::stable_sort(steps.begin(), steps.end(),
+                     [](const std::pair<double, string>& a, const std::pair<double, string>& b) { return a.first < b.first; });
+    for (const auto& s : steps) {
+        times.push_back(s.first);
+        files.push_back(s.second);
+    }
+    return !files.empty();
+}
+
+bool generate_time_series_uvf(const vector<string>& files, const vector<double>& times, const char* uvf_dir,
+                              const UVFOptions& options) {
+    if (files.empty() || files.size() != times.size()) return false;
+    bool use_encoding = options.time_encoding == "delta" || options.time_encoding == "xor";
+    if (!use_encoding && options.time_encoding != "none") {
+        std::cerr << "Unknown time encoding: " << options.time_encoding << std::endl;
+        return false;
+    }
+    bool use_xor = options.time_encoding == "xor";
+    // Step scalars are indexed by the input vertex order, so geometry is never reordered
+    UVFOptions geometry_options = options;
+    geometry_options.reorder = "none";
+
+    string out_dir = string(uvf_dir);
+    make_dirs(out_dir);
+
+    vector<StepGeometry> geometries;
+    vector<StepRecord> steps;
+    vector<float> geom_vertices;      // geometry currently shared by consecutive steps
+    vector<uint32_t> geom_indices;
+    map<string, vector<float>> prev_scalars;
+    string geom_kind = "surface";
+    size_t steps_since_keyframe = 0;
+
+    // A failed or cancelled run (cancelled runs stop before their next step)
+    // removes every bin it wrote, including the step bin being written
+    UVFProgressReporter progress(options);
+    string partial_bin;
+    auto fail = [&]() {
+        for (const auto& g : geometries) std::remove((out_dir + "/" + g.bin_name).c_str());
+        for (const auto& s : steps) std::remove((out_dir + "/" + s.bin_name).c_str());
+        if (!partial_bin.empty()) std::remove((out_dir + "/" + partial_bin).c_str());
+        if (progress.cancelled()) std::cerr << "Conversion cancelled" << std::endl;
+        return false;
+    };
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (progress.cancelled()) return fail();
+        progress.report("convert", 0, 0, i, files.size());
+        auto poly = parse_vtp_file(files[i].c_str(), options);
+        if (!poly) {
+            std::cerr << "Failed to load: " << files[i] << std::endl;
+            return fail();
+        }
+        vector<float> vertices;
+        vector<uint32_t> indices;
+        map<string, vector<float>> scalar_data;
+        UVFStageTimer extract_timer(options, "extract");
+        if (!extract_geometry_data(poly, vertices, indices, scalar_data)) {
+            std::cerr << "Failed to extract data from: " << files[i] << std::endl;
+            return fail();
+        }
+        extract_timer.add_items(vertices.size() / 3);
+        extract_timer.stop();
+        if (options.stats) options.stats->add_counts(vertices.size() / 3, indices.size() / 3, 1);
+
+        bool same_topology = !geometries.empty() && vertices == geom_vertices && indices == geom_indices;
+        if (!same_topology) {
+            StepGeometry g;
+            g.bin_name = "geometry_" + std::to_string(geometries.size()) + ".bin";
+            g.index_count = indices.size();
+            if (!write_binary_data(vertices, indices, {}, out_dir + "/" + g.bin_name, g.offsets, geometry_options)) {
+                return fail();
+            }
+            if (geometries.empty()) geom_kind = classify_geometry_kind(poly, vertices, indices, scalar_data, "uvf");
+            geometries.push_back(g);
+            geom_vertices.swap(vertices);
+            geom_indices.swap(indices);
+            prev_scalars.clear(); // encodings never reach across a topology change
+        }
+
+        StepRecord rec;
+        rec.time = times[i];
+        rec.geometry = geometries.size() - 1;
+        rec.keyframe = !same_topology || !use_encoding ||
+                       (options.time_keyframe_interval > 0 && steps_since_keyframe + 1 >= static_cast<size_t>(options.time_keyframe_interval));
+        steps_since_keyframe = rec.keyframe ? 0 : steps_since_keyframe + 1;
+        rec.bin_name = "step_" + std::to_string(i) + ".bin";
+
+        size_t n_points = geom_vertices.size() / 3;
+        partial_bin = rec.bin_name;
+        std::ofstream ofs(out_dir + "/" + rec.bin_name, std::ios::binary);
+        if (!ofs) return fail();
+        vector<UVFSectionSource> sections;
+        std::list<vector<uint32_t>> encoded; // stable storage for the encoded sections
+        for (const auto& kv : scalar_data) {
+            const auto& data = kv.second;
+            int dim = (n_points > 0 && data.size() % n_points == 0) ? static_cast<int>(data.size() / n_points) : 1;
+            if (!data.empty()) {
+                auto mm = std::minmax_element(data.begin(), data.end());
+                rec.ranges[kv.first] = {*mm.first, *mm.second};
+            }
+            auto prev = prev_scalars.find(kv.first);
+            size_t bytes = data.size() * sizeof(float);
+            if (!rec.keyframe && prev != prev_scalars.end() && prev->second.size() == data.size()) {
+                encoded.emplace_back();
+                encode_against(prev->second, data, encoded.back(), use_xor);
+                sections.push_back(make_section_source(kv.first, encoded.back().data(), bytes, "uint32", dim));
+                sections.back().encoding = options.time_encoding;
+            } else {
+                sections.push_back(make_section_source(kv.first, data.data(), bytes, "float32", dim));
+            }
+        }
+        UVFPreparedSections prepared;
+        bool written = prepare_sections(sections, false, options, prepared) && write_prepared_sections(prepared, ofs, rec.offsets);
+        ofs.close();
+        if (!written || !ofs) return fail();
+        if (use_encoding) prev_scalars = std::move(scalar_data);
+        steps.push_back(std::move(rec));
+        partial_bin.clear();
+    }
+    if (progress.cancelled()) return fail();
+    progress.report("convert", 0, 0, files.size(), files.size());
+
+    // Manifest: same three layers as the single-file generator; the SolidGeometry
+    // points at the first geometry and describes every step under "timeSeries"
+    const string second_layer_id = second_layer_id_for(geom_kind);
+    const string name = "uvf";
+
+    auto write_buffers = [&](UVFJsonWriter& json) {
+        json.begin_object();
+        json.key("buffers"); json.begin_object();
+        json.key("path"); json.value(geometries[0].bin_name);
+        json.key("sections"); write_sections_json(json, geometries[0].offsets);
+        json.key("type"); json.value("buffers");
+        json.end_object();
+        json.end_object();
+    };
+    auto write_time_series = [&](UVFJsonWriter& json) {
+        json.begin_object();
+        json.key("encoding"); json.value(options.time_encoding);
+        json.key("geometries"); json.begin_array();
+        for (const auto& g : geometries) {
+            json.begin_object();
+            json.key("indexCount"); json.value(g.index_count);
+            json.key("path"); json.value(g.bin_name);
+            json.key("sections"); write_sections_json(json, g.offsets);
+            json.end_object();
+        }
+        json.end_array();
+        json.key("steps"); json.begin_array();
+        for (const auto& s : steps) {
+            json.begin_object();
+            json.key("geometry"); json.value(s.geometry);
+            json.key("keyframe"); json.value(s.keyframe);
+            json.key("path"); json.value(s.bin_name);
+            json.key("sections"); write_sections_json(json, s.offsets, &s.ranges);
+            json.key("time"); json.value(s.time);
+            json.end_object();
+        }
+        json.end_array();
+        json.end_object();
+    };
+
+    // Streamed to a temporary that replaces manifest.json only once complete
+    const string manifest_path = out_dir + "/manifest.json";
+    const string manifest_tmp = manifest_path + ".tmp";
+    std::ofstream mfs(manifest_tmp, std::ios::binary);
+    if (!mfs) return fail();
+    UVFJsonWriter json(&mfs);
+    bool streamline = geom_kind == "streamline";
+    json.begin_array();
+    json.begin_object();
+    json.key("attributions"); json.begin_object();
+    json.key("members"); json.begin_array(); json.value(second_layer_id); json.end_array();
+    json.end_object();
+    json.key("id"); json.value("root_group");
+    json.key("properties"); json.begin_object();
+    json.key("transform"); json.raw_value("[1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1]");
+    json.key("type"); json.value(0);
+    json.end_object();
+    json.key("type"); json.value("GeometryGroup");
+    json.end_object();
+
+    json.begin_object();
+    json.key("attributions"); json.begin_object();
+    // Edge nodes follow the first geometry, as the Face's range does
+    json.key("edges"); json.begin_array();
+    if (streamline) json.value(name);
+    else for (const auto& id : edge_node_ids(geometries[0].offsets, second_layer_id)) json.value(id);
+    json.end_array();
+    json.key("faces"); json.begin_array(); if (!streamline) json.value(name); json.end_array();
+    json.key("vertices"); json.begin_array(); json.end_array();
+    json.end_object();
+    json.key("id"); json.value(second_layer_id);
+    json.key("properties"); json.begin_object();
+    json.key("geomKind"); json.value(geom_kind);
+    json.key("timeSeries"); write_time_series(json);
+    json.end_object();
+    json.key("resources"); write_buffers(json);
+    json.key("type"); json.value("SolidGeometry");
+    json.end_object();
+
+    json.begin_object();
+    json.key("attributions"); json.begin_object();
+    json.key("packedParentId"); json.value(second_layer_id);
+    json.end_object();
+    json.key("id"); json.value(name);
+    json.key("properties"); json.begin_object();
+    json.key("alpha"); json.value(1);
+    json.key("bufferLocations"); json.begin_object();
+    json.key("indices"); json.begin_array();
+    json.begin_object();
+    json.key("bufNum"); json.value(0);
+    json.key("endIndex"); json.value(geometries[0].index_count);
+    json.key("startIndex"); json.value(0);
+    json.end_object();
+    json.end_array();
+    json.end_object();
+    json.key("color"); json.value(16777215);
+    json.key("geomKind"); json.value(geom_kind);
+    json.end_object();
+    json.key("type"); json.value("Face");
+    json.end_object();
+    if (!streamline) write_edge_nodes_json(json, geometries[0].offsets, second_layer_id, &geom_kind);
+    json.end_array();
+    bool flushed = json.flush();
+    mfs.close();
+    if (!flushed || !mfs || !commit_file(manifest_tmp, manifest_path)) {
+        std::remove(manifest_tmp.c_str());
+        return fail();
+    }
+
+    std::cout << "Time series: " << steps.size() << " steps, " << geometries.size() << " distinct geometr"
+              << (geometries.size() == 1 ? "y" : "ies") << std::endl;
+    return !options.container || pack_uvf_directory(out_dir, options);
+}
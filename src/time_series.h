@@ -0,0 +1,25 @@
+#pragma once
+
+#include "uvf_options.h"
+#include <vector>
+#include <string>
+
+// Read a ParaView .pvd collection into data files (resolved against the .pvd
+// location) ordered by timestep. Only the first part of each timestep is used.
+bool parse_pvd_collection(
+    const char* pvd_path,
+    std::vector<std::string>& files,
+    std::vector<double>& times
+);
+
+// Convert an ordered list of timestep files into one UVF scene. Geometry
+// (indices + position) is written once per distinct topology as geometry_<k>.bin;
+// each timestep only writes its point arrays to step_<i>.bin, optionally encoded
+// against the previous step. The SolidGeometry gains a "timeSeries" property
+// describing the time axis.
+bool generate_time_series_uvf(
+    const std::vector<std::string>& files,
+    const std::vector<double>& times,
+    const char* uvf_dir,
+    const UVFOptions& options
+);
@@ -1,6 +1,11 @@
+#include "uvf_c_api.h"
 #include "vtp_to_uvf.h"
 #include "vtk_structured_parser.h"
 #include "multi_file_parser.h"
+#include "file_discovery.h"
+#include "uvf_output.h"
+#include "conversion_stats.h"
+#include "conversion_trace.h"
 #include <string>
 #include <vector>
 #include <memory>
@@ -10,149 +15,561 @@
 #include <vtkPoints.h>
 #include <vtkCellArray.h>
 #include <mutex>
+#include <atomic>
 #include <filesystem>
+#include <climits>
+#include <cstdlib>
 
-// Enhanced state for tracking multiple operations
-namespace {
-    std::string g_last_error;
-    int g_last_point_count = 0;
-    int g_last_triangle_count = 0;
-    int g_last_file_count = 0;
-    int g_last_group_count = 0;
-    std::string g_last_operation_type;
-    std::mutex g_mutex;
+// Per-caller conversion state: options in, results out. A context is used by
+// one thread at a time; distinct contexts never share mutable state.
+struct uvf_context {
+    UVFOptions options;
+    std::string last_error;
+    long long point_count = 0;
+    long long triangle_count = 0;
+    int file_count = 0;
+    int group_count = 0;
+    std::string operation_type;
+    // Progress and cancellation hooks, installed into options for each run
+    uvf_progress_fn progress_fn = nullptr;
+    void* progress_user = nullptr;
+    std::atomic<bool> cancel{false};
+    // Results of the last in-memory conversion; data is owned by the caller
+    std::vector<std::string> buffer_names;
+    std::vector<uvf_buffer> buffers;
+    // Timings and counters of the last run, snapshotted when it ends
+    UVFConversionStats stats;
+    std::vector<UVFStageStats> stages;
+    std::string stats_json;
+    // Trace-event file written after each run (empty: tracing off)
+    std::string trace_path;
+    std::unique_ptr<UVFTraceRecorder> trace;
 
     void set_error(const std::string& e){
-        std::lock_guard<std::mutex> lk(g_mutex);
-        g_last_error = e;
+        last_error = e;
     }
 
-    void set_stats(int pts, int tris, int files = 1, int groups = 1, const std::string& op_type = "basic"){
-        std::lock_guard<std::mutex> lk(g_mutex);
-        g_last_point_count = pts;
-        g_last_triangle_count = tris;
-        g_last_file_count = files;
-        g_last_group_count = groups;
-        g_last_operation_type = op_type;
+    void set_stats(long long pts, long long tris, int files = 1, int groups = 1, const std::string& op_type = "basic"){
+        point_count = pts;
+        triangle_count = tris;
+        file_count = files;
+        group_count = groups;
+        operation_type = op_type;
     }
-}
+};
 
-extern "C" {
+// Conversions shared by the context API and the legacy global API
+namespace {
+    // Start a conversion: clear the previous run's error, counts and stale
+    // cancel request, and hook the context's callback and flag into its options
+    void begin_run(uvf_context& ctx) {
+        ctx.last_error.clear();
+        ctx.set_stats(0, 0, 0, 0, "");
+        ctx.cancel = false;
+        ctx.options.cancel = &ctx.cancel;
+        ctx.stats.reset();
+        ctx.stats.start();
+        ctx.options.stats = &ctx.stats;
+        ctx.trace.reset(ctx.trace_path.empty() ? nullptr : new UVFTraceRecorder());
+        ctx.options.trace = ctx.trace.get();
+        if (ctx.progress_fn) {
+            uvf_progress_fn fn = ctx.progress_fn;
+            void* user = ctx.progress_user;
+            ctx.options.progress = [fn, user](const UVFProgress& p) {
+                uvf_progress c = {p.stage, p.bytes_done, p.bytes_total, p.items_done, p.items_total};
+                fn(&c, user);
+            };
+        } else {
+            ctx.options.progress = nullptr;
+        }
+    }
 
-// ====== Basic Functions ======
+    // Stop the clock and keep a snapshot the stats queries can point into
+    int end_run(uvf_context& ctx, int result) {
+        ctx.stats.finish();
+        ctx.stages = ctx.stats.stages();
+        ctx.stats_json = ctx.stats.to_json();
+        if (ctx.trace && !ctx.trace->write(ctx.trace_path)) {
+            ctx.set_error("Failed to write trace: " + ctx.trace_path);
+            result = 0;
+        }
+        ctx.trace.reset();
+        ctx.options.trace = nullptr;
+        return result;
+    }
 
-// Basic existence check
-int parse_vtp(const char* vtp_path) {
-    auto poly = parse_vtp_file(vtp_path);
-    if(!poly){
-        set_error("Parse failed");
-        return 0;
+    // Failure message, unless the failure was a requested cancellation
+    void fail(uvf_context& ctx, const std::string& error) {
+        ctx.set_error(ctx.cancel ? "Cancelled" : error);
     }
-    set_stats(poly->GetNumberOfPoints(), poly->GetNumberOfPolys(), 1, 1, "parse_check");
-    return 1;
-}
 
-// Generate UVF directory from VTP file path -> output dir (basic mode)
-int generate_uvf(const char* vtp_path, const char* uvf_dir) {
-    auto poly = parse_vtp_file(vtp_path);
-    if (!poly){
-        set_error("Parse failed");
-        return 0;
+    int run_parse_check(uvf_context& ctx, const char* vtp_path) {
+        begin_run(ctx);
+        try {
+            auto poly = parse_vtp_file(vtp_path, ctx.options);
+            if(!poly){
+                ctx.set_error("Parse failed");
+                return 0;
+            }
+            const uint64_t triangles = count_triangles(poly);
+            ctx.stats.add_counts(poly->GetNumberOfPoints(), triangles, 1);
+            ctx.set_stats(poly->GetNumberOfPoints(), triangles, 1, 1, "parse_check");
+            return 1;
+        } catch (const std::exception& e) {
+            ctx.set_error(std::string("Parse check error: ") + e.what());
+            return 0;
+        }
     }
-    bool ok = ::generate_uvf(poly, uvf_dir);
-    if(!ok){
-        set_error("UVF generation failed");
-        return 0;
+
+    // Generate UVF directory from VTP file path -> output dir (basic mode)
+    int run_generate(uvf_context& ctx, const char* vtp_path, const char* uvf_dir) {
+        begin_run(ctx);
+        try {
+            auto poly = parse_vtp_file(vtp_path, ctx.options);
+            if (!poly){
+                ctx.set_error("Parse failed");
+                return 0;
+            }
+            bool ok = ::generate_uvf(poly, uvf_dir, ctx.options);
+            if(!ok){
+                fail(ctx, "UVF generation failed");
+                return 0;
+            }
+            ctx.stats.add_counts(0, 0, 1);
+            ctx.stats.set_groups(1);
+            ctx.set_stats(ctx.stats.points(), ctx.stats.triangles(), 1, 1, "basic_uvf");
+            return 1;
+        } catch (const std::exception& e) {
+            ctx.set_error(std::string("UVF generation error: ") + e.what());
+            return 0;
+        }
     }
-    set_stats(poly->GetNumberOfPoints(), static_cast<int>(poly->GetNumberOfPolys()), 1, 1, "basic_uvf");
-    return 1;
-}
 
-// ====== Enhanced Functions ======
+    // Generate UVF using structured parsing (field-based classification)
+    int run_generate_structured(uvf_context& ctx, const char* vtp_path, const char* uvf_dir) {
+        begin_run(ctx);
+        try {
+            auto poly = parse_vtp_file(vtp_path, ctx.options);
+            if (!poly){
+                ctx.set_error("Parse failed");
+                return 0;
+            }
+            bool ok = generate_structured_uvf(poly, uvf_dir, ctx.options);
+            if(!ok){
+                fail(ctx, "Structured UVF generation failed");
+                return 0;
+            }
+            // The structured generator records stages only; report what was parsed
+            const uint64_t triangles = count_triangles(poly);
+            ctx.stats.add_counts(poly->GetNumberOfPoints(), triangles, 1);
+            ctx.stats.set_groups(2);
+            ctx.set_stats(poly->GetNumberOfPoints(), triangles, 1, 2, "structured_uvf");
+            return 1;
+        } catch (const std::exception& e) {
+            ctx.set_error(std::string("Structured processing error: ") + e.what());
+            return 0;
+        }
+    }
 
-// Generate UVF using structured parsing (field-based classification)
-int generate_uvf_structured(const char* vtp_path, const char* uvf_dir) {
-    auto poly = parse_vtp_file(vtp_path);
-    if (!poly){
-        set_error("Parse failed");
-        return 0;
+    // Generate UVF from directory with multiple VTK files (recommended)
+    int run_generate_directory(uvf_context& ctx, const char* input_dir, const char* uvf_dir) {
+        begin_run(ctx);
+        try {
+            // Discover once; the list (with its stat results) is converted as is
+            std::vector<DiscoveredFile> files;
+            if (!input_dir || !discover_input_files(input_dir, ctx.options, files)) {
+                ctx.set_error("Cannot read input directory");
+                return 0;
+            }
+            int file_count = static_cast<int>(files.size());
+
+            if (file_count == 0) {
+                ctx.set_error("No VTK files found in directory");
+                return 0;
+            }
+
+            bool ok = process_directory_structure(files, uvf_dir, ctx.options);
+            if(!ok){
+                fail(ctx, "Directory UVF generation failed");
+                return 0;
+            }
+
+            ctx.set_stats(ctx.stats.points(), ctx.stats.triangles(), file_count,
+                          static_cast<int>(ctx.stats.groups()), "directory_multi");
+            return 1;
+
+        } catch (const std::exception& e) {
+            ctx.set_error(std::string("Directory processing error: ") + e.what());
+            return 0;
+        }
     }
-    bool ok = generate_structured_uvf(poly, uvf_dir);
-    if(!ok){
-        set_error("Structured UVF generation failed");
-        return 0;
+
+    UVFMemoryOutput::Allocator wrap_allocator(uvf_allocator alloc, void* user_data) {
+        if (!alloc) return UVFMemoryOutput::Allocator();
+        return [alloc, user_data](void* ptr, size_t n) { return alloc(user_data, ptr, n); };
     }
-    set_stats(poly->GetNumberOfPoints(), static_cast<int>(poly->GetNumberOfPolys()), 1, 2, "structured_uvf");
-    return 1;
-}
 
-// Generate UVF from directory with multiple VTK files (recommended)
-int generate_uvf_directory(const char* input_dir, const char* uvf_dir) {
-    try {
-        // Count files first
-        int file_count = 0;
-    for (const auto& entry : std::filesystem::directory_iterator(input_dir)) {
-            if (entry.is_regular_file()) {
-                std::string ext = entry.path().extension().string();
-                std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-                if (ext == ".vtk" || ext == ".vtp" || ext == ".stl") {
-                    file_count++;
-                }
+    // Hand the blocks of a finished memory output to the caller
+    void publish_buffers(uvf_context& ctx, UVFMemoryOutput& out) {
+        auto blocks = out.release();
+        ctx.buffer_names.reserve(blocks.size());
+        for (const auto& b : blocks) ctx.buffer_names.push_back(b.name);
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            ctx.buffers.push_back({ctx.buffer_names[i].c_str(), blocks[i].data, blocks[i].size});
+        }
+    }
+
+    // Convert an in-memory dataset into blocks from the caller's allocator
+    int run_generate_buffer(uvf_context& ctx, const void* data, size_t size, const char* format,
+                            uvf_allocator alloc, void* user_data) {
+        begin_run(ctx);
+        try {
+            ctx.buffers.clear();
+            ctx.buffer_names.clear();
+            if (!data || !format) {
+                ctx.set_error("Invalid input buffer");
+                return 0;
+            }
+            UVFStageTimer parse_timer(ctx.options, "parse");
+            auto poly = parse_polydata_buffer(data, size, format);
+            parse_timer.add_bytes(size);
+            parse_timer.add_items(1);
+            parse_timer.stop();
+            if (!poly){
+                ctx.set_error("Parse failed");
+                return 0;
+            }
+            UVFMemoryOutput out(wrap_allocator(alloc, user_data));
+            if (!::generate_uvf(poly, out, ctx.options)) {
+                fail(ctx, "UVF generation failed");
+                return 0;
             }
+            publish_buffers(ctx, out);
+            ctx.stats.add_counts(0, 0, 1);
+            ctx.stats.set_groups(1);
+            ctx.set_stats(ctx.stats.points(), ctx.stats.triangles(), 1, 1, "buffer_uvf");
+            return 1;
+        } catch (const std::exception& e) {
+            ctx.set_error(std::string("Buffer processing error: ") + e.what());
+            return 0;
+        }
+    }
+
+    // Borrow the caller's arrays; only descriptors are copied
+    bool make_mesh_view(uvf_context& ctx, const uvf_mesh* mesh, UVFMeshView& view) {
+        if (!mesh) {
+            ctx.set_error("Invalid mesh");
+            return false;
+        }
+        view.positions = mesh->positions;
+        view.vertex_count = mesh->vertex_count;
+        view.indices = mesh->indices;
+        view.index_count = mesh->index_count;
+        if (mesh->geom_kind) view.geom_kind = mesh->geom_kind;
+        if (mesh->attribute_count > 0 && !mesh->attributes) {
+            ctx.set_error("Invalid mesh: attributes missing");
+            return false;
         }
+        for (int i = 0; i < mesh->attribute_count; ++i) {
+            const uvf_attribute& a = mesh->attributes[i];
+            view.attributes.push_back({a.name ? a.name : "", a.data, a.count, a.components});
+        }
+        if (mesh->face_count > 0 && !mesh->faces) {
+            ctx.set_error("Invalid mesh: faces missing");
+            return false;
+        }
+        for (int i = 0; i < mesh->face_count; ++i) {
+            const uvf_face_range& f = mesh->faces[i];
+            view.faces.push_back({f.id ? f.id : "", f.start_index, f.end_index});
+        }
+        std::string error;
+        if (!validate_mesh_view(view, error)) {
+            ctx.set_error("Invalid mesh: " + error);
+            return false;
+        }
+        return true;
+    }
 
-        if (file_count == 0) {
-            set_error("No VTK files found in directory");
+    int run_generate_mesh(uvf_context& ctx, const uvf_mesh* mesh, const char* uvf_dir) {
+        begin_run(ctx);
+        try {
+            UVFMeshView view;
+            if (!make_mesh_view(ctx, mesh, view)) return 0;
+            if (!uvf_dir || !::generate_uvf(view, uvf_dir, ctx.options)) {
+                fail(ctx, "UVF generation failed");
+                return 0;
+            }
+            ctx.stats.add_counts(0, 0, 1);
+            ctx.stats.set_groups(1);
+            ctx.set_stats(view.vertex_count, view.index_count / 3, 1, 1, "mesh_uvf");
+            return 1;
+        } catch (const std::exception& e) {
+            ctx.set_error(std::string("Mesh processing error: ") + e.what());
             return 0;
         }
+    }
 
-        bool ok = process_directory_structure(input_dir, uvf_dir);
-        if(!ok){
-            set_error("Directory UVF generation failed");
+    int run_generate_mesh_buffer(uvf_context& ctx, const uvf_mesh* mesh, uvf_allocator alloc, void* user_data) {
+        begin_run(ctx);
+        try {
+            ctx.buffers.clear();
+            ctx.buffer_names.clear();
+            UVFMeshView view;
+            if (!make_mesh_view(ctx, mesh, view)) return 0;
+            UVFMemoryOutput out(wrap_allocator(alloc, user_data));
+            if (!::generate_uvf(view, out, ctx.options)) {
+                fail(ctx, "UVF generation failed");
+                return 0;
+            }
+            publish_buffers(ctx, out);
+            ctx.stats.add_counts(0, 0, 1);
+            ctx.stats.set_groups(1);
+            ctx.set_stats(view.vertex_count, view.index_count / 3, 1, 1, "mesh_uvf");
+            return 1;
+        } catch (const std::exception& e) {
+            ctx.set_error(std::string("Mesh processing error: ") + e.what());
             return 0;
         }
+    }
 
-        // Estimate stats (actual values would need parsing all files)
-        set_stats(0, 0, file_count, 2, "directory_multi");
-        return 1;
+    int clamp_int(long long v){
+        return v > INT_MAX ? INT_MAX : static_cast<int>(v);
+    }
+}
 
-    } catch (const std::exception& e) {
-        set_error(std::string("Directory processing error: ") + e.what());
-        return 0;
+// Legacy process-wide state: each call converts with a private context and only
+// publishes its results here, so the lock is never held during a conversion
+namespace {
+    uvf_context g_last;
+    std::mutex g_mutex;
+
+    int publish(const uvf_context& ctx, int result){
+        std::lock_guard<std::mutex> lk(g_mutex);
+        if (result) {
+            g_last.point_count = ctx.point_count;
+            g_last.triangle_count = ctx.triangle_count;
+            g_last.file_count = ctx.file_count;
+            g_last.group_count = ctx.group_count;
+            g_last.operation_type = ctx.operation_type;
+        } else {
+            g_last.last_error = ctx.last_error;
+        }
+        return result;
     }
 }
 
+extern "C" {
+
+// ====== Basic Functions ======
+
+// Basic existence check
+int parse_vtp(const char* vtp_path) {
+    uvf_context ctx;
+    return publish(ctx, run_parse_check(ctx, vtp_path));
+}
+
+int generate_uvf(const char* vtp_path, const char* uvf_dir) {
+    uvf_context ctx;
+    return publish(ctx, run_generate(ctx, vtp_path, uvf_dir));
+}
+
+// ====== Enhanced Functions ======
+
+int generate_uvf_structured(const char* vtp_path, const char* uvf_dir) {
+    uvf_context ctx;
+    return publish(ctx, run_generate_structured(ctx, vtp_path, uvf_dir));
+}
+
+int generate_uvf_directory(const char* input_dir, const char* uvf_dir) {
+    uvf_context ctx;
+    return publish(ctx, run_generate_directory(ctx, input_dir, uvf_dir));
+}
+
 // ====== Status and Information Functions ======
 
-// Extended API: return last error (pointer valid until next call)
+// Extended API: return last error. The string is copied out under the lock into
+// a per-thread buffer, so another thread publishing cannot free it; the pointer
+// stays valid until this thread's next call.
 const char* uvf_get_last_error(){
+    static thread_local std::string copy;
     std::lock_guard<std::mutex> lk(g_mutex);
-    return g_last_error.c_str();
+    copy = g_last.last_error;
+    return copy.c_str();
 }
 
 int uvf_get_last_point_count(){
     std::lock_guard<std::mutex> lk(g_mutex);
-    return g_last_point_count;
+    return clamp_int(g_last.point_count);
 }
 
 int uvf_get_last_triangle_count(){
     std::lock_guard<std::mutex> lk(g_mutex);
-    return g_last_triangle_count;
+    return clamp_int(g_last.triangle_count);
 }
 
 int uvf_get_last_file_count(){
     std::lock_guard<std::mutex> lk(g_mutex);
-    return g_last_file_count;
+    return g_last.file_count;
 }
 
 int uvf_get_last_group_count(){
     std::lock_guard<std::mutex> lk(g_mutex);
-    return g_last_group_count;
+    return g_last.group_count;
 }
 
+// Copied per thread, as uvf_get_last_error
 const char* uvf_get_last_operation_type(){
+    static thread_local std::string copy;
     std::lock_guard<std::mutex> lk(g_mutex);
-    return g_last_operation_type.c_str();
+    copy = g_last.operation_type;
+    return copy.c_str();
+}
+
+// ====== Context API ======
+
+uvf_context* uvf_context_create() {
+    try {
+        return new uvf_context();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void uvf_context_destroy(uvf_context* ctx) {
+    delete ctx;
+}
+
+int uvf_context_set_option(uvf_context* ctx, const char* key, const char* value) {
+    if (!ctx) return 0;
+    if (!key || !value || !set_uvf_option(ctx->options, key, value)) {
+        ctx->set_error(std::string("Invalid option: ") + (key ? key : "(null)"));
+        return 0;
+    }
+    return 1;
+}
+
+void uvf_context_reset_options(uvf_context* ctx) {
+    if (ctx) ctx->options = UVFOptions(); // hooks are reinstalled by the next run
+}
+
+int uvf_context_parse(uvf_context* ctx, const char* vtp_path) {
+    return ctx ? end_run(*ctx, run_parse_check(*ctx, vtp_path)) : 0;
+}
+
+int uvf_context_generate(uvf_context* ctx, const char* vtp_path, const char* uvf_dir) {
+    return ctx ? end_run(*ctx, run_generate(*ctx, vtp_path, uvf_dir)) : 0;
+}
+
+int uvf_context_generate_structured(uvf_context* ctx, const char* vtp_path, const char* uvf_dir) {
+    return ctx ? end_run(*ctx, run_generate_structured(*ctx, vtp_path, uvf_dir)) : 0;
+}
+
+int uvf_context_generate_directory(uvf_context* ctx, const char* input_dir, const char* uvf_dir) {
+    return ctx ? end_run(*ctx, run_generate_directory(*ctx, input_dir, uvf_dir)) : 0;
+}
+
+const char* uvf_context_get_last_error(const uvf_context* ctx) {
+    return ctx ? ctx->last_error.c_str() : "";
+}
+
+long long uvf_context_get_point_count(const uvf_context* ctx) {
+    return ctx ? ctx->point_count : 0;
+}
+
+long long uvf_context_get_triangle_count(const uvf_context* ctx) {
+    return ctx ? ctx->triangle_count : 0;
+}
+
+int uvf_context_get_file_count(const uvf_context* ctx) {
+    return ctx ? ctx->file_count : 0;
+}
+
+int uvf_context_get_group_count(const uvf_context* ctx) {
+    return ctx ? ctx->group_count : 0;
+}
+
+const char* uvf_context_get_operation_type(const uvf_context* ctx) {
+    return ctx ? ctx->operation_type.c_str() : "";
+}
+
+// ====== Progress and Cancellation ======
+
+void uvf_context_set_progress_callback(uvf_context* ctx, uvf_progress_fn fn, void* user_data) {
+    if (!ctx) return;
+    ctx->progress_fn = fn;
+    ctx->progress_user = user_data;
+}
+
+void uvf_context_cancel(uvf_context* ctx) {
+    if (ctx) ctx->cancel = true;
+}
+
+// ====== Statistics ======
+
+int uvf_context_set_trace_file(uvf_context* ctx, const char* path) {
+    if (!ctx) return 0;
+    ctx->trace_path = path ? path : "";
+    return 1;
+}
+
+int uvf_context_get_stats(const uvf_context* ctx, uvf_stats* out) {
+    if (!ctx || !out) return 0;
+    out->point_count = ctx->stats.points();
+    out->triangle_count = ctx->stats.triangles();
+    out->file_count = ctx->stats.files();
+    out->group_count = ctx->stats.groups();
+    out->bytes_read = ctx->stats.bytes_read();
+    out->bytes_written = ctx->stats.bytes_written();
+    out->peak_rss_bytes = ctx->stats.peak_rss_bytes();
+    out->total_seconds = ctx->stats.total_seconds();
+    out->stage_count = static_cast<int>(ctx->stages.size());
+    return 1;
+}
+
+int uvf_context_get_stage_stats(const uvf_context* ctx, int index, uvf_stage_stats* out) {
+    if (!ctx || !out || index < 0 || index >= static_cast<int>(ctx->stages.size())) return 0;
+    const UVFStageStats& st = ctx->stages[index];
+    out->name = st.name.c_str();
+    out->seconds = st.seconds;
+    out->bytes = st.bytes;
+    out->items = st.items;
+    out->calls = st.calls;
+    return 1;
+}
+
+const char* uvf_context_get_stats_json(const uvf_context* ctx) {
+    return ctx ? ctx->stats_json.c_str() : "";
+}
+
+// ====== In-Memory Conversion ======
+
+int uvf_context_generate_buffer(uvf_context* ctx, const void* data, size_t size, const char* format,
+                                uvf_allocator alloc, void* user_data) {
+    return ctx ? end_run(*ctx, run_generate_buffer(*ctx, data, size, format, alloc, user_data)) : 0;
+}
+
+int uvf_context_get_buffer_count(const uvf_context* ctx) {
+    return ctx ? static_cast<int>(ctx->buffers.size()) : 0;
+}
+
+const uvf_buffer* uvf_context_get_buffer(const uvf_context* ctx, int index) {
+    if (!ctx || index < 0 || index >= static_cast<int>(ctx->buffers.size())) return nullptr;
+    return &ctx->buffers[index];
+}
+
+void uvf_free(void* ptr) {
+    std::free(ptr);
+}
+
+// ====== Raw Array Ingestion ======
+
+int uvf_context_generate_mesh(uvf_context* ctx, const uvf_mesh* mesh, const char* uvf_dir) {
+    return ctx ? end_run(*ctx, run_generate_mesh(*ctx, mesh, uvf_dir)) : 0;
+}
+
+int uvf_context_generate_mesh_buffer(uvf_context* ctx, const uvf_mesh* mesh,
+                                     uvf_allocator alloc, void* user_data) {
+    return ctx ? end_run(*ctx, run_generate_mesh_buffer(*ctx, mesh, alloc, user_data)) : 0;
 }
 
 // ====== Utility Functions ======
@@ -169,17 +586,9 @@ int uvf_is_directory(const char* path) {
 // Count VTK files in a directory
 int uvf_count_vtk_files(const char* dir_path) {
     try {
-        int count = 0;
-    for (const auto& entry : std::filesystem::directory_iterator(dir_path)) {
-            if (entry.is_regular_file()) {
-                std::string ext = entry.path().extension().string();
-                std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-                if (ext == ".vtk" || ext == ".vtp" || ext == ".stl") {
-                    count++;
-                }
-            }
-        }
-        return count;
+        std::vector<DiscoveredFile> files;
+        if (!dir_path || !discover_input_files(dir_path, UVFOptions(), files)) return -1;
+        return static_cast<int>(files.size());
     } catch (...) {
         return -1;
     }
@@ -187,6 +596,6 @@ int uvf_count_vtk_files(const char* dir_path) {
 
 // Get API version
 const char* uvf_get_version() {
-    return "0.1.4";
+    return "0.2.0";
 }
 }
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -44,40 +47,363 @@ int generate_uvf_directory(const char* input_dir, const char* uvf_dir);
 
 /**
  * Get the error message from the last operation
- * @return Error string (valid until next API call)
+ * @return Error string (valid until the calling thread's next call of this function)
  */
 const char* uvf_get_last_error();
 
 /**
  * Get the point count from the last operation
+ * Deprecated: clamped to INT_MAX; use uvf_context_get_stats
  * @return Number of points processed
  */
 int uvf_get_last_point_count();
 
 /**
  * Get the triangle count from the last operation
+ * Deprecated: clamped to INT_MAX; use uvf_context_get_stats
  * @return Number of triangles processed
  */
 int uvf_get_last_triangle_count();
 
 /**
  * Get the file count from the last operation
+ * Deprecated: use uvf_context_get_stats
  * @return Number of files processed
  */
 int uvf_get_last_file_count();
 
 /**
  * Get the group count from the last operation
+ * Deprecated: use uvf_context_get_stats
  * @return Number of geometry groups created
  */
 int uvf_get_last_group_count();
 
 /**
  * Get the operation type of the last call
- * @return Operation type string (basic_uvf, structured_uvf, directory_multi, etc.)
+ * @return Operation type string (basic_uvf, structured_uvf, directory_multi, etc.;
+ *         valid until the calling thread's next call of this function)
  */
 const char* uvf_get_last_operation_type();
 
+// ====== Context API ======
+// A context carries its own options, error and statistics, so independent
+// conversions may run concurrently on different threads, one context each.
+// The functions above behave as before and do not affect any context.
+
+typedef struct uvf_context uvf_context;
+
+/**
+ * Create a conversion context with default options
+ * @return New context, or NULL on allocation failure
+ */
+uvf_context* uvf_context_create();
+
+/**
+ * Destroy a context created by uvf_context_create (NULL is ignored)
+ * @param ctx Context to destroy
+ */
+void uvf_context_destroy(uvf_context* ctx);
+
+/**
+ * Set a conversion option on a context
+ * Keys (see uvf_options.h for their meaning):
+ *   output:     content_hash_names, binary_manifest, container, elide_sections
+ *   sections:   compression (none|deflate), compression_block_size, mesh_codecs,
+ *               normals (none|float32|oct16), bvh, feature_edges, feature_angle,
+ *               vertex_layout (separate|interleaved|both), interleaved_attribute,
+ *               face_ids, reorder (none|morton)
+ *   directory:  incremental, recursive, threads, include_glob, exclude_glob
+ *   time series: time_encoding (none|delta|xor), time_keyframe_interval
+ * interleaved_attribute, include_glob and exclude_glob add one entry per call.
+ * @param ctx Context
+ * @param key Option name
+ * @param value Option value as text ("1"/"0", "true"/"false", numbers, patterns)
+ * @return 1 if applied, 0 for unknown keys or invalid values
+ */
+int uvf_context_set_option(uvf_context* ctx, const char* key, const char* value);
+
+/**
+ * Restore all options of a context to their defaults
+ * @param ctx Context
+ */
+void uvf_context_reset_options(uvf_context* ctx);
+
+/**
+ * Parse a VTP file and check if it's valid, using a context
+ * @param ctx Context receiving error and statistics
+ * @param vtp_path Path to the VTP file
+ * @return 1 if successful, 0 if failed
+ */
+int uvf_context_parse(uvf_context* ctx, const char* vtp_path);
+
+/**
+ * Generate UVF from a single VTP file (basic mode), using a context
+ * @param ctx Context supplying options and receiving error and statistics
+ * @param vtp_path Path to input VTP file
+ * @param uvf_dir Path to output UVF directory
+ * @return 1 if successful, 0 if failed
+ */
+int uvf_context_generate(uvf_context* ctx, const char* vtp_path, const char* uvf_dir);
+
+/**
+ * Generate UVF using structured parsing, using a context
+ * @param ctx Context receiving error and statistics
+ * @param vtp_path Path to input VTP file
+ * @param uvf_dir Path to output UVF directory
+ * @return 1 if successful, 0 if failed
+ */
+int uvf_context_generate_structured(uvf_context* ctx, const char* vtp_path, const char* uvf_dir);
+
+/**
+ * Generate UVF from a directory with multiple VTK files, using a context
+ * @param ctx Context supplying options and receiving error and statistics
+ * @param input_dir Path to directory containing VTK files
+ * @param uvf_dir Path to output UVF directory
+ * @return 1 if successful, 0 if failed
+ */
+int uvf_context_generate_directory(uvf_context* ctx, const char* input_dir, const char* uvf_dir);
+
+/**
+ * Get the error message from the last failed operation on a context
+ * @return Error string (valid until the next call on the same context)
+ */
+const char* uvf_context_get_last_error(const uvf_context* ctx);
+
+/**
+ * Get the point count from the last operation on a context
+ * @return Number of points processed
+ */
+long long uvf_context_get_point_count(const uvf_context* ctx);
+
+/**
+ * Get the triangle count from the last operation on a context
+ * @return Number of triangles processed
+ */
+long long uvf_context_get_triangle_count(const uvf_context* ctx);
+
+/**
+ * Get the file count from the last operation on a context
+ * @return Number of files processed
+ */
+int uvf_context_get_file_count(const uvf_context* ctx);
+
+/**
+ * Get the group count from the last operation on a context
+ * @return Number of geometry groups created
+ */
+int uvf_context_get_group_count(const uvf_context* ctx);
+
+/**
+ * Get the operation type of the last call on a context
+ * @return Operation type string (valid until the next call on the same context)
+ */
+const char* uvf_context_get_operation_type(const uvf_context* ctx);
+
+// ====== Progress and Cancellation ======
+
+/**
+ * Progress snapshot; totals are 0 when unknown
+ */
+typedef struct uvf_progress {
+    const char* stage;      /* parse, extract, write, manifest, convert (directory mode) */
+    uint64_t bytes_done;
+    uint64_t bytes_total;
+    uint64_t items_done;    /* cells extracted, or files converted in directory mode */
+    uint64_t items_total;
+} uvf_progress;
+
+/**
+ * Progress callback; never called concurrently, but possibly from worker threads
+ */
+typedef void (*uvf_progress_fn)(const uvf_progress* progress, void* user_data);
+
+/**
+ * Register a progress callback for conversions run on a context
+ * @param ctx Context
+ * @param fn Callback, or NULL to remove it
+ * @param user_data Passed through to fn
+ */
+void uvf_context_set_progress_callback(uvf_context* ctx, uvf_progress_fn fn, void* user_data);
+
+/**
+ * Cancel the conversion running on a context. Safe to call from any thread
+ * (including the progress callback). The conversion stops at its next
+ * checkpoint, removes its partial outputs and fails with error "Cancelled".
+ * Has no effect on conversions started afterwards.
+ * @param ctx Context
+ */
+void uvf_context_cancel(uvf_context* ctx);
+
+// ====== Statistics ======
+
+/**
+ * Totals of the last operation on a context
+ */
+typedef struct uvf_stats {
+    uint64_t point_count;       /* points written (all files in directory mode) */
+    uint64_t triangle_count;    /* triangles written */
+    uint64_t file_count;        /* files converted or reused from the cache */
+    uint64_t group_count;       /* geometry groups in the manifest */
+    uint64_t bytes_read;        /* input bytes parsed */
+    uint64_t bytes_written;     /* bin and manifest bytes written */
+    uint64_t peak_rss_bytes;    /* process peak resident set size, 0 if unsupported */
+    double total_seconds;       /* wall-clock time of the operation */
+    int stage_count;            /* entries available from uvf_context_get_stage_stats */
+} uvf_stats;
+
+/**
+ * Cost of one conversion stage. In directory mode seconds is summed over workers.
+ */
+typedef struct uvf_stage_stats {
+    const char* name;           /* parse, extract, triangulate, segment, write, manifest */
+    double seconds;
+    uint64_t bytes;             /* input bytes for parse, output bytes for write/manifest */
+    uint64_t items;             /* files, points, triangles or face segments */
+    uint64_t calls;             /* times the stage ran */
+} uvf_stage_stats;
+
+/**
+ * Get the totals of the last operation on a context (successful or not)
+ * @param ctx Context
+ * @param out Receives the totals
+ * @return 1 if successful, 0 if ctx or out is NULL
+ */
+int uvf_context_get_stats(const uvf_context* ctx, uvf_stats* out);
+
+/**
+ * Get one stage of the last operation on a context, in the order stages first ran
+ * @param ctx Context
+ * @param index Stage index, below uvf_stats.stage_count
+ * @param out Receives the stage (name valid until the next call on the same context)
+ * @return 1 if successful, 0 if out of range
+ */
+int uvf_context_get_stage_stats(const uvf_context* ctx, int index, uvf_stage_stats* out);
+
+/**
+ * Get the statistics of the last operation on a context as JSON, in the same
+ * form as `uvf_cli --stats=json`
+ * @return JSON object (valid until the next call on the same context)
+ */
+const char* uvf_context_get_stats_json(const uvf_context* ctx);
+
+/**
+ * Trace later runs on a context: each stage (and each file in directory mode)
+ * becomes a span with its thread id, written as Chrome trace-event JSON to path
+ * when the run ends (viewable in Perfetto). Tracing costs nothing while off.
+ * @param ctx Context
+ * @param path Output file, replaced after every run; NULL or "" turns tracing off
+ * @return 1 if successful, 0 if ctx is NULL
+ */
+int uvf_context_set_trace_file(uvf_context* ctx, const char* path);
+
+// ====== In-Memory Conversion ======
+
+/**
+ * Allocator for output blocks, with realloc conventions:
+ * alloc(user_data, NULL, size) allocates, alloc(user_data, ptr, 0) frees
+ */
+typedef void* (*uvf_allocator)(void* user_data, void* ptr, size_t size);
+
+/**
+ * One output entry of an in-memory conversion
+ */
+typedef struct uvf_buffer {
+    const char* name;   /* "manifest.json" or the bin file name referenced by it */
+    void* data;         /* owned by the caller, from the allocator given to the call */
+    size_t size;        /* bytes */
+} uvf_buffer;
+
+/**
+ * Convert an in-memory dataset without touching the filesystem. Bin data is
+ * written straight into blocks obtained from alloc; on success every block
+ * belongs to the caller, on failure none are left allocated.
+ * @param ctx Context supplying options and receiving results
+ * @param data Input bytes
+ * @param size Number of input bytes
+ * @param format Input format: "vtp", "vtk" or "stl"
+ * @param alloc Allocator for output blocks, or NULL for malloc (free with uvf_free)
+ * @param user_data Passed through to alloc
+ * @return 1 if successful, 0 if failed
+ */
+int uvf_context_generate_buffer(uvf_context* ctx, const void* data, size_t size, const char* format,
+                                uvf_allocator alloc, void* user_data);
+
+/**
+ * Get the number of output blocks from the last in-memory conversion on a context
+ * @return Number of blocks
+ */
+int uvf_context_get_buffer_count(const uvf_context* ctx);
+
+/**
+ * Get an output block from the last in-memory conversion on a context
+ * @param index Block index (the manifest comes last)
+ * @return Block descriptor (valid until the next call on the same context), NULL if out of range
+ */
+const uvf_buffer* uvf_context_get_buffer(const uvf_context* ctx, int index);
+
+/**
+ * Free a block produced with the default allocator
+ * @param ptr Block data (NULL is ignored)
+ */
+void uvf_free(void* ptr);
+
+// ====== Raw Array Ingestion ======
+
+/**
+ * Named per-vertex float array
+ */
+typedef struct uvf_attribute {
+    const char* name;
+    const float* data;
+    size_t count;       /* number of floats (vertex_count * components) */
+    int components;
+} uvf_attribute;
+
+/**
+ * Face segment: a half-open range of the index array
+ */
+typedef struct uvf_face_range {
+    const char* id;
+    size_t start_index;
+    size_t end_index;
+} uvf_face_range;
+
+/**
+ * Mesh arrays owned by the caller; they are read in place, never copied
+ */
+typedef struct uvf_mesh {
+    const float* positions;         /* xyz per vertex */
+    size_t vertex_count;
+    const uint32_t* indices;        /* triangles; line segments as (a,b,b) */
+    size_t index_count;
+    const uvf_attribute* attributes;
+    int attribute_count;
+    const uvf_face_range* faces;    /* NULL: one face covering all indices */
+    int face_count;
+    const char* geom_kind;          /* surface, slice, isosurface, streamline; NULL to classify */
+} uvf_mesh;
+
+/**
+ * Generate UVF from raw arrays without VTK
+ * @param ctx Context supplying options and receiving error and statistics
+ * @param mesh Mesh arrays (validated: index range, attribute sizes, face ranges)
+ * @param uvf_dir Path to output UVF directory
+ * @return 1 if successful, 0 if failed
+ */
+int uvf_context_generate_mesh(uvf_context* ctx, const uvf_mesh* mesh, const char* uvf_dir);
+
+/**
+ * Generate UVF from raw arrays into memory blocks, as uvf_context_generate_buffer
+ * @param ctx Context supplying options and receiving results
+ * @param mesh Mesh arrays
+ * @param alloc Allocator for output blocks, or NULL for malloc (free with uvf_free)
+ * @param user_data Passed through to alloc
+ * @return 1 if successful, 0 if failed
+ */
+int uvf_context_generate_mesh_buffer(uvf_context* ctx, const uvf_mesh* mesh,
+                                     uvf_allocator alloc, void* user_data);
+
 // ====== Utility Functions ======
 
 /**
@@ -88,7 +414,7 @@ const char* uvf_get_last_operation_type();
 int uvf_is_directory(const char* path);
 
 /**
- * Count VTK files in a directory
+ * Count VTK/VTP/STL files at the top level of a directory, as converted by directory mode
  * @param dir_path Path to directory
  * @return Number of VTK files, -1 if error
  */
@@ -0,0 +1,233 @@
+#include "uvf_container.h"
+#include "uvf_options.h"
+#include "conversion_stats.h"
+#include "file_utils.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define UVF_HAVE_MMAP 1
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    uint64_t align_up(uint64_t v, uint64_t a) { return (v + a - 1) / a * a; }
+
+    // Buffer paths referenced by a manifest ("path":"..."), in order, without
+    // a leading '/'. Covers every generator, time-series steps included.
+    std::vector<std::string> manifest_paths(const std::string& json) {
+        std::vector<std::string> paths;
+        std::set<std::string> seen;
+        const std::string key = "\"path\":\"";
+        for (size_t pos = json.find(key); pos != std::string::npos; pos = json.find(key, pos)) {
+            pos += key.size();
+            std::string value;
+            while (pos < json.size() && json[pos] != '"') {
+                if (json[pos] == '\\' && pos + 1 < json.size()) ++pos;
+                value += json[pos++];
+            }
+            if (!value.empty() && value[0] == '/') value.erase(0, 1);
+            if (!value.empty() && seen.insert(value).second) paths.push_back(value);
+        }
+        return paths;
+    }
+
+    bool copy_into(std::ofstream& ofs, const std::string& path, uint64_t size) {
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs) return false;
+        std::vector<char> buf(1 << 20);
+        uint64_t left = size;
+        while (left > 0) {
+            size_t n = static_cast<size_t>(std::min<uint64_t>(left, buf.size()));
+            if (!ifs.read(buf.data(), n)) return false;
+            ofs.write(buf.data(), n);
+            left -= n;
+        }
+        return static_cast<bool>(ofs);
+    }
+}
+
+bool pack_uvf_directory(const std::string& uvf_dir, const UVFOptions& options) {
+    UVFStageTimer timer(options, "pack");
+    const std::string manifest_path = uvf_dir + "/manifest.json";
+    std::ifstream mifs(manifest_path, std::ios::binary);
+    if (!mifs) {
+        std::cerr << "Cannot pack " << uvf_dir << ": manifest.json missing" << std::endl;
+        return false;
+    }
+    std::string manifest((std::istreambuf_iterator<char>(mifs)), std::istreambuf_iterator<char>());
+    mifs.close();
+
+    struct Source { std::string name; std::string path; uint32_t kind; };
+    std::vector<Source> sources;
+    sources.push_back({"manifest.json", manifest_path, UVF_CONTAINER_MANIFEST_JSON});
+    if (fs::exists(uvf_dir + "/manifest.uvfm")) {
+        sources.push_back({"manifest.uvfm", uvf_dir + "/manifest.uvfm", UVF_CONTAINER_MANIFEST_BINARY});
+    }
+    for (const auto& p : manifest_paths(manifest)) sources.push_back({p, uvf_dir + "/" + p, UVF_CONTAINER_BIN});
+
+    // Lay out the index, then the manifests packed behind it, then aligned bins
+    std::vector<UVFContainerEntry> entries(sources.size());
+    std::string names;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        std::error_code ec;
+        uint64_t size = fs::file_size(sources[i].path, ec);
+        if (ec) {
+            std::cerr << "Cannot pack " << uvf_dir << ": missing entry " << sources[i].name << std::endl;
+            return false;
+        }
+        entries[i] = UVFContainerEntry{0, size, 0, static_cast<uint32_t>(sources[i].name.size()), sources[i].kind, 0};
+        entries[i].name_offset = static_cast<uint32_t>(entries.size() * sizeof(UVFContainerEntry) + names.size());
+        names += sources[i].name;
+    }
+    UVFContainerHeader header{};
+    header.magic = UVF_CONTAINER_MAGIC;
+    header.version = UVF_CONTAINER_VERSION;
+    header.header_size = sizeof(UVFContainerHeader);
+    header.entry_count = static_cast<uint32_t>(entries.size());
+    header.index_offset = sizeof(UVFContainerHeader);
+    header.index_size = entries.size() * sizeof(UVFContainerEntry) + names.size();
+    header.alignment = UVF_CONTAINER_ALIGNMENT;
+    uint64_t offset = align_up(header.index_offset + header.index_size, 8);
+    for (auto& e : entries) {
+        offset = align_up(offset, e.kind == UVF_CONTAINER_BIN ? UVF_CONTAINER_ALIGNMENT : 8);
+        e.offset = offset;
+        offset += e.size;
+    }
+    header.manifest_offset = entries[0].offset;
+    header.manifest_size = entries[0].size;
+    header.file_size = offset;
+
+    const std::string container_path = uvf_dir + "/" + UVF_CONTAINER_NAME;
+    const std::string tmp_path = container_path + ".tmp";
+    {
+        std::ofstream ofs(tmp_path, std::ios::binary);
+        if (!ofs) return false;
+        ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        ofs.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(UVFContainerEntry));
+        ofs << names;
+        uint64_t pos = header.index_offset + header.index_size;
+        bool ok = static_cast<bool>(ofs);
+        for (size_t i = 0; i < entries.size() && ok; ++i) {
+            // Zero padding up to the entry's aligned start
+            static const std::vector<char> zeros(UVF_CONTAINER_ALIGNMENT, 0);
+            ofs.write(zeros.data(), static_cast<std::streamsize>(entries[i].offset - pos));
+            ok = copy_into(ofs, sources[i].path, entries[i].size);
+            pos = entries[i].offset + entries[i].size;
+        }
+        ofs.close();
+        if (!ok || !ofs) {
+            std::cerr << "Failed to write container: " << container_path << std::endl;
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+    }
+    if (!commit_file(tmp_path, container_path)) return false;
+    timer.add_bytes(header.file_size);
+    timer.add_items(entries.size());
+
+    if (!options.incremental) {
+        for (const auto& s : sources) std::remove(s.path.c_str());
+    }
+    return true;
+}
+
+UVFContainerReader::~UVFContainerReader() { close(); }
+
+void UVFContainerReader::close() {
+#ifdef UVF_HAVE_MMAP
+    if (mapped_) munmap(const_cast<char*>(base_), size_);
+#endif
+    base_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    fallback_.clear();
+    entries_.clear();
+}
+
+bool UVFContainerReader::open(const std::string& path, std::string& error) {
+    close();
+#ifdef UVF_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                base_ = static_cast<const char*>(p);
+                size_ = static_cast<size_t>(st.st_size);
+                mapped_ = true;
+            }
+        }
+        ::close(fd);
+    }
+#endif
+    if (!base_) {
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs) {
+            error = "cannot open " + path;
+            return false;
+        }
+        fallback_.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+        base_ = fallback_.data();
+        size_ = fallback_.size();
+    }
+
+    UVFContainerHeader header;
+    if (size_ < sizeof(header)) {
+        error = "not a UVF container";
+        close();
+        return false;
+    }
+    std::memcpy(&header, base_, sizeof(header));
+    if (header.magic != UVF_CONTAINER_MAGIC) {
+        error = "not a UVF container";
+        close();
+        return false;
+    }
+    if (header.version != UVF_CONTAINER_VERSION) {
+        error = "unsupported container version " + std::to_string(header.version);
+        close();
+        return false;
+    }
+    if (header.file_size != size_ || header.index_offset + header.index_size > size_ ||
+        static_cast<uint64_t>(header.entry_count) * sizeof(UVFContainerEntry) > header.index_size) {
+        error = "container is truncated or corrupt";
+        close();
+        return false;
+    }
+    const char* index = base_ + header.index_offset;
+    for (uint32_t i = 0; i < header.entry_count; ++i) {
+        UVFContainerEntry rec;
+        std::memcpy(&rec, index + i * sizeof(UVFContainerEntry), sizeof(rec));
+        if (rec.offset + rec.size > size_ || static_cast<uint64_t>(rec.name_offset) + rec.name_length > header.index_size) {
+            error = "container entry " + std::to_string(i) + " out of bounds";
+            close();
+            return false;
+        }
+        Entry e;
+        e.name.assign(index + rec.name_offset, rec.name_length);
+        e.offset = rec.offset;
+        e.size = rec.size;
+        e.kind = rec.kind;
+        entries_.push_back(std::move(e));
+    }
+    return true;
+}
+
+const UVFContainerReader::Entry* UVFContainerReader::find(const std::string& name) const {
+    std::string key = !name.empty() && name[0] == '/' ? name.substr(1) : name;
+    for (const auto& e : entries_) {
+        if (e.name == key) return &e;
+    }
+    return nullptr;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct UVFOptions;
+
+// Single-file UVF container (scene.uvfc): every entry of a conversion in one
+// file, for object stores and HTTP/1.1 clients that choke on thousands of
+// small files. Layout, all integers little-endian:
+//
+//   header    UVFContainerHeader (64 bytes)
+//   index     entry_count UVFContainerEntry records, then their names
+//             (UTF-8, not terminated; offsets relative to the index start)
+//   manifest  manifest.json, then manifest.uvfm when present
+//   bins      one per bin file, each starting on a 4 KiB boundary
+//
+// Entry names are the manifest's buffer paths without a leading '/'. Section
+// offsets inside a bin stay relative to the bin, so a section lives at
+// entry.offset + section.offset. Native readers mmap the file; browsers fetch
+// the header and index with one range request, then each bin by range.
+constexpr uint32_t UVF_CONTAINER_MAGIC = 0x43465655; // "UVFC"
+constexpr uint32_t UVF_CONTAINER_VERSION = 1;
+constexpr uint32_t UVF_CONTAINER_ALIGNMENT = 4096;
+constexpr const char* UVF_CONTAINER_NAME = "scene.uvfc";
+
+enum UVFContainerEntryKind : uint32_t {
+    UVF_CONTAINER_BIN = 0,
+    UVF_CONTAINER_MANIFEST_JSON = 1,
+    UVF_CONTAINER_MANIFEST_BINARY = 2
+};
+
+struct UVFContainerHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t entry_count;
+    uint64_t index_offset;
+    uint64_t index_size;      // records and names
+    uint64_t manifest_offset; // manifest.json
+    uint64_t manifest_size;
+    uint64_t file_size;
+    uint32_t alignment;
+    uint32_t reserved;
+};
+static_assert(sizeof(UVFContainerHeader) == 64, "container header is 64 bytes");
+
+struct UVFContainerEntry {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t name_offset;
+    uint32_t name_length;
+    uint32_t kind;            // UVFContainerEntryKind
+    uint32_t reserved;
+};
+static_assert(sizeof(UVFContainerEntry) == 32, "container entry is 32 bytes");
+
+// Pack manifest.json, manifest.uvfm and every bin the manifest references
+// into <uvf_dir>/scene.uvfc (replaced atomically). The packed loose files are
+// removed afterwards, except with options.incremental, whose cache reuses them.
+bool pack_uvf_directory(const std::string& uvf_dir, const UVFOptions& options);
+
+// Read-only view of a container, memory-mapped where the platform allows
+class UVFContainerReader {
+public:
+    struct Entry {
+        std::string name;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint32_t kind = UVF_CONTAINER_BIN;
+    };
+
+    UVFContainerReader() = default;
+    ~UVFContainerReader();
+    UVFContainerReader(const UVFContainerReader&) = delete;
+    UVFContainerReader& operator=(const UVFContainerReader&) = delete;
+
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    const std::vector<Entry>& entries() const { return entries_; }
+    // Lookup by manifest path; a leading '/' is ignored
+    const Entry* find(const std::string& name) const;
+    // Entry bytes inside the mapping (valid until close)
+    const char* data(const Entry& entry) const { return base_ + entry.offset; }
+
+private:
+    const char* base_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<char> fallback_; // file contents when mmap is unavailable
+    std::vector<Entry> entries_;
+};
@@ -19,6 +19,35 @@ Module['uvf_get_last_file_count'] = Module.cwrap('uvf_get_last_file_count', 'num
 Module['uvf_get_last_group_count'] = Module.cwrap('uvf_get_last_group_count', 'number', []);
 Module['uvf_get_last_operation_type'] = Module.cwrap('uvf_get_last_operation_type', 'string', []);
 
+// Context Functions (counts are 64-bit and arrive as BigInt)
+Module['uvf_context_create'] = Module.cwrap('uvf_context_create', 'number', []);
+Module['uvf_context_destroy'] = Module.cwrap('uvf_context_destroy', null, ['number']);
+Module['uvf_context_set_option'] = Module.cwrap('uvf_context_set_option', 'number', ['number', 'string', 'string']);
+Module['uvf_context_reset_options'] = Module.cwrap('uvf_context_reset_options', null, ['number']);
+Module['uvf_context_parse'] = Module.cwrap('uvf_context_parse', 'number', ['number', 'string']);
+Module['uvf_context_generate'] = Module.cwrap('uvf_context_generate', 'number', ['number', 'string', 'string']);
+Module['uvf_context_generate_structured'] = Module.cwrap('uvf_context_generate_structured', 'number', ['number', 'string', 'string']);
+Module['uvf_context_generate_directory'] = Module.cwrap('uvf_context_generate_directory', 'number', ['number', 'string', 'string']);
+Module['uvf_context_get_last_error'] = Module.cwrap('uvf_context_get_last_error', 'string', ['number']);
+Module['uvf_context_get_point_count'] = Module.cwrap('uvf_context_get_point_count', 'number', ['number']);
+Module['uvf_context_get_triangle_count'] = Module.cwrap('uvf_context_get_triangle_count', 'number', ['number']);
+Module['uvf_context_get_file_count'] = Module.cwrap('uvf_context_get_file_count', 'number', ['number']);
+Module['uvf_context_get_group_count'] = Module.cwrap('uvf_context_get_group_count', 'number', ['number']);
+Module['uvf_context_get_operation_type'] = Module.cwrap('uvf_context_get_operation_type', 'string', ['number']);
+Module['uvf_context_cancel'] = Module.cwrap('uvf_context_cancel', null, ['number']);
+
+// Statistics
+Module['uvf_context_get_stats_json'] = Module.cwrap('uvf_context_get_stats_json', 'string', ['number']);
+Module['uvf_context_set_trace_file'] = Module.cwrap('uvf_context_set_trace_file', 'number', ['number', 'string']);
+
+// In-Memory Conversion
+Module['uvf_context_generate_buffer'] = Module.cwrap('uvf_context_generate_buffer', 'number', ['number', 'number', 'number', 'string', 'number', 'number']);
+Module['uvf_context_get_buffer_count'] = Module.cwrap('uvf_context_get_buffer_count', 'number', ['number']);
+Module['uvf_context_get_buffer'] = Module.cwrap('uvf_context_get_buffer', 'number', ['number', 'number']);
+Module['uvf_context_generate_mesh'] = Module.cwrap('uvf_context_generate_mesh', 'number', ['number', 'number', 'string']);
+Module['uvf_context_generate_mesh_buffer'] = Module.cwrap('uvf_context_generate_mesh_buffer', 'number', ['number', 'number', 'number', 'number']);
+Module['uvf_free'] = Module.cwrap('uvf_free', null, ['number']);
+
 // Utility Functions
 Module['uvf_is_directory'] = Module.cwrap('uvf_is_directory', 'number', ['string']);
 Module['uvf_count_vtk_files'] = Module.cwrap('uvf_count_vtk_files', 'number', ['string']);
@@ -79,6 +108,300 @@ Module['UVF'] = {
         return result;
     },
     
+    /**
+     * Convert with a private context so options and results are not shared
+     * with other callers
+     * @param {string} input - Input file or directory path
+     * @param {string} output - Output directory path
+     * @param {string} mode - 'basic', 'structured', or 'directory'
+     * @param {Object} options - Option name/value pairs (see uvf_context_set_option)
+     * @returns {Object} Result with success flag and statistics
+     */
+    convertWithOptions: function(input, output, mode = 'directory', options = {}) {
+        let result = {
+            success: false,
+            error: '',
+            stats: {
+                points: 0,
+                triangles: 0,
+                files: 0,
+                groups: 0,
+                operation: ''
+            }
+        };
+
+        const ctx = Module.uvf_context_create();
+        if (!ctx) {
+            result.error = 'Failed to create context';
+            return result;
+        }
+
+        try {
+            for (const [key, value] of Object.entries(options)) {
+                const values = Array.isArray(value) ? value : [value];
+                for (const v of values) {
+                    if (!Module.uvf_context_set_option(ctx, key, String(v))) {
+                        result.error = Module.uvf_context_get_last_error(ctx);
+                        return result;
+                    }
+                }
+            }
+
+            let success = 0;
+            switch(mode) {
+                case 'basic':
+                    success = Module.uvf_context_generate(ctx, input, output);
+                    break;
+                case 'structured':
+                    success = Module.uvf_context_generate_structured(ctx, input, output);
+                    break;
+                case 'directory':
+                    success = Module.uvf_context_generate_directory(ctx, input, output);
+                    break;
+                default:
+                    result.error = 'Invalid mode: ' + mode;
+                    return result;
+            }
+
+            result.success = (success === 1);
+            if (!result.success) {
+                result.error = Module.uvf_context_get_last_error(ctx);
+            }
+
+            result.stats.points = Number(Module.uvf_context_get_point_count(ctx));
+            result.stats.triangles = Number(Module.uvf_context_get_triangle_count(ctx));
+            result.stats.files = Module.uvf_context_get_file_count(ctx);
+            result.stats.groups = Module.uvf_context_get_group_count(ctx);
+            result.stats.operation = Module.uvf_context_get_operation_type(ctx);
+            // Stage timings, byte counters and peak memory of this run
+            result.stats.detail = JSON.parse(Module.uvf_context_get_stats_json(ctx));
+            return result;
+        } finally {
+            Module.uvf_context_destroy(ctx);
+        }
+    },
+
+    /**
+     * Convert an in-memory dataset without going through the virtual filesystem
+     * @param {Uint8Array} bytes - Input file contents
+     * @param {string} format - 'vtp', 'vtk' or 'stl'
+     * @param {Object} options - Option name/value pairs (see uvf_context_set_option)
+     * @returns {Object} Result with success flag, statistics and files (name -> Uint8Array)
+     */
+    convertBuffer: function(bytes, format, options = {}) {
+        let result = {
+            success: false,
+            error: '',
+            files: {},
+            stats: {
+                points: 0,
+                triangles: 0
+            }
+        };
+
+        const ctx = Module.uvf_context_create();
+        if (!ctx) {
+            result.error = 'Failed to create context';
+            return result;
+        }
+        const input = Module._malloc(Math.max(bytes.length, 1));
+        try {
+            for (const [key, value] of Object.entries(options)) {
+                if (!Module.uvf_context_set_option(ctx, key, String(value))) {
+                    result.error = Module.uvf_context_get_last_error(ctx);
+                    return result;
+                }
+            }
+            Module.HEAPU8.set(bytes, input);
+            // Default allocator (malloc); blocks are copied out and freed below
+            if (!Module.uvf_context_generate_buffer(ctx, input, bytes.length, format, 0, 0)) {
+                result.error = Module.uvf_context_get_last_error(ctx);
+                return result;
+            }
+            const count = Module.uvf_context_get_buffer_count(ctx);
+            for (let i = 0; i < count; i++) {
+                // uvf_buffer on wasm32: { const char* name; void* data; size_t size; }
+                const desc = Module.uvf_context_get_buffer(ctx, i) >> 2;
+                const name = Module.UTF8ToString(Module.HEAPU32[desc]);
+                const data = Module.HEAPU32[desc + 1];
+                const size = Module.HEAPU32[desc + 2];
+                result.files[name] = Module.HEAPU8.slice(data, data + size);
+                Module.uvf_free(data);
+            }
+            result.success = true;
+            result.stats.points = Number(Module.uvf_context_get_point_count(ctx));
+            result.stats.triangles = Number(Module.uvf_context_get_triangle_count(ctx));
+            return result;
+        } finally {
+            Module._free(input);
+            Module.uvf_context_destroy(ctx);
+        }
+    },
+
+    /**
+     * Open a manifest.uvfm (written with the binary_manifest option) without
+     * copying: every table is a typed-array view into the given buffer.
+     * Record layouts are documented in binary_manifest.h; 64-bit values are
+     * lo/hi word pairs and 0xFFFFFFFF marks an absent string or value.
+     * @param {ArrayBuffer} buffer - File contents (byte offset 0)
+     * @returns {Object} Tables as Uint32Array views (float32 fields through the *F32 twins) and string(id)
+     */
+    readBinaryManifest: function(buffer) {
+        const header = new Uint32Array(buffer, 0, 24);
+        if (header[0] !== 0x4D465655) throw new Error('Not a binary UVF manifest');
+        if (header[1] !== 6) throw new Error('Unsupported binary manifest version ' + header[1]);
+        const table = (t, words, Type = Uint32Array) => new Type(buffer, header[4 + t * 2], header[5 + t * 2] * words);
+        const offsets = new Uint32Array(buffer, header[4], header[5] + 1);
+        const data = new Uint8Array(buffer, header[22], header[23]);
+        const decoder = new TextDecoder();
+        return {
+            stringCount: header[5],
+            groups: table(1, 4),
+            solids: table(2, 10),
+            faces: table(3, 8),
+            sections: table(4, 22),
+            refs: table(5, 1),
+            blocks: table(6, 1),
+            edges: table(7, 9),
+            attributes: table(8, 6),
+            facesF32: table(3, 8, Float32Array),
+            sectionsF32: table(4, 22, Float32Array),
+            edgesF32: table(7, 9, Float32Array),
+            attributesF32: table(8, 6, Float32Array),
+            string: (id) => id === 0xFFFFFFFF ? null : decoder.decode(data.subarray(offsets[id], offsets[id + 1]))
+        };
+    },
+
+    /**
+     * Inflate a section written with the compression option. Blocks are
+     * independent zlib streams, decoded concurrently; pass firstBlock/blockCount
+     * to decode only part of the section (block i covers raw bytes
+     * [i * blockSize, (i + 1) * blockSize)).
+     * @param {Uint8Array} stored - The section's stored bytes (bin slice at offset, length)
+     * @param {Object} section - Its manifest entry (compression, blockSize, blocks, rawLength)
+     * @returns {Promise<Uint8Array>} The raw bytes of the requested blocks
+     */
+    inflateSection: async function(stored, section, firstBlock = 0, blockCount = undefined) {
+        if (!section.compression) return stored;
+        if (section.compression !== 'deflate') throw new Error('Unsupported compression ' + section.compression);
+        const count = blockCount === undefined ? section.blocks.length - firstBlock : blockCount;
+        let start = 0;
+        for (let i = 0; i < firstBlock; i++) start += section.blocks[i];
+        const parts = [];
+        for (let i = firstBlock; i < firstBlock + count; i++) {
+            const block = stored.subarray(start, start + section.blocks[i]);
+            start += section.blocks[i];
+            const inflated = new Blob([block]).stream().pipeThrough(new DecompressionStream('deflate'));
+            parts.push(new Response(inflated).arrayBuffer());
+        }
+        const buffers = await Promise.all(parts);
+        const out = new Uint8Array(buffers.reduce((n, b) => n + b.byteLength, 0));
+        let at = 0;
+        for (const b of buffers) {
+            out.set(new Uint8Array(b), at);
+            at += b.byteLength;
+        }
+        return out;
+    },
+
+    /**
+     * Decode a section written with the mesh_codecs, normals=oct16 or elide_sections option
+     * (after inflateSection when it is also compressed). Plain loops over typed
+     * arrays, cheap enough for a worker. Encodings are documented in
+     * mesh_codec.h and mesh_normals.h; "constant" sections store no bytes and repeat the
+     * manifest's constant value.
+     * @param {Uint8Array} bytes - Encoded section bytes (empty for constants)
+     * @param {Object} section - Its manifest entry (encoding, decodedLength, dimension, constant)
+     * @returns {Uint32Array|Float32Array} The section's values
+     */
+    decodeSection: function(bytes, section) {
+        if (section.encoding === 'delta-varint') {
+            const out = new Uint32Array(section.decodedLength / 4);
+            let at = 0, prev = 0;
+            for (let i = 0; i < out.length; i++) {
+                let v = 0, scale = 1, b;
+                do {
+                    b = bytes[at++];
+                    v += (b & 0x7F) * scale;
+                    scale *= 128;
+                } while (b & 0x80);
+                prev += (v % 2) ? -(v + 1) / 2 : v / 2;
+                out[i] = prev;
+            }
+            return out;
+        }
+        if (section.encoding === 'byteplane-delta') {
+            const dim = section.dimension;
+            const count = section.decodedLength / 4 / dim;
+            const bits = new Uint32Array(count * dim);
+            for (let c = 0; c < dim; c++) {
+                const plane = c * 4 * count;
+                let prev = 0;
+                for (let i = 0; i < count; i++) {
+                    const d = bytes[plane + i] | bytes[plane + count + i] << 8 |
+                              bytes[plane + 2 * count + i] << 16 | bytes[plane + 3 * count + i] << 24;
+                    prev = (prev + d) >>> 0;
+                    bits[i * dim + c] = prev;
+                }
+            }
+            return new Float32Array(bits.buffer);
+        }
+        if (section.encoding === 'oct16') {
+            const count = section.decodedLength / 12;
+            const oct = new Int16Array(bytes.buffer, bytes.byteOffset, count * 2);
+            const out = new Float32Array(count * 3);
+            for (let i = 0; i < count; i++) {
+                let x = Math.max(-1, oct[i * 2] / 32767), y = Math.max(-1, oct[i * 2 + 1] / 32767);
+                const z = 1 - Math.abs(x) - Math.abs(y);
+                if (z < 0) {
+                    const fx = (1 - Math.abs(y)) * (x >= 0 ? 1 : -1);
+                    y = (1 - Math.abs(x)) * (y >= 0 ? 1 : -1);
+                    x = fx;
+                }
+                const len = Math.hypot(x, y, z);
+                out[i * 3] = x / len;
+                out[i * 3 + 1] = y / len;
+                out[i * 3 + 2] = z / len;
+            }
+            return out;
+        }
+        if (section.encoding === 'constant') {
+            const count = section.decodedLength / 4;
+            const out = section.dType === 'float32' ? new Float32Array(count) : new Uint32Array(count);
+            return out.fill(section.constant);
+        }
+        throw new Error('Unsupported section encoding ' + section.encoding);
+    },
+
+    /**
+     * Parse the header and index of a scene.uvfc container (written with the
+     * container option). Only the first bytes are needed: fetch
+     * 'bytes=0-65535', call this, refetch if indexEnd is larger, then range-fetch
+     * entries by offset/size. Layout is documented in uvf_container.h.
+     * @param {ArrayBuffer} buffer - Start of the container
+     * @returns {Object} { indexEnd, fileSize, entries: {name: {offset, size, kind}} } or null if buffer is too short
+     */
+    readContainerIndex: function(buffer) {
+        if (buffer.byteLength < 64) return null;
+        const view = new DataView(buffer);
+        if (view.getUint32(0, true) !== 0x43465655) throw new Error('Not a UVF container');
+        if (view.getUint32(4, true) !== 1) throw new Error('Unsupported container version ' + view.getUint32(4, true));
+        const u64 = (at) => Number(view.getBigUint64(at, true));
+        const count = view.getUint32(12, true);
+        const indexOffset = u64(16);
+        const indexEnd = indexOffset + u64(24);
+        const result = { indexEnd: indexEnd, fileSize: u64(48), entries: {} };
+        if (buffer.byteLength < indexEnd) return result;
+        const decoder = new TextDecoder();
+        for (let i = 0; i < count; i++) {
+            const at = indexOffset + i * 32;
+            const nameOffset = indexOffset + view.getUint32(at + 16, true);
+            const name = decoder.decode(new Uint8Array(buffer, nameOffset, view.getUint32(at + 20, true)));
+            result.entries[name] = { offset: u64(at), size: u64(at + 8), kind: view.getUint32(at + 24, true) };
+        }
+        return result;
+    },
+
     /**
      * Check if input is a directory
      * @param {string} path - Path to check
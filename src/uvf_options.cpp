@@ -0,0 +1,120 @@
+#include "uvf_options.h"
+#include "section_codec.h"
+#include "mesh_normals.h"
+#include "mesh_reorder.h"
+#include <sstream>
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+// Bump when the section layout produced for identical options changes
+static const int UVF_SECTION_FORMAT_VERSION = 1;
+
+std::string uvf_options_key(const UVFOptions& options) {
+    std::ostringstream oss;
+    oss << "v" << UVF_SECTION_FORMAT_VERSION;
+    // Time-series settings and face_ids do not affect directory-mode sections
+    if (options.compression != "none") oss << ";" << options.compression << "/" << options.compression_block_size;
+    if (options.mesh_codecs) oss << ";mesh-codecs";
+    if (options.reorder != "none") oss << ";reorder=" << options.reorder;
+    if (options.elide_sections) oss << ";elide";
+    if (options.bvh) oss << ";bvh";
+    if (options.feature_edges) oss << ";edges=" << options.feature_angle;
+    if (options.normals != "none") oss << ";normals=" << options.normals;
+    if (options.vertex_layout != "separate") {
+        oss << ";layout=" << options.vertex_layout;
+        for (size_t i = 0; i < options.interleaved_attributes.size(); ++i) {
+            oss << (i ? "," : ":") << options.interleaved_attributes[i];
+        }
+    }
+    return oss.str();
+}
+
+namespace {
+    bool parse_bool(const std::string& value, bool& out) {
+        std::string v = value;
+        std::transform(v.begin(), v.end(), v.begin(), ::tolower);
+        if (v == "1" || v == "true" || v == "on" || v == "yes") { out = true; return true; }
+        if (v == "0" || v == "false" || v == "off" || v == "no") { out = false; return true; }
+        return false;
+    }
+
+    bool parse_int(const std::string& value, int& out) {
+        if (value.empty()) return false;
+        char* end = nullptr;
+        long v = std::strtol(value.c_str(), &end, 10);
+        if (*end != '\0' || v < INT_MIN || v > INT_MAX) return false;
+        out = static_cast<int>(v);
+        return true;
+    }
+
+    // Counts (threads, intervals): 0 keeps its "default" meaning, negatives are rejected
+    bool parse_count(const std::string& value, int& out) {
+        int v = 0;
+        if (!parse_int(value, v) || v < 0) return false;
+        out = v;
+        return true;
+    }
+}
+
+bool set_uvf_option(UVFOptions& options, const std::string& key, const std::string& value) {
+    if (key == "content_hash_names") return parse_bool(value, options.content_hash_names);
+    if (key == "binary_manifest") return parse_bool(value, options.binary_manifest);
+    if (key == "container") return parse_bool(value, options.container);
+    if (key == "incremental") return parse_bool(value, options.incremental);
+    if (key == "recursive") return parse_bool(value, options.recursive);
+    if (key == "threads") return parse_count(value, options.threads);
+    if (key == "include_glob") { options.include_globs.push_back(value); return true; }
+    if (key == "exclude_glob") { options.exclude_globs.push_back(value); return true; }
+    if (key == "mesh_codecs") return parse_bool(value, options.mesh_codecs);
+    if (key == "elide_sections") return parse_bool(value, options.elide_sections);
+    if (key == "bvh") return parse_bool(value, options.bvh);
+    if (key == "feature_edges") return parse_bool(value, options.feature_edges);
+    if (key == "feature_angle") {
+        char* end = nullptr;
+        float angle = std::strtof(value.c_str(), &end);
+        if (value.empty() || *end != '\0' || !(angle >= 0.0f && angle <= 180.0f)) return false;
+        options.feature_angle = angle;
+        return true;
+    }
+    if (key == "vertex_layout") {
+        if (value != "separate" && value != "interleaved" && value != "both") return false;
+        options.vertex_layout = value;
+        return true;
+    }
+    if (key == "interleaved_attribute") {
+        if (value.empty()) return false;
+        options.interleaved_attributes.push_back(value);
+        return true;
+    }
+    if (key == "face_ids") return parse_bool(value, options.face_ids);
+    if (key == "normals") {
+        if (!is_known_normals_mode(value)) return false;
+        options.normals = value;
+        return true;
+    }
+    if (key == "reorder") {
+        if (!is_known_reorder_mode(value)) return false;
+        options.reorder = value;
+        return true;
+    }
+    if (key == "compression") {
+        if (!is_known_compression(value)) return false;
+        options.compression = value;
+        return true;
+    }
+    if (key == "compression_block_size") {
+        int size = 0;
+        if (!parse_int(value, size) || size < static_cast<int>(UVF_MIN_COMPRESSION_BLOCK_SIZE) ||
+            size > static_cast<int>(UVF_MAX_COMPRESSION_BLOCK_SIZE)) return false;
+        options.compression_block_size = static_cast<uint32_t>(size);
+        return true;
+    }
+    if (key == "time_keyframe_interval") return parse_count(value, options.time_keyframe_interval);
+    if (key == "time_encoding") {
+        if (value != "none" && value != "delta" && value != "xor") return false;
+        options.time_encoding = value;
+        return true;
+    }
+    return false;
+}
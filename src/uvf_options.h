@@ -0,0 +1,135 @@
+#pragma once
+#include "section_codec.h"
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+class UVFConversionStats;
+class UVFTraceRecorder;
+
+// Progress snapshot passed to UVFOptions::progress. Totals are 0 when unknown.
+struct UVFProgress {
+    const char* stage = "";     // parse, extract, write, manifest, convert
+    uint64_t bytes_done = 0;
+    uint64_t bytes_total = 0;
+    uint64_t items_done = 0;
+    uint64_t items_total = 0;
+};
+
+// Conversion options shared by the UVF generators.
+// Defaults reproduce the original output layout.
+struct UVFOptions {
+    // Name bin files after a hash of their contents instead of a random token,
+    // so unchanged geometry keeps a stable URL across re-conversions
+    bool content_hash_names = false;
+
+    // Also write manifest.uvfm, a compact binary encoding of manifest.json
+    // (string table plus fixed-size records, see binary_manifest.h)
+    bool binary_manifest = false;
+
+    // Pack the output into one file, <uvf_dir>/scene.uvfc (header, index,
+    // manifest, 4 KiB-aligned bins; see uvf_container.h) instead of loose files
+    bool container = false;
+
+    // Directory mode: reuse sections of inputs unchanged since the previous run
+    // (tracked in <uvf_dir>/.uvf_cache) and only rebuild the manifest
+    bool incremental = false;
+
+    // Directory mode discovery: walk subdirectories (their paths become nested
+    // GeometryGroups; off by default, which scans only the top level as before),
+    // and filter inputs by glob on the relative path
+    bool recursive = false;
+    std::vector<std::string> include_globs;
+    std::vector<std::string> exclude_globs;
+
+    // Worker threads for parallel passes (0 = hardware concurrency)
+    int threads = 0;
+
+    // Bin section compression: "none" (raw) or "deflate". Sections are cut
+    // into compression_block_size byte blocks compressed independently and in
+    // parallel; the manifest lists each block's size (see section_codec.h)
+    std::string compression = "none";
+    uint32_t compression_block_size = UVF_DEFAULT_COMPRESSION_BLOCK_SIZE;
+
+    // Store indices as delta varints and positions as byte planes of
+    // per-vertex deltas (lossless, see mesh_codec.h); pays off together with
+    // compression
+    bool mesh_codecs = false;
+
+    // Reorder vertices along a space-filling curve over the bounding box and
+    // triangles by their remapped indices before any section is built:
+    // "none" or "morton" (see mesh_reorder.h). Not applied to time series,
+    // whose per-step sections share the first step's vertex order
+    std::string reorder = "none";
+
+    // Precompute area-weighted vertex normals per face segment and write them
+    // as a "normal" section: "none", "float32" or "oct16" (2 x int16 per
+    // vertex, see mesh_normals.h). Vertices shared by several faces are split
+    // so each face keeps its own normals; the extra vertices are appended
+    // after the input's
+    std::string normals = "none";
+
+    // Build a bounding volume hierarchy over each SolidGeometry's triangles
+    // (binned SAH, in parallel) and write it as the "bvhNodes" and
+    // "bvhTriangles" sections for ray picking and culling (see mesh_bvh.h)
+    bool bvh = false;
+
+    // Extract boundary, non-manifold and feature edges (dihedral angle above
+    // feature_angle degrees, or between face segments) as line-index
+    // sections referenced by Edge nodes in each SolidGeometry's "edges"
+    // attribution (see mesh_edges.h)
+    bool feature_edges = false;
+    float feature_angle = 30.0f;
+
+    // Vertex buffer layout: "separate" (one section per array), "interleaved"
+    // (one "vertices" section, position then the interleaved attributes, with
+    // their byte offsets and the stride in the manifest) or "both". Interleaved
+    // attributes are interleaved_attributes in order, or when empty "normal"
+    // and then every other float32 attribute by name; names without a plain
+    // float32 per-vertex section (e.g. oct16 normals) stay separate
+    std::string vertex_layout = "separate";
+    std::vector<std::string> interleaved_attributes;
+
+    // Single-file conversion: write a per-triangle "faceId" section holding the
+    // position of each triangle's Face in the SolidGeometry's face list
+    // (uint8, uint16 or uint32 by face count; the type's maximum marks
+    // triangles outside every face), so a picked triangle maps to its Face
+    // without searching bufferLocations
+    bool face_ids = false;
+
+    // Store sections whose elements are all identical as a manifest-only
+    // "constant", and point byte-identical sections at the first copy
+    bool elide_sections = false;
+
+    // Time-series mode: encoding of per-timestep scalar sections against the
+    // previous step ("none", "delta" or "xor"; both operate losslessly on the
+    // IEEE bit patterns), and how often a step is stored raw (0 = only the first
+    // step and steps whose topology changed)
+    std::string time_encoding = "none";
+    int time_keyframe_interval = 0;
+
+    // Runtime hooks, not part of the output. progress is never called
+    // concurrently but may be called from worker threads. Setting *cancel
+    // makes the running conversion stop at its next checkpoint, remove what it
+    // wrote and return false.
+    std::function<void(const UVFProgress&)> progress;
+    const std::atomic<bool>* cancel = nullptr;
+
+    // When set, stage timings and counters of the conversion are added here
+    UVFConversionStats* stats = nullptr;
+
+    // When set, every stage and (in directory mode) every file is recorded as a trace span
+    UVFTraceRecorder* trace = nullptr;
+};
+
+// Set one option from its textual form, as used by the C API and bindings.
+// Keys are the field names above; include_glob/exclude_glob/interleaved_attribute
+// append a value.
+// Returns false for unknown keys or malformed values (options left unchanged).
+bool set_uvf_option(UVFOptions& options, const std::string& key, const std::string& value);
+
+// Stable textual key of every option that affects written sections; cached
+// conversions are only reused when this key matches
+std::string uvf_options_key(const UVFOptions& options);
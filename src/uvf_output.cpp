@@ -0,0 +1,114 @@
+#include "uvf_output.h"
+#include "vtk_structured_parser.h"
+#include <streambuf>
+#include <filesystem>
+#include <cstdlib>
+#include <cstdio>
+
+bool UVFOutput::write_entry(const std::string& name, const std::string& data) {
+    std::ostream* os = open_entry(name, data.size());
+    if (!os) return false;
+    os->write(data.data(), data.size());
+    if (!close_entry()) {
+        discard_entry(name);
+        return false;
+    }
+    return true;
+}
+
+// ---- Directory ----
+
+UVFDirectoryOutput::UVFDirectoryOutput(const std::string& dir) : dir_(dir) {}
+
+std::ostream* UVFDirectoryOutput::open_entry(const std::string& name, size_t /*size*/) {
+    make_dirs(dir_);
+    ofs_ = std::ofstream(dir_ + "/" + name, std::ios::binary);
+    return ofs_ ? &ofs_ : nullptr;
+}
+
+bool UVFDirectoryOutput::close_entry() {
+    ofs_.close();
+    return static_cast<bool>(ofs_);
+}
+
+bool UVFDirectoryOutput::rename_entry(const std::string& from, const std::string& to) {
+    std::error_code ec;
+    std::filesystem::rename(dir_ + "/" + from, dir_ + "/" + to, ec);
+    return !ec;
+}
+
+void UVFDirectoryOutput::discard_entry(const std::string& name) {
+    std::remove((dir_ + "/" + name).c_str());
+}
+
+// ---- Memory ----
+
+// Stream buffer over a fixed block; writing past the end fails the stream
+class UVFMemoryOutput::FixedBuffer : public std::streambuf {
+public:
+    FixedBuffer(char* data, size_t size) { setp(data, data + size); }
+    size_t written() const { return static_cast<size_t>(pptr() - pbase()); }
+};
+
+UVFMemoryOutput::UVFMemoryOutput(Allocator alloc) : alloc_(std::move(alloc)) {
+    if (!alloc_) {
+        alloc_ = [](void* ptr, size_t size) -> void* {
+            if (size == 0) { std::free(ptr); return nullptr; }
+            return std::realloc(ptr, size);
+        };
+    }
+}
+
+UVFMemoryOutput::~UVFMemoryOutput() {
+    for (auto& b : blocks_) {
+        if (b.data) alloc_(b.data, 0);
+    }
+}
+
+std::ostream* UVFMemoryOutput::open_entry(const std::string& name, size_t size) {
+    Block block;
+    block.name = name;
+    block.size = size;
+    // Always hand out a valid pointer, even for empty entries
+    block.data = alloc_(nullptr, size ? size : 1);
+    if (!block.data) return nullptr;
+    blocks_.push_back(block);
+    buf_.reset(new FixedBuffer(static_cast<char*>(block.data), size));
+    os_.reset(new std::ostream(buf_.get()));
+    return os_.get();
+}
+
+bool UVFMemoryOutput::close_entry() {
+    if (!os_ || blocks_.empty()) return false;
+    bool ok = static_cast<bool>(*os_) && buf_->written() == blocks_.back().size;
+    os_.reset();
+    buf_.reset();
+    return ok;
+}
+
+bool UVFMemoryOutput::rename_entry(const std::string& from, const std::string& to) {
+    for (auto& b : blocks_) {
+        if (b.name == to) return false;
+    }
+    for (auto& b : blocks_) {
+        if (b.name == from) { b.name = to; return true; }
+    }
+    return false;
+}
+
+void UVFMemoryOutput::discard_entry(const std::string& name) {
+    for (auto it = blocks_.begin(); it != blocks_.end(); ++it) {
+        if (it->name == name) {
+            if (os_ && it + 1 == blocks_.end()) { os_.reset(); buf_.reset(); }
+            if (it->data) alloc_(it->data, 0);
+            blocks_.erase(it);
+            return;
+        }
+    }
+}
+
+std::vector<UVFMemoryOutput::Block> UVFMemoryOutput::release() {
+    std::vector<Block> out;
+    out.swap(blocks_);
+    return out;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <memory>
+#include <functional>
+
+// Destination for the entries of one UVF dataset (manifest.json and bin files).
+// Entries are written one at a time with their final size known up front.
+class UVFOutput {
+public:
+    virtual ~UVFOutput() = default;
+
+    // Start an entry of exactly size bytes; returns null on failure
+    virtual std::ostream* open_entry(const std::string& name, size_t size) = 0;
+
+    // Finish the open entry; false if any write failed
+    virtual bool close_entry() = 0;
+
+    // Give a finished entry its final name (replacing an existing one)
+    virtual bool rename_entry(const std::string& from, const std::string& to) = 0;
+
+    // Drop an entry, finished or not
+    virtual void discard_entry(const std::string& name) = 0;
+
+    // Write a complete entry in one call
+    bool write_entry(const std::string& name, const std::string& data);
+};
+
+// Entries become files in a directory (created on demand)
+class UVFDirectoryOutput : public UVFOutput {
+public:
+    explicit UVFDirectoryOutput(const std::string& dir);
+
+    std::ostream* open_entry(const std::string& name, size_t size) override;
+    bool close_entry() override;
+    bool rename_entry(const std::string& from, const std::string& to) override;
+    void discard_entry(const std::string& name) override;
+
+private:
+    std::string dir_;
+    std::ofstream ofs_;
+};
+
+// Entries become memory blocks obtained from an allocator, written in place.
+// The allocator follows realloc conventions: alloc(nullptr, n) allocates,
+// alloc(p, 0) frees. Blocks still owned by the output are freed on destruction
+// unless released to the caller.
+class UVFMemoryOutput : public UVFOutput {
+public:
+    using Allocator = std::function<void*(void* ptr, size_t size)>;
+
+    struct Block {
+        std::string name;
+        void* data = nullptr;
+        size_t size = 0;
+    };
+
+    // Default allocator is malloc/free
+    explicit UVFMemoryOutput(Allocator alloc = Allocator());
+    ~UVFMemoryOutput() override;
+
+    std::ostream* open_entry(const std::string& name, size_t size) override;
+    bool close_entry() override;
+    bool rename_entry(const std::string& from, const std::string& to) override;
+    void discard_entry(const std::string& name) override;
+
+    const std::vector<Block>& blocks() const { return blocks_; }
+
+    // Hand ownership of all blocks to the caller
+    std::vector<Block> release();
+
+private:
+    class FixedBuffer;
+
+    Allocator alloc_;
+    std::vector<Block> blocks_;
+    std::unique_ptr<FixedBuffer> buf_;
+    std::unique_ptr<std::ostream> os_;
+};
@@ -1,6 +1,13 @@
 #include "vtk_structured_parser.h"
 #include "vtp_to_uvf.h"
 #include "id_utils.h"
+#include "conversion_stats.h"
+#include "conversion_trace.h"
+#include "json_writer.h"
+#include "binary_manifest.h"
+#include "uvf_container.h"
+#include "file_utils.h"
+#include "progress.h"
 #include <vtkSmartPointer.h>
 #include <vtkPolyData.h>
 #include <vtkPointData.h>
@@ -13,6 +20,7 @@
 #include <map>
 #include <set>
 #include <algorithm>
+#include <cstdio>
 #include <iostream>
 #include <sstream>
 #include <sys/stat.h>
@@ -163,178 +171,177 @@ public:
         const vector<VTKDataClassifier::DataGroup>& groups,
         const map<string, UVFOffsets>& all_offsets,
         const string& output_dir,
-        string& manifest_path
+        string& manifest_path,
+        uint64_t* manifest_bytes = nullptr,
+        UVFBinaryManifestBuilder* binary = nullptr
     ) {
-        std::ostringstream manifest_ss;
-        manifest_ss << "[";
-        
-        bool first = true;
-        
+        UVFBinaryManifestBuilder disabled(false);
+        UVFBinaryManifestBuilder& bm = binary ? *binary : disabled;
+        manifest_path = output_dir + "/manifest.json";
+        std::ofstream ofs(manifest_path, std::ios::binary);
+        if (!ofs) return false;
+
+        UVFJsonWriter json(&ofs);
+        json.begin_array();
+
         // 1. Create root GeometryGroup
-        if (!first) manifest_ss << ",";
-        first = false;
-        manifest_ss << create_root_group_json(groups);
-        
+        write_root_group_json(json, groups);
+        bm.add_group("root_group", true);
+        for (const auto& group : groups) bm.add_group_member(group.group_name);
+
         // 2. Create sub GeometryGroups for each data type
         for (const auto& group : groups) {
-            if (!first) manifest_ss << ",";
-            first = false;
-            manifest_ss << create_sub_geometry_group_json(group);
-            
+            write_sub_geometry_group_json(json, group);
+            bm.add_group(group.group_name, false);
+            for (const auto& data_name : group.data_names) bm.add_group_member(data_name);
+
             // 3. Create SolidGeometry for each data item in the group
             for (const auto& data_name : group.data_names) {
-                if (!first) manifest_ss << ",";
-                first = false;
-                manifest_ss << create_solid_geometry_json(group, data_name, all_offsets);
-                
-                // 4. Create Face for each solid geometry
-                if (!first) manifest_ss << ",";
-                first = false;
-                manifest_ss << create_face_json(group, data_name, all_offsets);
+                write_solid_geometry_json(json, data_name, all_offsets);
+
+                // 4. Create Face for each solid geometry, then its Edges
+                write_face_json(json, data_name, all_offsets);
+                add_binary_nodes(bm, data_name, all_offsets);
+                auto offset_it = all_offsets.find(data_name);
+                if (offset_it != all_offsets.end()) write_edge_nodes_json(json, offset_it->second, data_name, nullptr);
             }
         }
-        
-        manifest_ss << "]";
-        
-        // Write manifest file
-        manifest_path = output_dir + "/manifest.json";
-        std::ofstream ofs(manifest_path);
-        if (!ofs) return false;
-        
-        ofs << manifest_ss.str();
-        ofs.close();
-        
-        return true;
+
+        json.end_array();
+        if (manifest_bytes) *manifest_bytes = json.bytes_written();
+        return json.flush();
     }
     
 private:
-    static string create_root_group_json(const vector<VTKDataClassifier::DataGroup>& groups) {
-        std::ostringstream ss;
-        ss << "{";
-        ss << "\"id\":\"root_group\",";
-        ss << "\"type\":\"GeometryGroup\",";
-        ss << "\"properties\":{";
-        ss << "\"type\":0,";
-        ss << "\"transform\":" << create_transform_matrix();
-        ss << "},";
-        ss << "\"attributions\":{";
-        ss << "\"members\":[";
-        for (size_t i = 0; i < groups.size(); ++i) {
-            if (i > 0) ss << ",";
-            ss << "\"" << groups[i].group_name << "\"";
+    // SolidGeometry and Face of one data item, mirroring the JSON writers below
+    static void add_binary_nodes(UVFBinaryManifestBuilder& bm, const string& data_name, const map<string, UVFOffsets>& all_offsets) {
+        auto offset_it = all_offsets.find(data_name);
+        string face_id = data_name + "_face";
+        string path = "/" + data_name + ".bin";
+        bm.add_solid(data_name, nullptr, offset_it != all_offsets.end() ? &path : nullptr);
+        bm.add_solid_face(face_id);
+        if (offset_it == all_offsets.end()) {
+            bm.add_face(face_id, data_name, 16777215, 1.0f);
+            return;
         }
-        ss << "]";
-        ss << "}";
-        ss << "}";
-        return ss.str();
+        for (const auto& id : edge_node_ids(offset_it->second, data_name)) bm.add_solid_edge(id);
+        bm.add_solid_sections(offset_it->second);
+        auto indices_it = offset_it->second.fields.find("indices");
+        if (indices_it != offset_it->second.fields.end()) {
+            bm.add_face(face_id, data_name, 16777215, 1.0f, 0, section_element_count(indices_it->second) / 3);
+        } else {
+            bm.add_face(face_id, data_name, 16777215, 1.0f);
+        }
+        add_binary_edge_nodes(bm, offset_it->second, data_name);
+    }
+
+    static void write_root_group_json(UVFJsonWriter& json, const vector<VTKDataClassifier::DataGroup>& groups) {
+        json.begin_object();
+        json.key("id"); json.value("root_group");
+        json.key("type"); json.value("GeometryGroup");
+        json.key("properties"); json.begin_object();
+        json.key("type"); json.value(0);
+        json.key("transform"); json.raw_value(create_transform_matrix());
+        json.end_object();
+        json.key("attributions"); json.begin_object();
+        json.key("members"); json.begin_array();
+        for (const auto& group : groups) json.value(group.group_name);
+        json.end_array();
+        json.end_object();
+        json.end_object();
     }
     
-    static string create_sub_geometry_group_json(const VTKDataClassifier::DataGroup& group) {
-        std::ostringstream ss;
-        ss << "{";
-        ss << "\"id\":\"" << group.group_name << "\",";
-        ss << "\"type\":\"GeometryGroup\",";
-        ss << "\"properties\":{\"type\":0},";
-        ss << "\"attributions\":{";
-        ss << "\"members\":[";
-        for (size_t i = 0; i < group.data_names.size(); ++i) {
-            if (i > 0) ss << ",";
-            ss << "\"" << group.data_names[i] << "\"";
-        }
-        ss << "]";
-        ss << "}";
-        ss << "}";
-        return ss.str();
+    static void write_sub_geometry_group_json(UVFJsonWriter& json, const VTKDataClassifier::DataGroup& group) {
+        json.begin_object();
+        json.key("id"); json.value(group.group_name);
+        json.key("type"); json.value("GeometryGroup");
+        json.key("properties"); json.begin_object(); json.key("type"); json.value(0); json.end_object();
+        json.key("attributions"); json.begin_object();
+        json.key("members"); json.begin_array();
+        for (const auto& data_name : group.data_names) json.value(data_name);
+        json.end_array();
+        json.end_object();
+        json.end_object();
     }
     
-    static string create_solid_geometry_json(
-        const VTKDataClassifier::DataGroup& group,
+    static void write_solid_geometry_json(
+        UVFJsonWriter& json,
         const string& data_name,
         const map<string, UVFOffsets>& all_offsets
     ) {
-        std::ostringstream ss;
-        ss << "{";
-        ss << "\"id\":\"" << data_name << "\",";
-        ss << "\"type\":\"SolidGeometry\",";
-        ss << "\"properties\":{},";
-        ss << "\"attributions\":{";
-        ss << "\"edges\":[],";
-        ss << "\"vertices\":[],";
-        ss << "\"faces\":[\"" << data_name << "_face\"]";  // Update face reference
-        ss << "}";
-        
-        // Resources - binary data reference
+        json.begin_object();
+        json.key("id"); json.value(data_name);
+        json.key("type"); json.value("SolidGeometry");
+        json.key("properties"); json.begin_object(); json.end_object();
         auto offset_it = all_offsets.find(data_name);
+        json.key("attributions"); json.begin_object();
+        json.key("edges"); json.begin_array();
         if (offset_it != all_offsets.end()) {
-            ss << ",\"resources\":{";
-            ss << "\"buffers\":{";
-            ss << "\"path\":\"/" << data_name << ".bin\",";
-            ss << "\"sections\":[";
-            
-            bool first_section = true;
-            for (const auto& field : offset_it->second.fields) {
-                if (!first_section) ss << ",";
-                first_section = false;
-                ss << "{";
-                ss << "\"dType\":\"" << field.second.dType << "\",";
-                ss << "\"dimension\":" << field.second.dimension << ",";
-                ss << "\"length\":" << field.second.length << ",";
-                ss << "\"name\":\"" << field.first << "\",";
-                ss << "\"offset\":" << field.second.offset;
-                ss << "}";
-            }
-            
-            ss << "],";
-            ss << "\"type\":\"buffers\"";
-            ss << "}";
-            ss << "}";
+            for (const auto& id : edge_node_ids(offset_it->second, data_name)) json.value(id);
         }
+        json.end_array();
+        json.key("vertices"); json.begin_array(); json.end_array();
+        json.key("faces"); json.begin_array(); json.value(data_name + "_face"); json.end_array();
+        json.end_object();
         
-        ss << "}";
-        return ss.str();
+        // Resources - binary data reference
+        if (offset_it != all_offsets.end()) {
+            json.key("resources"); json.begin_object();
+            json.key("buffers"); json.begin_object();
+            json.key("path"); json.value("/" + data_name + ".bin");
+            json.key("sections"); write_sections_json(json, offset_it->second);
+            json.key("type"); json.value("buffers");
+            json.end_object();
+            json.end_object();
+        }
+        json.end_object();
     }
     
-    static string create_face_json(
-        const VTKDataClassifier::DataGroup& group,
+    static void write_face_json(
+        UVFJsonWriter& json,
         const string& data_name,
         const map<string, UVFOffsets>& all_offsets
     ) {
-        std::ostringstream ss;
-        ss << "{";
-        ss << "\"id\":\"" << data_name << "_face\",";  // Fix ID conflict by adding suffix
-        ss << "\"type\":\"Face\",";
-        ss << "\"properties\":{";
-        ss << "\"alpha\":1.0,";
-        ss << "\"color\":16777215";
+        json.begin_object();
+        json.key("id"); json.value(data_name + "_face");  // Fix ID conflict by adding suffix
+        json.key("type"); json.value("Face");
+        json.key("properties"); json.begin_object();
+        json.key("alpha"); json.raw_value("1.0");
+        json.key("color"); json.value(16777215);
         
         // Buffer locations
         auto offset_it = all_offsets.find(data_name);
         if (offset_it != all_offsets.end()) {
             auto indices_it = offset_it->second.fields.find("indices");
             if (indices_it != offset_it->second.fields.end()) {
-                size_t num_triangles = indices_it->second.length / sizeof(uint32_t) / 3;
-                ss << ",\"bufferLocations\":{";
-                ss << "\"indices\":[{";
-                ss << "\"bufNum\":0,";
-                ss << "\"startIndex\":0,";
-                ss << "\"endIndex\":" << num_triangles;
-                ss << "}]";
-                ss << "}";
+                size_t num_triangles = section_element_count(indices_it->second) / 3;
+                json.key("bufferLocations"); json.begin_object();
+                json.key("indices"); json.begin_array();
+                json.begin_object();
+                json.key("bufNum"); json.value(0);
+                json.key("startIndex"); json.value(0);
+                json.key("endIndex"); json.value(num_triangles);
+                json.end_object();
+                json.end_array();
+                json.end_object();
             }
         }
-        
-        ss << "},";
-        ss << "\"attributions\":{";
-        ss << "\"packedParentId\":\"" << data_name << "\"";  // Fix reference to correct SolidGeometry ID
-        ss << "}";
-        ss << "}";
-        return ss.str();
+        json.end_object();
+        json.key("attributions"); json.begin_object();
+        json.key("packedParentId"); json.value(data_name);  // Fix reference to correct SolidGeometry ID
+        json.end_object();
+        json.end_object();
     }
 };
 
 // Main function to generate structured UVF from VTK
 bool generate_structured_uvf(vtkPolyData* poly, const char* uvf_dir) {
+    return generate_structured_uvf(poly, uvf_dir, UVFOptions());
+}
+
+bool generate_structured_uvf(vtkPolyData* poly, const char* uvf_dir, const UVFOptions& options) {
     if (!poly) return false;
+    UVFTraceSpan span(options.trace, "generate_structured_uvf", "convert");
     
     string out_dir = string(uvf_dir);
     string resources_dir = out_dir + "/";
@@ -345,39 +352,73 @@ bool generate_structured_uvf(vtkPolyData* poly, const char* uvf_dir) {
     make_dirs(resources_dir);
     
     // Classify VTK data into groups
+    UVFStageTimer classify_timer(options, "classify");
     auto groups = VTKDataClassifier::classify_vtk_data(poly);
+    classify_timer.add_items(groups.size());
+    classify_timer.stop();
     
-    // Extract and write binary data for each group
+    // Extract and write binary data for each group; a cancelled run stops
+    // before its next entry and removes the bins it wrote
     map<string, UVFOffsets> all_offsets;
+    UVFProgressReporter progress(options);
+    size_t entries_total = 0, entries_done = 0;
+    for (const auto& group : groups) entries_total += group.poly_data.size();
     
     for (const auto& group : groups) {
         for (const auto& data_entry : group.poly_data) {
             const string& data_name = data_entry.first;
             auto data_poly = data_entry.second;
+            if (progress.cancelled()) break;
+            progress.report("convert", 0, 0, entries_done++, entries_total);
             
             // Extract geometry data
             vector<float> vertices;
             vector<uint32_t> indices;
             map<string, vector<float>> scalar_data;
             
+            UVFStageTimer extract_timer(options, "extract");
             if (!extract_geometry_data(data_poly, vertices, indices, scalar_data)) {
                 continue;
             }
+            extract_timer.add_items(vertices.size() / 3);
+            extract_timer.stop();
             
             // Write binary file
+            UVFStageTimer write_timer(options, "write");
             string bin_path = resources_dir + "/" + data_name + ".bin";
             UVFOffsets offsets;
-            if (!write_binary_data(vertices, indices, scalar_data, bin_path, offsets)) {
+            if (!write_binary_data(vertices, indices, scalar_data, bin_path, offsets, options)) {
                 continue;
             }
+            write_timer.add_bytes(stored_sections_size(offsets));
+            write_timer.add_items(1);
             
             all_offsets[data_name] = offsets;
         }
     }
+    if (progress.cancelled()) {
+        for (const auto& kv : all_offsets) std::remove((resources_dir + "/" + kv.first + ".bin").c_str());
+        std::cerr << "Conversion cancelled" << std::endl;
+        return false;
+    }
+    progress.report("convert", 0, 0, entries_total, entries_total);
     
     // Generate structured manifest
+    UVFStageTimer manifest_timer(options, "manifest");
     string manifest_path;
-    return StructuredManifestGenerator::generate_structured_manifest(
-        groups, all_offsets, out_dir, manifest_path
-    );
+    uint64_t manifest_bytes = 0;
+    UVFBinaryManifestBuilder binary(options.binary_manifest);
+    if (!StructuredManifestGenerator::generate_structured_manifest(
+            groups, all_offsets, out_dir, manifest_path, &manifest_bytes, &binary)) {
+        return false;
+    }
+    if (options.binary_manifest) {
+        string data = binary.serialize();
+        if (!write_file_atomic(out_dir + "/manifest.uvfm", data)) return false;
+        manifest_bytes += data.size();
+    }
+    manifest_timer.add_bytes(manifest_bytes);
+    manifest_timer.add_items(1);
+    manifest_timer.stop();
+    return !options.container || pack_uvf_directory(out_dir, options);
 }
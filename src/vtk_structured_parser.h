@@ -5,6 +5,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include "uvf_options.h"
 
 #ifdef _WIN32
 #include <direct.h>
@@ -31,6 +32,7 @@ namespace VTKStructured {
 
 // Main API functions
 bool generate_structured_uvf(vtkPolyData* poly, const char* uvf_dir);
+bool generate_structured_uvf(vtkPolyData* poly, const char* uvf_dir, const UVFOptions& options);
 
 // Helper functions  
 bool extract_geometry_data(
@@ -55,5 +57,6 @@ bool write_binary_data(
     const vector<uint32_t>& indices, 
     const map<string, vector<float>>& scalar_data, 
     const string& bin_path, 
-    UVFOffsets& offsets
+    UVFOffsets& offsets,
+    const UVFOptions& options
 );
@@ -2,6 +2,20 @@
 #include "vtp_to_uvf.h"
 #include "vtk_structured_parser.h"
 #include "stl_parser.h"
+#include "hash_utils.h"
+#include "uvf_output.h"
+#include "progress.h"
+#include "conversion_stats.h"
+#include "conversion_trace.h"
+#include "json_writer.h"
+#include "binary_manifest.h"
+#include "uvf_container.h"
+#include "mesh_codec.h"
+#include "mesh_normals.h"
+#include "mesh_bvh.h"
+#include "mesh_edges.h"
+#include "mesh_reorder.h"
+#include "parallel_utils.h"
 #include <vtkSmartPointer.h>
 #include <vtkXMLPolyDataReader.h>
 #include <vtkPolyDataReader.h>
@@ -19,23 +33,21 @@
 #include <map>
 #include <algorithm>
 #include <sstream>
+#include <iostream>
+#include <charconv>
 #include <cmath>
+#include <cstring>
+#include <cstdio>
 #include <limits>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <random>
+#include <filesystem>
 #include <vtkCellData.h>
 #include <vtkFieldData.h>
 #include <vtkAbstractArray.h>
 #include <vtkStringArray.h>
 
-// Face segmentation support (FaceIndex + FaceIdMapping)
-struct UVFFaceSegment {
-    std::string id;        // face id (mapped name or generated)
-    size_t startIndex = 0; // index into global indices array (uint32 element index, inclusive)
-    size_t endIndex = 0;   // exclusive end
-};
-
 using std::vector;
 using std::string;
 using std::map;
@@ -108,6 +120,58 @@ vtkSmartPointer<vtkPolyData> parse_vtp_file(const char* path) {
     return output;
 }
 
+vtkSmartPointer<vtkPolyData> parse_vtp_file(const char* path, const UVFOptions& options) {
+    UVFStageTimer timer(options, "parse");
+    auto poly = parse_vtp_file(path);
+    if (poly && options.stats) {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(path, ec);
+        if (!ec) timer.add_bytes(size);
+        timer.add_items(1);
+    }
+    return poly;
+}
+
+vtkSmartPointer<vtkPolyData> parse_polydata_buffer(const void* data, size_t size, const char* format) {
+    if(!data || !format) return nullptr;
+    std::string ext = file_ext_lower((std::string(".") + format).c_str());
+    const char* bytes = static_cast<const char*>(data);
+    vtkSmartPointer<vtkPolyData> output;
+    if(ext == "stl") {
+        output = parse_stl_buffer(data, size);
+    } else if(ext == "vtp") {
+        auto reader = vtkSmartPointer<vtkXMLPolyDataReader>::New();
+        reader->ReadFromInputStringOn();
+        reader->SetInputString(std::string(bytes, size));
+        reader->Update();
+        output = reader->GetOutput();
+    } else if(ext == "vtk") {
+        if(size > static_cast<size_t>(std::numeric_limits<int>::max())) return nullptr;
+        auto pdReader = vtkSmartPointer<vtkPolyDataReader>::New();
+        pdReader->ReadFromInputStringOn();
+        pdReader->SetBinaryInputString(bytes, static_cast<int>(size));
+        if(pdReader->IsFilePolyData()) {
+            pdReader->Update();
+            output = pdReader->GetOutput();
+        } else {
+            auto ugReader = vtkSmartPointer<vtkUnstructuredGridReader>::New();
+            ugReader->ReadFromInputStringOn();
+            ugReader->SetBinaryInputString(bytes, static_cast<int>(size));
+            if(ugReader->IsFileUnstructuredGrid()) {
+                ugReader->Update();
+                auto geom = vtkSmartPointer<vtkGeometryFilter>::New();
+                geom->SetInputData(ugReader->GetOutput());
+                geom->Update();
+                output = geom->GetOutput();
+            }
+        }
+    }
+    if(output && output->GetNumberOfPoints()==0) {
+        return nullptr;
+    }
+    return output;
+}
+
 // Parse VTP file, extract vertices, indices, scalar fields
 bool read_vtp_data(const char* filename, vector<float>& vertices, vector<uint32_t>& indices, map<string, vector<float>>& scalar_data) {
     auto reader = vtkSmartPointer<vtkXMLPolyDataReader>::New();
@@ -172,37 +236,500 @@ bool read_vtp_data(const char* filename, vector<float>& vertices, vector<uint32_
     return true;
 }
 
-// Write binary data, return offsets info
-bool write_binary_data(const vector<float>& vertices, const vector<uint32_t>& indices, const map<string, vector<float>>& scalar_data, const string& bin_path, UVFOffsets& offsets) {
-    std::ofstream ofs(bin_path, std::ios::binary);
-    if (!ofs) return false;
-    size_t current_offset = 0;
-    // Indices
-    ofs.write(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(uint32_t));
-    offsets.fields["indices"] = {current_offset, indices.size() * sizeof(uint32_t), "uint32", 1};
-    current_offset += indices.size() * sizeof(uint32_t);
-    // Vertices
-    ofs.write(reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(float));
-    offsets.fields["position"] = {current_offset, vertices.size() * sizeof(float), "float32", 3};
-    current_offset += vertices.size() * sizeof(float);
-    // Scalar fields
+// Borrow vector-held data as a mesh view (per-vertex dimension inferred from sizes)
+static UVFMeshView make_mesh_view(const vector<float>& vertices, const vector<uint32_t>& indices, const map<string, vector<float>>& scalar_data) {
+    UVFMeshView mesh;
+    mesh.positions = vertices.data();
+    mesh.vertex_count = vertices.size() / 3;
+    mesh.indices = indices.data();
+    mesh.index_count = indices.size();
     for (const auto& kv : scalar_data) {
-        const string& name = kv.first;
         const auto& data = kv.second;
-        ofs.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(float));
         int dim = 1;
-        if (!data.empty() && vertices.size() / 3 == data.size()) dim = 1;
-        else if (!data.empty() && data.size() % (vertices.size() / 3) == 0) dim = data.size() / (vertices.size() / 3);
-        offsets.fields[name] = {current_offset, data.size() * sizeof(float), "float32", dim};
-        current_offset += data.size() * sizeof(float);
+        if (!data.empty() && mesh.vertex_count == data.size()) dim = 1;
+        else if (!data.empty() && mesh.vertex_count > 0 && data.size() % mesh.vertex_count == 0) dim = data.size() / mesh.vertex_count;
+        mesh.attributes.push_back({kv.first, data.data(), data.size(), dim});
+    }
+    return mesh;
+}
+
+// Attributes in section order (by name, as map-held scalar data always was)
+static vector<const UVFAttributeView*> sorted_attributes(const UVFMeshView& mesh) {
+    vector<const UVFAttributeView*> attrs;
+    for (const auto& a : mesh.attributes) attrs.push_back(&a);
+    std::stable_sort(attrs.begin(), attrs.end(), [](const UVFAttributeView* x, const UVFAttributeView* y){ return x->name < y->name; });
+    return attrs;
+}
+
+UVFSectionSource make_section_source(const string& name, const void* data, size_t bytes, const string& dType, int dimension) {
+    UVFSectionSource s;
+    s.name = name;
+    s.data = data;
+    s.bytes = bytes;
+    s.dType = dType;
+    s.dimension = dimension;
+    return s;
+}
+
+vector<UVFSectionSource> mesh_section_sources(const UVFMeshView& mesh) {
+    vector<UVFSectionSource> sections;
+    sections.push_back(make_section_source("indices", mesh.indices, mesh.index_count * sizeof(uint32_t), "uint32", 1));
+    sections.push_back(make_section_source("position", mesh.positions, mesh.vertex_count * 3 * sizeof(float), "float32", 3));
+    for (const UVFAttributeView* a : sorted_attributes(mesh)) {
+        sections.push_back(make_section_source(a->name, a->data, a->count * sizeof(float), "float32", a->components));
     }
+    return sections;
+}
+
+// True when options.normals generates a "normal" section for mesh (a "normal"
+// array of the input wins over generated normals)
+static bool generates_normals(const UVFMeshView& mesh, const UVFOptions& options) {
+    if (options.normals == "none" || mesh.index_count == 0) return false;
+    for (const auto& a : mesh.attributes) {
+        if (a.name == "normal") return false;
+    }
+    return true;
+}
+
+// mesh with the vertices shared by several face segments split
+// (split_face_vertices), its arrays in storage; mesh itself when none are shared
+static UVFMeshView split_face_vertex_view(const UVFMeshView& mesh, const UVFOptions& options, std::list<string>& storage) {
+    UVFStageTimer timer(options, "normals");
+    vector<uint32_t> indices, source;
+    if (!split_face_vertices(mesh, indices, source)) return mesh;
+    const size_t n = mesh.vertex_count, total = n + source.size();
+    auto gather = [&](const float* data, size_t components) {
+        string& bytes = storage.emplace_back(total * components * sizeof(float), '\0');
+        float* out = reinterpret_cast<float*>(&bytes[0]);
+        std::copy(data, data + n * components, out);
+        for (size_t k = 0; k < source.size(); ++k) {
+            std::copy(data + size_t(source[k]) * components, data + (size_t(source[k]) + 1) * components, out + (n + k) * components);
+        }
+        return static_cast<const float*>(out);
+    };
+    UVFMeshView split = mesh;
+    split.positions = gather(mesh.positions, 3);
+    split.vertex_count = total;
+    for (auto& a : split.attributes) {
+        if (a.count != n * static_cast<size_t>(a.components)) continue;
+        a.data = gather(a.data, static_cast<size_t>(a.components));
+        a.count = total * static_cast<size_t>(a.components);
+    }
+    string& index_bytes = storage.emplace_back(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(uint32_t));
+    split.indices = reinterpret_cast<const uint32_t*>(index_bytes.data());
+    timer.add_items(source.size());
+    return split;
+}
+
+// The "normal" section of options.normals (after "position")
+static void add_normal_section(const UVFMeshView& mesh, const UVFOptions& options, vector<UVFSectionSource>& sections,
+                               std::list<string>& storage) {
+    UVFStageTimer timer(options, "normals");
+    timer.add_items(mesh.vertex_count);
+    string& bytes = storage.emplace_back(mesh.vertex_count * 3 * sizeof(float), '\0');
+    compute_vertex_normals(mesh, options.threads, reinterpret_cast<float*>(&bytes[0]));
+    UVFSectionSource normal = make_section_source("normal", bytes.data(), bytes.size(), "float32", 3);
+    if (options.normals == UVF_OCT_NORMAL_ENCODING) {
+        string& oct = storage.emplace_back(mesh.vertex_count * 2 * sizeof(int16_t), '\0');
+        encode_normals_oct16(reinterpret_cast<const float*>(bytes.data()), mesh.vertex_count,
+                             reinterpret_cast<int16_t*>(&oct[0]), options.threads);
+        normal.data = oct.data();
+        normal.bytes = oct.size();
+        normal.encoding = UVF_OCT_NORMAL_ENCODING;
+        normal.decoded_length = bytes.size();
+    }
+    timer.add_bytes(normal.bytes);
+    sections.insert(sections.begin() + 2, normal);
+}
+
+// The "bvhNodes" and "bvhTriangles" sections of options.bvh
+static void add_bvh_sections(const UVFMeshView& mesh, const UVFOptions& options, vector<UVFSectionSource>& sections,
+                             std::list<string>& storage) {
+    UVFStageTimer timer(options, "bvh");
+    vector<UVFBvhNode> nodes;
+    vector<uint32_t> triangles;
+    build_mesh_bvh(mesh, options.threads, nodes, triangles);
+    string& node_bytes = storage.emplace_back(reinterpret_cast<const char*>(nodes.data()), nodes.size() * sizeof(UVFBvhNode));
+    string& triangle_bytes = storage.emplace_back(reinterpret_cast<const char*>(triangles.data()), triangles.size() * sizeof(uint32_t));
+    sections.push_back(make_section_source("bvhNodes", node_bytes.data(), node_bytes.size(), "uint32", 8));
+    sections.push_back(make_section_source("bvhTriangles", triangle_bytes.data(), triangle_bytes.size(), "uint32", 1));
+    timer.add_items(triangles.size());
+    timer.add_bytes(node_bytes.size() + triangle_bytes.size());
+}
+
+// The line-index sections of options.feature_edges (empty classes omitted)
+static void add_edge_sections(const UVFMeshView& mesh, const UVFOptions& options, vector<UVFSectionSource>& sections,
+                              std::list<string>& storage) {
+    UVFStageTimer timer(options, "edges");
+    timer.add_items(mesh.index_count / 3);
+    UVFMeshEdges edges;
+    extract_feature_edges(mesh, options.feature_angle, options.threads, edges);
+    for (int cls = 0; cls < UVF_EDGE_CLASS_COUNT; ++cls) {
+        const vector<uint32_t>& lines = edges.lines[cls];
+        if (lines.empty()) continue;
+        string& bytes = storage.emplace_back(reinterpret_cast<const char*>(lines.data()), lines.size() * sizeof(uint32_t));
+        sections.push_back(make_section_source(UVF_EDGE_SECTION_NAMES[cls], bytes.data(), bytes.size(), "uint32", 2));
+        timer.add_bytes(bytes.size());
+    }
+}
+
+// The "vertices" section of options.vertex_layout, in place of "position"
+static void add_interleaved_section(const UVFMeshView& mesh, const UVFOptions& options, vector<UVFSectionSource>& sections,
+                                    std::list<string>& storage) {
+    auto interleavable = [&](const UVFSectionSource& s) {
+        return s.dType == "float32" && s.encoding.empty() && s.dimension > 0 &&
+               s.bytes == mesh.vertex_count * static_cast<size_t>(s.dimension) * sizeof(float);
+    };
+    vector<size_t> members;
+    auto add = [&](const string& name) {
+        for (size_t i = 0; i < sections.size(); ++i) {
+            if (sections[i].name != name || !interleavable(sections[i])) continue;
+            if (std::find(members.begin(), members.end(), i) == members.end()) members.push_back(i);
+            return;
+        }
+    };
+    add("position");
+    if (members.empty()) return;
+    if (options.interleaved_attributes.empty()) {
+        add("normal");
+        for (const auto& s : sections) {
+            if (s.name != "indices") add(s.name);
+        }
+    } else {
+        for (const auto& name : options.interleaved_attributes) add(name);
+    }
+
+    UVFStageTimer timer(options, "interleave");
+    UVFSectionSource vertices = make_section_source(UVF_INTERLEAVED_SECTION, nullptr, 0, "float32", 0);
+    for (size_t i : members) {
+        vertices.interleaved.push_back({sections[i].name, static_cast<uint32_t>(vertices.dimension * sizeof(float)),
+                                        sections[i].dimension});
+        vertices.dimension += sections[i].dimension;
+    }
+    const size_t stride = static_cast<size_t>(vertices.dimension);
+    string& bytes = storage.emplace_back(mesh.vertex_count * stride * sizeof(float), '\0');
+    float* out = reinterpret_cast<float*>(&bytes[0]);
+    parallel_for_chunks(mesh.vertex_count, options.threads, size_t(1) << 15, [&](size_t begin, size_t end) {
+        size_t at = 0;
+        for (size_t i : members) {
+            const float* src = static_cast<const float*>(sections[i].data);
+            const size_t dim = static_cast<size_t>(sections[i].dimension);
+            for (size_t v = begin; v < end; ++v) {
+                std::copy(src + v * dim, src + (v + 1) * dim, out + v * stride + at);
+            }
+            at += dim;
+        }
+    });
+    vertices.data = bytes.data();
+    vertices.bytes = bytes.size();
+    timer.add_items(mesh.vertex_count);
+    timer.add_bytes(bytes.size());
+
+    vector<UVFSectionSource> laid_out;
+    for (size_t i = 0; i < sections.size(); ++i) {
+        if (i == members[0]) laid_out.push_back(vertices);
+        bool member = std::find(members.begin(), members.end(), i) != members.end();
+        if (!member || options.vertex_layout != "interleaved") laid_out.push_back(sections[i]);
+    }
+    sections.swap(laid_out);
+}
+
+vector<UVFSectionSource> mesh_section_sources(const UVFMeshView& input, const UVFOptions& options, std::list<string>& storage) {
+    // Generated normals need one copy of each face boundary vertex per face;
+    // copies are appended, so edges can still be extracted from the input
+    const bool normals = generates_normals(input, options);
+    const UVFMeshView mesh = normals ? split_face_vertex_view(input, options, storage) : input;
+    vector<UVFSectionSource> sections = mesh_section_sources(mesh);
+    if (mesh.index_count > 0) {
+        if (normals) add_normal_section(mesh, options, sections, storage);
+        if (options.bvh) add_bvh_sections(mesh, options, sections, storage);
+        if (options.feature_edges) add_edge_sections(input, options, sections, storage);
+    }
+    if (options.vertex_layout != "separate") add_interleaved_section(mesh, options, sections, storage);
+    return sections;
+}
+
+uint64_t section_element_count(const UVFOffsets::Info& info) {
+    if (info.decoded_length) return info.decoded_length / sizeof(uint32_t);
+    if (!info.blocks.codec.empty()) return info.blocks.raw_length / sizeof(uint32_t);
+    return info.length / sizeof(uint32_t);
+}
+
+vector<string> edge_node_ids(const UVFOffsets& offsets, const string& parent) {
+    vector<string> ids;
+    for (const char* name : UVF_EDGE_SECTION_NAMES) {
+        if (offsets.fields.count(name)) ids.push_back(parent + "_" + name);
+    }
+    return ids;
+}
+
+void write_edge_nodes_json(UVFJsonWriter& json, const UVFOffsets& offsets, const string& parent, const string* geom_kind) {
+    for (const char* name : UVF_EDGE_SECTION_NAMES) {
+        auto it = offsets.fields.find(name);
+        if (it == offsets.fields.end()) continue;
+        json.begin_object();
+        json.key("attributions"); json.begin_object();
+        json.key("packedParentId"); json.value(parent);
+        json.end_object();
+        json.key("id"); json.value(parent + "_" + name);
+        json.key("properties"); json.begin_object();
+        json.key("alpha"); json.value(1);
+        json.key("bufferLocations"); json.begin_object();
+        json.key(name); json.begin_array();
+        json.begin_object();
+        json.key("bufNum"); json.value(0);
+        json.key("endIndex"); json.value(section_element_count(it->second));
+        json.key("startIndex"); json.value(0);
+        json.end_object();
+        json.end_array();
+        json.end_object();
+        json.key("color"); json.value(0);
+        if (geom_kind) { json.key("geomKind"); json.value(*geom_kind); }
+        json.end_object();
+        json.key("type"); json.value("Edge");
+        json.end_object();
+    }
+}
+
+void add_binary_edge_nodes(UVFBinaryManifestBuilder& bm, const UVFOffsets& offsets, const string& parent) {
+    for (const char* name : UVF_EDGE_SECTION_NAMES) {
+        auto it = offsets.fields.find(name);
+        if (it != offsets.fields.end()) bm.add_edge(parent + "_" + name, parent, 0, 1.0f, name, 0, section_element_count(it->second));
+    }
+}
+
+size_t UVFPreparedSections::stored_size() const {
+    size_t total = 0;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        if (sources[i].alias_of < 0) total += compressed ? packed[i].stored_length() : sources[i].bytes;
+    }
+    return total;
+}
+
+// True when every 4-byte element of the section has the same bit pattern
+// (a finite value for float32, so the manifest can spell it out)
+static bool is_constant_section(const UVFSectionSource& s) {
+    if (s.bytes < 8 || s.bytes % 4 != 0 || (s.dType != "float32" && s.dType != "uint32")) return false;
+    const uint32_t* words = static_cast<const uint32_t*>(s.data);
+    if (s.dType == "float32") {
+        float f;
+        std::memcpy(&f, words, 4);
+        if (!std::isfinite(f)) return false;
+    }
+    size_t count = s.bytes / 4;
+    for (size_t i = 1; i < count; ++i) {
+        if (words[i] != words[0]) return false;
+    }
+    return true;
+}
+
+// Mark constant sections and exact duplicates of earlier sections
+static void elide_sections(vector<UVFSectionSource>& sources, const UVFOptions& options) {
+    UVFStageTimer timer(options, "elide");
+    for (size_t i = 0; i < sources.size(); ++i) {
+        UVFSectionSource& s = sources[i];
+        if (!s.encoding.empty()) continue;
+        if (is_constant_section(s)) {
+            timer.add_bytes(s.bytes);
+            timer.add_items(1);
+            s.encoding = UVF_CONSTANT_ENCODING;
+            s.decoded_length = s.bytes;
+            std::memcpy(&s.constant_bits, s.data, 4);
+            s.data = nullptr;
+            s.bytes = 0;
+            continue;
+        }
+        // Same length and type first, so the byte comparison rarely runs
+        for (size_t j = 0; j < i; ++j) {
+            const UVFSectionSource& o = sources[j];
+            if (o.alias_of < 0 && o.encoding.empty() && o.bytes == s.bytes && o.dType == s.dType && o.dimension == s.dimension &&
+                std::memcmp(o.data, s.data, s.bytes) == 0) {
+                timer.add_bytes(s.bytes);
+                timer.add_items(1);
+                s.alias_of = static_cast<int>(j);
+                break;
+            }
+        }
+    }
+}
+
+bool prepare_sections(const vector<UVFSectionSource>& sources, bool mesh_geometry, const UVFOptions& options,
+                      UVFPreparedSections& prepared) {
+    prepared.sources = sources;
+    if (options.elide_sections) elide_sections(prepared.sources, options);
+    if (mesh_geometry && options.mesh_codecs) {
+        UVFStageTimer timer(options, "encode");
+        for (auto& s : prepared.sources) {
+            if (!s.encoding.empty() || s.alias_of >= 0) continue;
+            bool indices = s.name == "indices" && s.dType == "uint32";
+            bool vectors = (s.name == "position" || s.name == UVF_INTERLEAVED_SECTION) && s.dType == "float32";
+            if (!indices && !vectors) continue;
+            prepared.storage.emplace_back();
+            string& encoded = prepared.storage.back();
+            if (indices) {
+                encode_indices_delta_varint(static_cast<const uint32_t*>(s.data), s.bytes / sizeof(uint32_t), encoded);
+                s.encoding = UVF_INDEX_ENCODING;
+            } else {
+                encoded.resize(s.bytes);
+                encode_byteplane_delta(static_cast<const float*>(s.data), s.bytes / sizeof(float) / s.dimension,
+                                       s.dimension, &encoded[0], options.threads);
+                s.encoding = UVF_VECTOR_ENCODING;
+            }
+            timer.add_bytes(s.bytes);
+            timer.add_items(1);
+            s.decoded_length = s.bytes;
+            s.data = encoded.data();
+            s.bytes = encoded.size();
+        }
+    }
+    prepared.compressed = options.compression != "none";
+    if (prepared.compressed) {
+        UVFStageTimer timer(options, "compress");
+        vector<UVFSectionBytes> raw;
+        for (const auto& s : prepared.sources) {
+            // Aliases reuse the blocks of the section they point at
+            size_t bytes = s.alias_of < 0 ? s.bytes : 0;
+            raw.push_back({s.data, bytes});
+            timer.add_bytes(bytes);
+        }
+        if (!compress_sections(raw, options.compression, options.compression_block_size, options.threads, prepared.packed)) return false;
+        for (const auto& c : prepared.packed) timer.add_items(c.blocks.size());
+    }
+    return true;
+}
+
+bool write_prepared_sections(const UVFPreparedSections& prepared, std::ostream& os, UVFOffsets& offsets,
+                             UVFHasher* hasher, UVFProgressReporter* progress) {
+    // Large sections go out in slices so progress and cancellation stay responsive
+    const size_t kSlice = size_t(8) << 20;
+    const size_t total = prepared.stored_size();
+    size_t current_offset = 0;
+    bool cancelled = false;
+    auto put = [&](const char* p, size_t bytes, size_t done_before) {
+        for (size_t done = 0; done < bytes && !cancelled; ) {
+            size_t n = std::min(kSlice, bytes - done);
+            os.write(p + done, n);
+            if (hasher) hasher->update(p + done, n);
+            done += n;
+            if (progress) {
+                cancelled = progress->cancelled();
+                progress->report("write", current_offset + done_before + done, total, 0, 0);
+            }
+        }
+    };
+    vector<UVFOffsets::Info> written;
+    for (size_t i = 0; i < prepared.sources.size(); ++i) {
+        const UVFSectionSource& s = prepared.sources[i];
+        if (s.alias_of >= 0) {
+            written.push_back(written[s.alias_of]);
+            written.back().interleaved = s.interleaved;
+            offsets.fields[s.name] = written.back();
+            continue;
+        }
+        UVFOffsets::Info info;
+        info.offset = current_offset;
+        info.length = s.bytes;
+        info.dType = s.dType;
+        info.dimension = s.dimension;
+        info.encoding = s.encoding;
+        info.decoded_length = s.decoded_length;
+        info.constant_bits = s.constant_bits;
+        info.interleaved = s.interleaved;
+        if (s.encoding == UVF_CONSTANT_ENCODING) {
+            // Nothing stored
+        } else if (prepared.compressed) {
+            const UVFCompressedSection& c = prepared.packed[i];
+            size_t done = 0;
+            for (const string& block : c.blocks) {
+                put(block.data(), block.size(), done);
+                done += block.size();
+            }
+            info.length = done;
+            info.blocks = c.layout;
+        } else {
+            put(static_cast<const char*>(s.data), s.bytes, 0);
+        }
+        offsets.fields[s.name] = info;
+        written.push_back(info);
+        current_offset += info.length;
+    }
+    return !cancelled && static_cast<bool>(os);
+}
+
+// The mesh sections are built from: mesh itself, or its copy in storage
+// reordered along options.reorder
+static const UVFMeshView& reordered_mesh(const UVFMeshView& mesh, const UVFOptions& options, UVFReorderedMesh& storage) {
+    if (options.reorder != "morton" || mesh.vertex_count == 0) return mesh;
+    UVFStageTimer timer(options, "reorder");
+    reorder_mesh_morton(mesh, options.threads, storage);
+    timer.add_items(mesh.vertex_count);
+    timer.add_bytes((mesh.vertex_count * 3 + mesh.index_count) * 4);
+    return storage.view;
+}
+
+bool write_binary_data(const vector<float>& vertices, const vector<uint32_t>& indices, const map<string, vector<float>>& scalar_data, const string& bin_path, UVFOffsets& offsets, const UVFOptions& options) {
+    UVFMeshView input = make_mesh_view(vertices, indices, scalar_data);
+    input.faces.push_back({"", 0, indices.size()});
+    UVFReorderedMesh reordered;
+    const UVFMeshView& mesh = reordered_mesh(input, options, reordered);
+    std::list<string> storage;
+    UVFPreparedSections prepared;
+    if (!prepare_sections(mesh_section_sources(mesh, options, storage), true, options, prepared)) return false;
+    // Callers report their own progress per file; only the cancel flag is
+    // honoured here, so a large file stops between slices
+    UVFOptions cancel_only;
+    cancel_only.cancel = options.cancel;
+    UVFProgressReporter progress(cancel_only);
+    if (progress.cancelled()) return false;
+    std::ofstream ofs(bin_path, std::ios::binary);
+    if (!ofs) return false;
+    bool ok = write_prepared_sections(prepared, ofs, offsets, nullptr, &progress);
     ofs.close();
+    if (!ok || !ofs) {
+        std::remove(bin_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+size_t stored_sections_size(const UVFOffsets& offsets) {
+    size_t total = 0;
+    for (const auto& kv : offsets.fields) total += kv.second.length;
+    return total;
+}
+
+bool validate_mesh_view(const UVFMeshView& mesh, string& error) {
+    if (mesh.vertex_count == 0 || !mesh.positions) { error = "mesh has no positions"; return false; }
+    if (mesh.index_count % 3 != 0 || (mesh.index_count && !mesh.indices)) { error = "index count is not a multiple of 3"; return false; }
+    for (size_t i = 0; i < mesh.index_count; ++i) {
+        if (mesh.indices[i] >= mesh.vertex_count) {
+            error = "index " + std::to_string(i) + " out of range";
+            return false;
+        }
+    }
+    map<string, int> names;
+    for (const auto& a : mesh.attributes) {
+        if (a.name.empty() || a.name == "indices" || a.name == "position" || names[a.name]++) {
+            error = "invalid or duplicate attribute name '" + a.name + "'";
+            return false;
+        }
+        if (a.components < 1 || !a.data || a.count != mesh.vertex_count * static_cast<size_t>(a.components)) {
+            error = "attribute '" + a.name + "' does not match the vertex count";
+            return false;
+        }
+    }
+    for (const auto& f : mesh.faces) {
+        if (f.id.empty() || f.startIndex > f.endIndex || f.endIndex > mesh.index_count) {
+            error = "face range '" + f.id + "' is invalid";
+            return false;
+        }
+    }
     return true;
 }
 
 // Write manifest.json
 // Classify geometry kind based on simple heuristics
-static string classify_geometry_kind(vtkPolyData* poly, const vector<float>& vertices, const vector<uint32_t>& indices, const map<string, vector<float>>& scalar_data, const string& baseName) {
+string classify_geometry_kind(vtkPolyData* poly, const vector<float>& vertices, const vector<uint32_t>& indices, const map<string, vector<float>>& scalar_data, const string& baseName) {
     if(poly) {
         bool hasLines = poly->GetLines() && poly->GetLines()->GetNumberOfCells() > 0;
         bool hasPolys = poly->GetPolys() && poly->GetPolys()->GetNumberOfCells() > 0;
@@ -241,144 +768,236 @@ static string classify_geometry_kind(vtkPolyData* poly, const vector<float>& ver
     return "surface"; // default
 }
 
-// New manifest creator accepting geometry kind
-bool create_manifest(const vector<float>& vertices, const vector<uint32_t>& indices, const map<string, vector<float>>& scalar_data, const UVFOffsets& offsets, const string& bin_path, const string& name, const string& output_dir, string& manifest_path, const string& geom_kind) {
-    std::ostringstream sections_ss;
-    sections_ss << "[";
-    bool first=true;
-    for (const auto& kv : offsets.fields) {
-        if(!first) sections_ss << ","; first=false;
-        sections_ss << "{\"dType\":\""<<kv.second.dType<<"\",";
-        sections_ss << "\"dimension\":"<<kv.second.dimension<<",";
-        sections_ss << "\"length\":"<<kv.second.length<<",";
-        sections_ss << "\"name\":\""<<kv.first<<"\",";
-        sections_ss << "\"offset\":"<<kv.second.offset;
-
-        // Add rangeMin and rangeMax for scalar data
-        if (kv.first != "indices" && kv.first != "position") {
-            auto scalar_it = scalar_data.find(kv.first);
-            if (scalar_it != scalar_data.end() && !scalar_it->second.empty()) {
-                const auto& data = scalar_it->second;
-                float minVal = *std::min_element(data.begin(), data.end());
-                float maxVal = *std::max_element(data.begin(), data.end());
-                sections_ss << ",\"rangeMin\":" << minVal;
-                sections_ss << ",\"rangeMax\":" << maxVal;
-            }
+// Classify a mesh without VTK cell information: all-degenerate (a,b,b)
+// triangles are line segments, a flat bounding box is a slice
+static string classify_mesh_kind(const UVFMeshView& mesh) {
+    if (mesh.index_count > 0) {
+        bool allSegments = true;
+        for (size_t t = 0; t + 2 < mesh.index_count && allSegments; t += 3) {
+            allSegments = mesh.indices[t + 1] == mesh.indices[t + 2];
         }
-
-        sections_ss << "}";
+        if (allSegments) return "streamline";
     }
-    sections_ss << "]";
-
-    // Map geom_kind to valid second layer ID
-    string second_layer_id;
-    if (geom_kind == "slice") {
-        second_layer_id = "slices";
-    } else if (geom_kind == "isosurface") {
-        second_layer_id = "isosurfaces";
-    } else if (geom_kind == "streamline") {
-        second_layer_id = "streamlines";
-    } else {
-        second_layer_id = "surfaces"; // default for "surface" and any other cases
+    float minv[3] = {mesh.positions[0], mesh.positions[1], mesh.positions[2]};
+    float maxv[3] = {minv[0], minv[1], minv[2]};
+    for (size_t i = 0; i < mesh.vertex_count; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            float v = mesh.positions[i * 3 + j];
+            if (v < minv[j]) minv[j] = v;
+            if (v > maxv[j]) maxv[j] = v;
+        }
     }
+    float ex = maxv[0]-minv[0];
+    float ey = maxv[1]-minv[1];
+    float ez = maxv[2]-minv[2];
+    float diag = std::sqrt(ex*ex+ey*ey+ez*ez);
+    float eps = diag * 0.01f + 1e-6f;
+    if (diag > 0.f && (ex < eps || ey < eps || ez < eps)) return "slice";
+    return "surface";
+}
 
-    std::ostringstream manifest_ss;
-    manifest_ss << "[";
-    // First layer: root_group (GeometryGroup)
-    manifest_ss << "{\"attributions\":{\"members\":[\""<<second_layer_id<<"\"]},\"id\":\"root_group\",\"properties\":{\"transform\":[1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1],\"type\":0},\"type\":\"GeometryGroup\"},";
-    // Second layer: adapt attributions for line (streamline) data: put name under edges instead of faces
-    if(geom_kind == "streamline") {
-        manifest_ss << "{\"attributions\":{\"edges\":[\""<<name<<"\"],\"faces\":[],\"vertices\":[]},\"id\":\""<<second_layer_id<<"\",\"properties\":{\"geomKind\":\""<<geom_kind<<"\"},\"resources\":{\"buffers\":{\"path\":\""<<bin_path<<"\",\"sections\":"<<sections_ss.str()<<",\"type\":\"buffers\"}},\"type\":\"SolidGeometry\"},";
-    } else {
-        manifest_ss << "{\"attributions\":{\"edges\":[],\"faces\":[\""<<name<<"\"],\"vertices\":[]},\"id\":\""<<second_layer_id<<"\",\"properties\":{\"geomKind\":\""<<geom_kind<<"\"},\"resources\":{\"buffers\":{\"path\":\""<<bin_path<<"\",\"sections\":"<<sections_ss.str()<<",\"type\":\"buffers\"}},\"type\":\"SolidGeometry\"},";
-    }
-    // Third layer: Face - endIndex should be the total number of indices, not triangles
-    manifest_ss << "{\"attributions\":{\"packedParentId\":\""<<second_layer_id<<"\"},\"id\":\""<<name<<"\",\"properties\":{\"alpha\":1,\"bufferLocations\":{\"indices\":[{\"bufNum\":0,\"endIndex\":"<< indices.size() <<",\"startIndex\":0}]},\"color\":16777215,\"geomKind\":\""<<geom_kind<<"\"},\"type\":\"Face\"}]";
+static const char* const kIdentityTransform = "[1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1]";
 
-    manifest_path = output_dir + "/manifest.json";
-    std::ofstream ofs(manifest_path);
-    if (!ofs) return false;
-    ofs << manifest_ss.str();
-    ofs.close();
-    return true;
+// Value of a constant section: exact shortest form of the float, or the integer
+static void write_constant_json(UVFJsonWriter& json, const UVFOffsets::Info& info) {
+    if (info.dType != "float32") {
+        json.value(info.constant_bits);
+        return;
+    }
+    float f;
+    std::memcpy(&f, &info.constant_bits, 4);
+    char buf[32];
+    auto res = std::to_chars(buf, buf + sizeof(buf), f);
+    json.raw_value(std::string_view(buf, res.ptr - buf));
 }
 
-// New manifest creator supporting multiple face segments
-static bool create_manifest_with_faces(const vector<float>& vertices,
-                                       const vector<uint32_t>& indices,
-                                       const map<string, vector<float>>& scalar_data,
-                                       const UVFOffsets& offsets,
-                                       const string& bin_path,
-                                       const string& baseName,
-                                       const string& output_dir,
-                                       string& manifest_path,
-                                       const string& geom_kind,
-                                       const vector<UVFFaceSegment>& faces) {
-    // Build sections JSON (same as original)
-    std::ostringstream sections_ss;
-    sections_ss << "[";
-    bool first=true;
+void write_sections_json(UVFJsonWriter& json, const UVFOffsets& offsets, const map<string, std::pair<float, float>>* ranges) {
+    json.begin_array();
     for (const auto& kv : offsets.fields) {
-        if(!first) sections_ss << ","; first=false;
-        sections_ss << "{\"dType\":\""<<kv.second.dType<<"\",";
-        sections_ss << "\"dimension\":"<<kv.second.dimension<<",";
-        sections_ss << "\"length\":"<<kv.second.length<<",";
-        sections_ss << "\"name\":\""<<kv.first<<"\",";
-        sections_ss << "\"offset\":"<<kv.second.offset;
-        if (kv.first != "indices" && kv.first != "position") {
-            auto it = scalar_data.find(kv.first);
-            if(it!=scalar_data.end() && !it->second.empty()) {
-                float minV = *std::min_element(it->second.begin(), it->second.end());
-                float maxV = *std::max_element(it->second.begin(), it->second.end());
-                sections_ss << ",\"rangeMin\":"<<minV;
-                sections_ss << ",\"rangeMax\":"<<maxV;
+        const UVFSectionBlocks& blocks = kv.second.blocks;
+        json.begin_object();
+        if (!kv.second.interleaved.empty()) {
+            json.key("attributes"); json.begin_array();
+            for (const auto& a : kv.second.interleaved) {
+                json.begin_object();
+                json.key("dimension"); json.value(a.dimension);
+                json.key("name"); json.value(a.name);
+                json.key("offset"); json.value(a.offset);
+                if (ranges) {
+                    auto it = ranges->find(a.name);
+                    if (it != ranges->end()) {
+                        json.key("rangeMin"); json.value(it->second.first);
+                        json.key("rangeMax"); json.value(it->second.second);
+                    }
+                }
+                json.end_object();
+            }
+            json.end_array();
+        }
+        if (!blocks.codec.empty()) {
+            json.key("blockSize"); json.value(blocks.block_size);
+            json.key("blocks"); json.begin_array();
+            for (uint32_t size : blocks.sizes) json.value(size);
+            json.end_array();
+            json.key("compression"); json.value(blocks.codec);
+        }
+        if (kv.second.encoding == UVF_CONSTANT_ENCODING) { json.key("constant"); write_constant_json(json, kv.second); }
+        json.key("dType"); json.value(kv.second.dType);
+        if (kv.second.decoded_length) { json.key("decodedLength"); json.value(kv.second.decoded_length); }
+        json.key("dimension"); json.value(kv.second.dimension);
+        if (!kv.second.encoding.empty()) { json.key("encoding"); json.value(kv.second.encoding); }
+        json.key("length"); json.value(kv.second.length);
+        json.key("name"); json.value(kv.first);
+        json.key("offset"); json.value(kv.second.offset);
+        if (!blocks.codec.empty()) { json.key("rawLength"); json.value(blocks.raw_length); }
+        if (ranges) {
+            auto it = ranges->find(kv.first);
+            if (it != ranges->end()) {
+                json.key("rangeMin"); json.value(it->second.first);
+                json.key("rangeMax"); json.value(it->second.second);
             }
         }
-        sections_ss << "}";
+        if (!kv.second.interleaved.empty()) { json.key("stride"); json.value(kv.second.dimension * sizeof(float)); }
+        json.end_object();
     }
-    sections_ss << "]";
+    json.end_array();
+}
+
+// Value range of each attribute, reported next to its section
+static map<string, std::pair<float, float>> mesh_attribute_ranges(const UVFMeshView& mesh) {
+    map<string, std::pair<float, float>> ranges;
+    for (const auto& a : mesh.attributes) {
+        if (a.count == 0 || a.name == "indices" || a.name == "position") continue;
+        auto mm = std::minmax_element(a.data, a.data + a.count);
+        ranges[a.name] = {*mm.first, *mm.second};
+    }
+    return ranges;
+}
 
-    // Determine second layer id same as original
-    string second_layer_id;
-    if (geom_kind == "slice") second_layer_id = "slices";
-    else if (geom_kind == "isosurface") second_layer_id = "isosurfaces";
-    else if (geom_kind == "streamline") second_layer_id = "streamlines"; // segmentation unlikely but keep path
-    else second_layer_id = "surfaces";
+string second_layer_id_for(const string& geom_kind) {
+    if (geom_kind == "slice") return "slices";
+    if (geom_kind == "isosurface") return "isosurfaces";
+    if (geom_kind == "streamline") return "streamlines"; // segmentation unlikely but keep path
+    return "surfaces";
+}
 
-    // Collect face ids for attributions (faces vs edges for streamline)
-    std::ostringstream manifest_ss;
-    manifest_ss << "[";
-    // root group
-    manifest_ss << "{\"attributions\":{\"members\":[\""<<second_layer_id<<"\"]},\"id\":\"root_group\",\"properties\":{\"transform\":[1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1],\"type\":0},\"type\":\"GeometryGroup\"},";
+// Write manifest JSON for a mesh and its face segments
+static void write_manifest_json(UVFJsonWriter& json, const UVFMeshView& mesh, const UVFOffsets& offsets,
+                                const map<string, std::pair<float, float>>& ranges, const string& bin_path) {
+    const string& geom_kind = mesh.geom_kind;
+    const vector<UVFFaceSegment>& faces = mesh.faces;
+    string second_layer_id = second_layer_id_for(geom_kind);
 
-    // Build faces list id array string for SolidGeometry attributions
-    std::ostringstream faceIdArray;
-    faceIdArray << "[";
-    for(size_t i=0;i<faces.size();++i){ if(i) faceIdArray << ","; faceIdArray << "\""<<faces[i].id<<"\""; }
-    faceIdArray << "]";
+    json.begin_array();
+    // root group
+    json.begin_object();
+    json.key("attributions"); json.begin_object();
+    json.key("members"); json.begin_array(); json.value(second_layer_id); json.end_array();
+    json.end_object();
+    json.key("id"); json.value("root_group");
+    json.key("properties"); json.begin_object();
+    json.key("transform"); json.raw_value(kIdentityTransform);
+    json.key("type"); json.value(0);
+    json.end_object();
+    json.key("type"); json.value("GeometryGroup");
+    json.end_object();
 
-    if (geom_kind == "streamline") {
-        // place ids under edges
-        manifest_ss << "{\"attributions\":{\"edges\":"<<faceIdArray.str()<<",\"faces\":[],\"vertices\":[]},";
+    // Face ids go under edges for streamlines, faces otherwise
+    auto write_face_ids = [&](bool wanted) {
+        json.begin_array();
+        if (wanted) {
+            for (const auto& f : faces) json.value(f.id);
+        }
+        json.end_array();
+    };
+    bool streamline = geom_kind == "streamline";
+    json.begin_object();
+    json.key("attributions"); json.begin_object();
+    json.key("edges");
+    if (streamline) {
+        write_face_ids(true);
     } else {
-        manifest_ss << "{\"attributions\":{\"edges\":[],\"faces\":"<<faceIdArray.str()<<",\"vertices\":[]},";
+        json.begin_array();
+        for (const auto& id : edge_node_ids(offsets, second_layer_id)) json.value(id);
+        json.end_array();
     }
-    manifest_ss << "\"id\":\""<<second_layer_id<<"\",\"properties\":{\"geomKind\":\""<<geom_kind<<"\"},\"resources\":{\"buffers\":{\"path\":\""<<bin_path<<"\",\"sections\":"<<sections_ss.str()<<",\"type\":\"buffers\"}},\"type\":\"SolidGeometry\"},";
+    json.key("faces"); write_face_ids(!streamline);
+    json.key("vertices"); json.begin_array(); json.end_array();
+    json.end_object();
+    json.key("id"); json.value(second_layer_id);
+    json.key("properties"); json.begin_object();
+    json.key("geomKind"); json.value(geom_kind);
+    json.end_object();
+    json.key("resources"); json.begin_object();
+    json.key("buffers"); json.begin_object();
+    json.key("path"); json.value(bin_path);
+    json.key("sections"); write_sections_json(json, offsets, &ranges);
+    json.key("type"); json.value("buffers");
+    json.end_object();
+    json.end_object();
+    json.key("type"); json.value("SolidGeometry");
+    json.end_object();
 
     // Each face segment
-    for(size_t i=0;i<faces.size();++i){
-        const auto& f = faces[i];
-        manifest_ss << "{\"attributions\":{\"packedParentId\":\""<<second_layer_id<<"\"},\"id\":\""<<f.id<<"\",\"properties\":{\"alpha\":1,\"bufferLocations\":{\"indices\":[{\"bufNum\":0,\"endIndex\":"<<f.endIndex<<",\"startIndex\":"<<f.startIndex<<"}]},\"color\":16777215,\"geomKind\":\""<<geom_kind<<"\"},\"type\":\"Face\"}";
-        if(i+1<faces.size()) manifest_ss << ",";
+    for (const auto& f : faces) {
+        json.begin_object();
+        json.key("attributions"); json.begin_object();
+        json.key("packedParentId"); json.value(second_layer_id);
+        json.end_object();
+        json.key("id"); json.value(f.id);
+        json.key("properties"); json.begin_object();
+        json.key("alpha"); json.value(1);
+        json.key("bufferLocations"); json.begin_object();
+        json.key("indices"); json.begin_array();
+        json.begin_object();
+        json.key("bufNum"); json.value(0);
+        json.key("endIndex"); json.value(f.endIndex);
+        json.key("startIndex"); json.value(f.startIndex);
+        json.end_object();
+        json.end_array();
+        json.end_object();
+        json.key("color"); json.value(16777215);
+        json.key("geomKind"); json.value(geom_kind);
+        json.end_object();
+        json.key("type"); json.value("Face");
+        json.end_object();
     }
-    manifest_ss << "]";
+    write_edge_nodes_json(json, offsets, second_layer_id, &geom_kind);
+    json.end_array();
+}
+
+// Binary manifest with the same nodes as write_manifest_json
+static string build_binary_manifest(const UVFMeshView& mesh, const UVFOffsets& offsets,
+                                    const map<string, std::pair<float, float>>& ranges, const string& bin_path) {
+    string second_layer_id = second_layer_id_for(mesh.geom_kind);
+    UVFBinaryManifestBuilder bm;
+    bm.add_group("root_group", true);
+    bm.add_group_member(second_layer_id);
+    bm.add_solid(second_layer_id, &mesh.geom_kind, &bin_path);
+    bm.add_solid_sections(offsets, &ranges);
+    for (const auto& f : mesh.faces) {
+        if (mesh.geom_kind == "streamline") bm.add_solid_edge(f.id);
+        else bm.add_solid_face(f.id);
+    }
+    for (const auto& id : edge_node_ids(offsets, second_layer_id)) bm.add_solid_edge(id);
+    for (const auto& f : mesh.faces) {
+        bm.add_face(f.id, second_layer_id, 16777215, 1.0f, f.startIndex, f.endIndex);
+    }
+    add_binary_edge_nodes(bm, offsets, second_layer_id);
+    return bm.serialize();
+}
 
+// New manifest creator accepting geometry kind
+bool create_manifest(const vector<float>& vertices, const vector<uint32_t>& indices, const map<string, vector<float>>& scalar_data, const UVFOffsets& offsets, const string& bin_path, const string& name, const string& output_dir, string& manifest_path, const string& geom_kind) {
     manifest_path = output_dir + "/manifest.json";
     std::ofstream ofs(manifest_path);
-    if(!ofs) return false;
-    ofs << manifest_ss.str();
-    ofs.close();
-    return true;
+    if (!ofs) return false;
+    UVFMeshView mesh = make_mesh_view(vertices, indices, scalar_data);
+    mesh.faces.push_back({name, 0, indices.size()});
+    mesh.geom_kind = geom_kind;
+    UVFJsonWriter json(&ofs);
+    write_manifest_json(json, mesh, offsets, mesh_attribute_ranges(mesh), bin_path);
+    return json.flush();
 }
 
 // Backwards compatibility wrapper (defaults to surface)
@@ -454,15 +1073,52 @@ bool extract_geometry_data(vtkPolyData* polydata, vector<float>& vertices, vecto
     return true;
 }
 
+uint64_t count_triangles(vtkPolyData* polydata) {
+    if (!polydata) return 0;
+    uint64_t triangles = 0;
+    auto idList = vtkSmartPointer<vtkIdList>::New();
+    if (auto polys = polydata->GetPolys()) {
+        polys->InitTraversal();
+        while (polys->GetNextCell(idList)) {
+            if (idList->GetNumberOfIds() >= 3) triangles += idList->GetNumberOfIds() - 2;
+        }
+    }
+    if (triangles == 0 && polydata->GetLines()) {
+        auto lines = polydata->GetLines();
+        lines->InitTraversal();
+        while (lines->GetNextCell(idList)) {
+            if (idList->GetNumberOfIds() >= 2) triangles += idList->GetNumberOfIds() - 1;
+        }
+    }
+    return triangles;
+}
+
+static bool write_uvf_mesh(const UVFMeshView& mesh, UVFOutput& out, const UVFOptions& options);
+
 // 高级 UVF 生成主流程
 bool generate_uvf(vtkPolyData* poly, const char* uvf_dir) {
+    return generate_uvf(poly, uvf_dir, UVFOptions());
+}
+
+bool generate_uvf(vtkPolyData* poly, const char* uvf_dir, const UVFOptions& options) {
+    if (!poly || !uvf_dir) return false;
+    UVFDirectoryOutput out(uvf_dir);
+    if (!generate_uvf(poly, out, options)) return false;
+    return !options.container || pack_uvf_directory(uvf_dir, options);
+}
+
+bool generate_uvf(vtkPolyData* poly, UVFOutput& out, const UVFOptions& options) {
     if (!poly) return false;
+    UVFTraceSpan span(options.trace, "generate_uvf", "convert");
     vector<float> vertices;
     vector<uint32_t> indices;
     map<string, vector<float>> scalar_data;
     if(!poly->GetPoints()) return false;
+    UVFProgressReporter progress(options);
+    const uint64_t nCells = static_cast<uint64_t>(poly->GetNumberOfPolys());
 
     // 提取数据
+    UVFStageTimer extractTimer(options, "extract");
     auto pts = poly->GetPoints();
     vtkIdType nPts = pts->GetNumberOfPoints();
     vertices.resize(nPts * 3);
@@ -489,13 +1145,22 @@ bool generate_uvf(vtkPolyData* poly, const char* uvf_dir) {
             }
         }
     }
+    extractTimer.add_items(static_cast<uint64_t>(nPts));
+    extractTimer.stop();
+
+    UVFStageTimer triangulateTimer(options, "triangulate");
     std::map<int, std::vector<uint32_t>> faceIndexBuckets; // faceIdx -> local indices
     bool useSegmentation = faceIndexArr != nullptr;
     auto polys = poly->GetPolys();
     auto idList = vtkSmartPointer<vtkIdList>::New();
     polys->InitTraversal();
     vtkIdType cellId = 0;
+    progress.report("extract", 0, 0, 0, nCells);
     while (polys->GetNextCell(idList)) {
+        if ((cellId & 0xFFFF) == 0 && cellId > 0) {
+            if (progress.cancelled()) return false;
+            progress.report("extract", 0, 0, cellId, nCells);
+        }
         if (idList->GetNumberOfIds() < 3) { cellId++; continue; }
         int fIdx = 0;
         if(useSegmentation && cellId < faceIndexArr->GetNumberOfTuples()) {
@@ -530,9 +1195,18 @@ bool generate_uvf(vtkPolyData* poly, const char* uvf_dir) {
         }
     }
 
+    {
+        size_t produced = indices.size();
+        for(auto& kv: faceIndexBuckets) produced += kv.second.size();
+        triangulateTimer.add_items(produced / 3);
+        triangulateTimer.stop();
+    }
+
     // If segmentation present, flatten buckets into indices and build segment metadata
     std::vector<UVFFaceSegment> segments;
     if(useSegmentation && !faceIndexBuckets.empty()){
+        UVFStageTimer segmentTimer(options, "segment");
+        segmentTimer.add_items(faceIndexBuckets.size());
         indices.clear();
         indices.reserve([&](){ size_t total=0; for(auto& kv: faceIndexBuckets) total += kv.second.size(); return total; }());
         std::vector<int> sortedKeys; sortedKeys.reserve(faceIndexBuckets.size());
@@ -554,6 +1228,7 @@ bool generate_uvf(vtkPolyData* poly, const char* uvf_dir) {
         if(segments.empty()) useSegmentation = false; // fallback
     }
 
+    UVFStageTimer scalarTimer(options, "extract");
     auto pd = poly->GetPointData();
     for (int i = 0; i < pd->GetNumberOfArrays(); ++i) {
         auto arr = pd->GetArray(i);
@@ -573,24 +1248,164 @@ bool generate_uvf(vtkPolyData* poly, const char* uvf_dir) {
         scalar_data[name] = std::move(data);
     }
 
-    // 目录结构
-    string out_dir = string(uvf_dir);
-    string resources_dir = out_dir + "/";
-    make_dirs(out_dir);
-    make_dirs(resources_dir);
-    // generate random bin file name
-    std::string rand8 = make_random_token(8);
-    string bin_filename = rand8 + ".bin";
-    string bin_path = resources_dir + "/" + bin_filename;
-    UVFOffsets offsets;
-    if (!write_binary_data(vertices, indices, scalar_data, bin_path, offsets)) return false;
-    string manifest_path;
+    scalarTimer.stop();
+    if (progress.cancelled()) return false;
+    progress.report("extract", 0, 0, nCells, nCells);
+    if (options.stats) options.stats->add_counts(static_cast<uint64_t>(nPts), indices.size() / 3, 0);
+
     // Determine geometry kind from original polydata & data
-    string geomKind = classify_geometry_kind(poly, vertices, indices, scalar_data, "uvf");
-    if(useSegmentation && !segments.empty()) {
-        if(!create_manifest_with_faces(vertices, indices, scalar_data, offsets, bin_filename, "uvf", out_dir, manifest_path, geomKind, segments)) return false;
+    UVFMeshView mesh = make_mesh_view(vertices, indices, scalar_data);
+    mesh.geom_kind = classify_geometry_kind(poly, vertices, indices, scalar_data, "uvf");
+    if(useSegmentation && !segments.empty()) mesh.faces = std::move(segments);
+    else mesh.faces.push_back({"uvf", 0, indices.size()});
+    return write_uvf_mesh(mesh, out, options);
+}
+
+bool generate_uvf(const UVFMeshView& mesh, const char* uvf_dir, const UVFOptions& options) {
+    if (!uvf_dir) return false;
+    UVFDirectoryOutput out(uvf_dir);
+    if (!generate_uvf(mesh, out, options)) return false;
+    return !options.container || pack_uvf_directory(uvf_dir, options);
+}
+
+bool generate_uvf(const UVFMeshView& input, UVFOutput& out, const UVFOptions& options) {
+    UVFTraceSpan span(options.trace, "generate_uvf", "convert");
+    string error;
+    if (!validate_mesh_view(input, error)) {
+        std::cerr << "Invalid mesh: " << error << std::endl;
+        return false;
+    }
+    UVFMeshView mesh = input;
+    if (mesh.faces.empty()) mesh.faces.push_back({"uvf", 0, mesh.index_count});
+    if (mesh.geom_kind.empty()) mesh.geom_kind = classify_mesh_kind(mesh);
+    if (options.stats) options.stats->add_counts(mesh.vertex_count, mesh.index_count / 3, 0);
+    return write_uvf_mesh(mesh, out, options);
+}
+
+// Per-triangle position of its face in mesh.faces, in the narrowest unsigned
+// type leaving the maximum free for triangles outside every face
+static UVFSectionSource face_id_section(const UVFMeshView& mesh, std::list<string>& storage) {
+    const size_t tri_count = mesh.index_count / 3;
+    auto fill = [&](auto none, const char* dType) {
+        using T = decltype(none);
+        string& bytes = storage.emplace_back(tri_count * sizeof(T), '\0');
+        T* ids = reinterpret_cast<T*>(&bytes[0]);
+        std::fill(ids, ids + tri_count, none);
+        for (size_t f = 0; f < mesh.faces.size(); ++f) {
+            size_t end = std::min(mesh.faces[f].endIndex / 3, tri_count);
+            for (size_t t = mesh.faces[f].startIndex / 3; t < end; ++t) ids[t] = static_cast<T>(f);
+        }
+        return make_section_source("faceId", bytes.data(), bytes.size(), dType, 1);
+    };
+    if (mesh.faces.size() < 0xFF) return fill(uint8_t(0xFF), "uint8");
+    if (mesh.faces.size() < 0xFFFF) return fill(uint16_t(0xFFFF), "uint16");
+    return fill(uint32_t(0xFFFFFFFF), "uint32");
+}
+
+// Write the bin and manifest of a complete mesh view (faces and kind resolved)
+static bool write_uvf_mesh(const UVFMeshView& input, UVFOutput& out, const UVFOptions& options) {
+    UVFProgressReporter progress(options);
+    if (progress.cancelled()) return false;
+    UVFReorderedMesh reordered;
+    const UVFMeshView& mesh = reordered_mesh(input, options, reordered);
+
+    // 输出 bin 与 manifest
+    string bin_filename;
+    UVFOffsets offsets;
+    // Encoded/compressed sections are built up front: outputs need the entry size before writing
+    std::list<string> storage;
+    vector<UVFSectionSource> sources = mesh_section_sources(mesh, options, storage);
+    // Last in the bin: its 1- or 2-byte elements never misalign the sections after it
+    if (options.face_ids && mesh.index_count > 0) {
+        UVFStageTimer timer(options, "segment");
+        sources.push_back(face_id_section(mesh, storage));
+        timer.add_bytes(sources.back().bytes);
+        timer.add_items(mesh.faces.size());
+    }
+    UVFPreparedSections prepared;
+    if (!prepare_sections(sources, true, options, prepared)) return false;
+    if (progress.cancelled()) return false;
+    size_t bin_size = prepared.stored_size();
+    UVFStageTimer writeTimer(options, "write");
+    if (options.content_hash_names) {
+        // Write under a temporary name, then rename to the digest of the bytes actually written
+        string tmp_name = make_random_token(8) + ".bin.tmp";
+        UVFHasher hasher;
+        std::ostream* os = out.open_entry(tmp_name, bin_size);
+        if (!os) return false;
+        bool ok = write_prepared_sections(prepared, *os, offsets, &hasher, &progress);
+        if (!out.close_entry() || !ok) {
+            out.discard_entry(tmp_name);
+            return false;
+        }
+        bin_filename = hasher.hex_digest() + ".bin";
+        if (!out.rename_entry(tmp_name, bin_filename)) {
+            out.discard_entry(tmp_name);
+            return false;
+        }
     } else {
-        if (!create_manifest(vertices, indices, scalar_data, offsets, bin_filename, "uvf", out_dir, manifest_path, geomKind)) return false;
+        // generate random bin file name
+        std::string rand8 = make_random_token(8);
+        bin_filename = rand8 + ".bin";
+        std::ostream* os = out.open_entry(bin_filename, bin_size);
+        if (!os) return false;
+        bool ok = write_prepared_sections(prepared, *os, offsets, nullptr, &progress);
+        if (!out.close_entry() || !ok) {
+            out.discard_entry(bin_filename);
+            return false;
+        }
+    }
+    writeTimer.add_bytes(bin_size);
+    writeTimer.add_items(1);
+    writeTimer.stop();
+    // Last checkpoint: cancelling before the manifest leaves no output behind
+    if (progress.cancelled()) {
+        out.discard_entry(bin_filename);
+        return false;
+    }
+    progress.report("manifest", bin_size, bin_size, 0, 0);
+    UVFStageTimer manifestTimer(options, "manifest");
+    // Outputs take the entry size up front: a counting pass sizes the manifest,
+    // the second pass streams it without holding the whole document in memory
+    map<string, std::pair<float, float>> ranges = mesh_attribute_ranges(mesh);
+    uint64_t manifest_size = 0;
+    {
+        UVFJsonWriter sizer(nullptr);
+        write_manifest_json(sizer, mesh, offsets, ranges, bin_filename);
+        manifest_size = sizer.bytes_written();
+    }
+    manifestTimer.add_bytes(manifest_size);
+    manifestTimer.add_items(1);
+    // The binary twin goes first so manifest.json stays the last entry written
+    uint64_t binary_size = 0;
+    if (options.binary_manifest) {
+        string binary = build_binary_manifest(mesh, offsets, ranges, bin_filename);
+        if (!out.write_entry("manifest.uvfm", binary)) {
+            out.discard_entry(bin_filename);
+            return false;
+        }
+        binary_size = binary.size();
+        manifestTimer.add_bytes(binary_size);
+    }
+    // Without manifest.json the other entries are unreachable: drop them too
+    auto discard_outputs = [&]() {
+        if (options.binary_manifest) out.discard_entry("manifest.uvfm");
+        out.discard_entry(bin_filename);
+        return false;
+    };
+    std::ostream* mos = out.open_entry("manifest.json", manifest_size);
+    if (!mos) return discard_outputs();
+    bool manifest_ok;
+    {
+        UVFJsonWriter json(mos);
+        write_manifest_json(json, mesh, offsets, ranges, bin_filename);
+        manifest_ok = json.flush();
+    }
+    if (!out.close_entry() || !manifest_ok) {
+        out.discard_entry("manifest.json");
+        return discard_outputs();
     }
+    manifestTimer.stop();
+    if (options.stats) options.stats->add_bytes_written(bin_size + manifest_size + binary_size);
     return true;
 }
@@ -1,9 +1,14 @@
 #pragma once
 #include <vtkSmartPointer.h>
 #include <vtkPolyData.h>
+#include "uvf_options.h"
+#include "section_codec.h"
 #include <string>
 #include <vector>
 #include <map>
+#include <iosfwd>
+#include <list>
+#include <utility>
 
 using std::vector;
 using std::string;
@@ -19,26 +24,124 @@ struct DataArrayInfo {
     string dType;       // Data type
 };
 
+// Name of the interleaved vertex section (options.vertex_layout)
+constexpr const char* UVF_INTERLEAVED_SECTION = "vertices";
+
+// One attribute of an interleaved section: `dimension` float32 values at byte
+// `offset` of every element (the element stride is the section's dimension * 4)
+struct UVFInterleavedAttribute {
+    string name;
+    uint32_t offset = 0;
+    int dimension = 1;
+};
+
 // UVF offset structure for binary data
 struct UVFOffsets {
     struct Info {
-        size_t offset;
-        size_t length;
+        size_t offset = 0;
+        size_t length = 0;      // bytes stored in the bin (compressed size for compressed sections)
         string dType;
-        int dimension;
+        int dimension = 1;
+        UVFSectionBlocks blocks; // block layout when the section is compressed
+        string encoding;         // how the section bytes are encoded (mesh_codec.h, time series, constant); empty = plain
+        size_t decoded_length = 0; // bytes after decoding, when the encoding changes the size
+        uint32_t constant_bits = 0; // element bit pattern of a "constant" section (nothing stored)
+        vector<UVFInterleavedAttribute> interleaved; // attributes of an interleaved section, by offset
     };
     map<string, Info> fields;
 };
 
+// Face segmentation support (FaceIndex + FaceIdMapping)
+struct UVFFaceSegment {
+    std::string id;        // face id (mapped name or generated)
+    size_t startIndex = 0; // index into global indices array (uint32 element index, inclusive)
+    size_t endIndex = 0;   // exclusive end
+};
+
+// Named per-vertex float array borrowed from the caller
+struct UVFAttributeView {
+    string name;
+    const float* data = nullptr;
+    size_t count = 0;       // number of floats
+    int components = 1;     // floats per vertex
+};
+
+// Mesh arrays borrowed from the caller; nothing is copied before writing
+struct UVFMeshView {
+    const float* positions = nullptr;   // xyz per vertex
+    size_t vertex_count = 0;
+    const uint32_t* indices = nullptr;  // triangles; line segments as (a,b,b)
+    size_t index_count = 0;
+    vector<UVFAttributeView> attributes;
+    vector<UVFFaceSegment> faces;       // empty: one face covering all indices
+    string geom_kind;                   // empty: classify from the data
+};
+
 // Parse either .vtp (XML) or legacy .vtk polydata/unstructured grid into vtkPolyData
 vtkSmartPointer<vtkPolyData> parse_vtp_file(const char* path);
 
+// As above, recording a "parse" stage (input bytes, one file) into the stats and
+// trace hooks of options
+vtkSmartPointer<vtkPolyData> parse_vtp_file(const char* path, const UVFOptions& options);
+
+// Parse an in-memory VTP, legacy VTK or STL image; format is "vtp", "vtk" or "stl"
+vtkSmartPointer<vtkPolyData> parse_polydata_buffer(const void* data, size_t size, const char* format);
+
 // Generate basic UVF format
 bool generate_uvf(vtkPolyData* poly, const char* uvf_dir);
 
+// Generate UVF format with explicit conversion options
+bool generate_uvf(vtkPolyData* poly, const char* uvf_dir, const UVFOptions& options);
+
+class UVFOutput;
+
+// Generate UVF format into an output sink (directory, memory, ...)
+bool generate_uvf(vtkPolyData* poly, UVFOutput& out, const UVFOptions& options);
+
+// Generate UVF from raw arrays, bypassing VTK
+bool generate_uvf(const UVFMeshView& mesh, UVFOutput& out, const UVFOptions& options);
+bool generate_uvf(const UVFMeshView& mesh, const char* uvf_dir, const UVFOptions& options);
+
+// Check a mesh view for out-of-range indices, attribute sizes and face ranges
+bool validate_mesh_view(const UVFMeshView& mesh, string& error);
+
 // Generate UVF format with DataArray information (enhanced version)
 bool generate_uvf(vtkPolyData* poly, const char* uvf_dir, vector<DataArrayInfo>* array_info);
 
+// Classify geometry kind (surface, slice, isosurface, streamline) from data heuristics
+string classify_geometry_kind(
+    vtkPolyData* poly,
+    const vector<float>& vertices,
+    const vector<uint32_t>& indices,
+    const map<string, vector<float>>& scalar_data,
+    const string& baseName
+);
+
+// Id of the SolidGeometry layer under the root group for a geometry kind
+// ("slices", "isosurfaces", "streamlines", else "surfaces")
+string second_layer_id_for(const string& geom_kind);
+
+class UVFJsonWriter;
+
+// Write the "sections" array of a buffers resource (shared by all manifest
+// generators); ranges adds rangeMin/rangeMax for the fields and interleaved
+// attributes it lists
+void write_sections_json(
+    UVFJsonWriter& json,
+    const UVFOffsets& offsets,
+    const map<string, std::pair<float, float>>* ranges = nullptr
+);
+
+class UVFBinaryManifestBuilder;
+
+// Ids of the Edge nodes for the edge sections of offsets (mesh_edges.h),
+// "<parent>_<section name>", for the SolidGeometry's "edges" attribution
+vector<string> edge_node_ids(const UVFOffsets& offsets, const string& parent);
+
+// Write those Edge nodes (geom_kind may be null), or add them to a binary manifest
+void write_edge_nodes_json(UVFJsonWriter& json, const UVFOffsets& offsets, const string& parent, const string* geom_kind);
+void add_binary_edge_nodes(UVFBinaryManifestBuilder& bm, const UVFOffsets& offsets, const string& parent);
+
 // Extract geometry data from vtkPolyData
 bool extract_geometry_data(
     vtkPolyData* polydata, 
@@ -47,11 +150,88 @@ bool extract_geometry_data(
     map<string, vector<float>>& scalar_data
 );
 
-// Write binary data and return offset information
+// Triangles extract_geometry_data produces for polydata (fan-triangulated
+// polygons, or one (a,b,b) segment per line edge when there are none)
+uint64_t count_triangles(vtkPolyData* polydata);
+
+// Write binary data and return offset information. The sections are built,
+// encoded and compressed per options (mesh_section_sources, prepare_sections),
+// after reordering the mesh when options.reorder is set; options.cancel stops
+// the write between slices, removing the partial bin.
 bool write_binary_data(
     const vector<float>& vertices, 
     const vector<uint32_t>& indices, 
     const map<string, vector<float>>& scalar_data, 
     const string& bin_path, 
-    UVFOffsets& offsets
+    UVFOffsets& offsets,
+    const UVFOptions& options = UVFOptions()
 );
+
+class UVFHasher;
+class UVFProgressReporter;
+
+// Bytes the sections of offsets occupy in their bin
+size_t stored_sections_size(const UVFOffsets& offsets);
+
+// 4-byte elements of a section once decompressed and decoded (its stored
+// length differs for compressed, encoded and constant sections)
+uint64_t section_element_count(const UVFOffsets::Info& info);
+
+// Encoding of an elided section whose elements all share one bit pattern
+constexpr const char* UVF_CONSTANT_ENCODING = "constant";
+
+// One section to be written: bytes borrowed from the caller
+struct UVFSectionSource {
+    string name;
+    const void* data = nullptr;
+    size_t bytes = 0;
+    string dType;
+    int dimension = 1;
+    string encoding;           // encoding of data (set by the caller or prepare_sections)
+    size_t decoded_length = 0;
+    uint32_t constant_bits = 0;
+    int alias_of = -1;         // index of an earlier, byte-identical section
+    vector<UVFInterleavedAttribute> interleaved;
+};
+
+// A plain section of the given bytes (no encoding, alias or interleaving)
+UVFSectionSource make_section_source(const string& name, const void* data, size_t bytes, const string& dType, int dimension);
+
+// Sections ready to be written: the sources (pointing into storage where a
+// mesh codec re-encoded them) and, when compressing, their blocks
+struct UVFPreparedSections {
+    vector<UVFSectionSource> sources;
+    std::list<string> storage;
+    bool compressed = false;
+    vector<UVFCompressedSection> packed; // one per source when compressed
+    // Bytes the sections will occupy in the bin
+    size_t stored_size() const;
+};
+
+// Sections of a mesh view in write order: indices, position, then attributes by name
+vector<UVFSectionSource> mesh_section_sources(const UVFMeshView& mesh);
+
+// As above, adding the sections options generate: with options.normals a
+// "normal" section after "position" (mesh_normals.h; skipped when the mesh
+// has a "normal" attribute), with options.bvh "bvhNodes" and "bvhTriangles"
+// (mesh_bvh.h) and with options.feature_edges the edge line-index sections
+// (mesh_edges.h) at the end. With options.vertex_layout the interleaved
+// "vertices" section (position first, then the selected plain float32
+// per-vertex sections) takes the place of "position", and "interleaved"
+// drops the separate copies. Generated bytes live in storage.
+vector<UVFSectionSource> mesh_section_sources(const UVFMeshView& mesh, const UVFOptions& options, std::list<string>& storage);
+
+// Apply options to sections about to be written: with options.elide_sections
+// constant sections become manifest-only and exact duplicates alias the first
+// copy; with mesh_geometry and options.mesh_codecs the "indices", "position"
+// and "vertices" sections are encoded (mesh_codec.h); then every stored section is
+// block-compressed per options.compression. Sources are borrowed, not copied,
+// unless a codec rewrites them.
+bool prepare_sections(const vector<UVFSectionSource>& sources, bool mesh_geometry, const UVFOptions& options,
+                      UVFPreparedSections& prepared);
+
+// Write prepared sections back to back, recording offsets and feeding every
+// written byte into hasher (may be null). Reports "write" progress and stops
+// early (returning false) when cancelled.
+bool write_prepared_sections(const UVFPreparedSections& prepared, std::ostream& os, UVFOffsets& offsets,
+                             UVFHasher* hasher = nullptr, UVFProgressReporter* progress = nullptr);
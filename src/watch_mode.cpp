@@ -0,0 +1,184 @@
+#include "watch_mode.h"
+#include "multi_file_parser.h"
+#include "file_discovery.h"
+#include "conversion_cache.h"
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <map>
+#include <set>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+
+// Bin labels recorded by the last (incremental) conversion into uvf_dir
+static std::set<std::string> converted_labels(const std::string& uvf_dir) {
+    std::set<std::string> labels;
+    ConversionCache cache;
+    if (cache.load(conversion_cache_path(uvf_dir))) {
+        for (const auto& kv : cache.entries()) labels.insert(kv.second.label);
+    }
+    return labels;
+}
+
+static void remove_bins(const std::string& uvf_dir, const std::set<std::string>& labels) {
+    for (const auto& label : labels) std::remove((uvf_dir + "/" + label + ".bin").c_str());
+}
+
+bool watch_directory(const char* input_dir, const char* uvf_dir, const UVFOptions& options,
+                     const std::atomic<bool>* stop, int debounce_ms) {
+    UVFOptions opts = options;
+    opts.incremental = true;
+
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "inotify_init1 failed" << std::endl;
+        return false;
+    }
+    // Watch before the initial conversion so writes racing with it are not lost.
+    // inotify is not recursive: every subdirectory gets its own watch.
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE;
+    std::map<int, std::string> watched_dirs; // watch descriptor -> path relative to input_dir
+    auto add_watch = [&](const std::string& rel) {
+        std::string full = rel.empty() ? std::string(input_dir) : std::string(input_dir) + "/" + rel;
+        int wd = inotify_add_watch(fd, full.c_str(), mask);
+        if (wd >= 0) watched_dirs[wd] = rel;
+        if (!opts.recursive) return wd >= 0;
+        std::error_code ec;
+        for (std::filesystem::recursive_directory_iterator it(full, ec), end; !ec && it != end; it.increment(ec)) {
+            if (!it->is_directory() || it->is_symlink()) continue;
+            int sub = inotify_add_watch(fd, it->path().c_str(), mask);
+            if (sub >= 0) watched_dirs[sub] = std::filesystem::relative(it->path(), input_dir).generic_string();
+        }
+        return wd >= 0;
+    };
+    if (!add_watch("")) {
+        std::cerr << "Cannot watch directory: " << input_dir << std::endl;
+        close(fd);
+        return false;
+    }
+
+    // Every conversion rescans the whole tree; bins of inputs that are gone
+    // (no longer in the cache) are removed once the new manifest is in place.
+    // full drops the cache first, so every input is reconverted.
+    const std::string out_dir(uvf_dir);
+    auto convert = [&](bool full) {
+        std::set<std::string> before = converted_labels(out_dir);
+        if (full) std::remove(conversion_cache_path(out_dir).c_str());
+        if (!process_directory_structure(input_dir, uvf_dir, opts)) return false;
+        std::set<std::string> after = converted_labels(out_dir);
+        std::set<std::string> stale;
+        std::set_difference(before.begin(), before.end(), after.begin(), after.end(), std::inserter(stale, stale.end()));
+        remove_bins(out_dir, stale);
+        return true;
+    };
+
+    if (!convert(false)) {
+        std::cerr << "Initial conversion failed" << std::endl;
+        close(fd);
+        return false;
+    }
+    std::cout << "Watching " << input_dir << " (Ctrl+C to stop)" << std::endl;
+
+    using clock = std::chrono::steady_clock;
+    struct Pending { clock::time_point last_event; std::uintmax_t last_size; };
+    std::map<std::string, Pending> pending; // file name -> debounce state
+    bool overflowed = false;                // events were dropped: reconvert everything
+    clock::time_point overflow_event;
+    alignas(struct inotify_event) char buf[16384];
+
+    while (!stop || !stop->load()) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, 100);
+        auto now = clock::now();
+        if (ready > 0) {
+            ssize_t len;
+            while ((len = read(fd, buf, sizeof(buf))) > 0) {
+                for (char* p = buf; p < buf + len;) {
+                    auto* ev = reinterpret_cast<struct inotify_event*>(p);
+                    p += sizeof(struct inotify_event) + ev->len;
+                    if (ev->mask & IN_Q_OVERFLOW) {
+                        // The queue overflowed: changes (and new subdirectories) may
+                        // have been missed, so rewatch the tree and redo it all
+                        overflowed = true;
+                        overflow_event = now;
+                        add_watch("");
+                        continue;
+                    }
+                    if (ev->len == 0) continue;
+                    auto dir_it = watched_dirs.find(ev->wd);
+                    if (dir_it == watched_dirs.end()) continue;
+                    std::string name = dir_it->second.empty() ? std::string(ev->name) : dir_it->second + "/" + ev->name;
+                    if (ev->mask & IN_ISDIR) {
+                        // New subdirectory (possibly already populated): watch it and rescan
+                        if (opts.recursive && (ev->mask & (IN_CREATE | IN_MOVED_TO))) {
+                            add_watch(name);
+                            auto& entry = pending[name];
+                            entry.last_event = now;
+                            entry.last_size = static_cast<std::uintmax_t>(-1);
+                        }
+                        continue;
+                    }
+                    if (!is_supported_input(name)) continue;
+                    auto& entry = pending[name];
+                    entry.last_event = now;
+                    entry.last_size = static_cast<std::uintmax_t>(-1);
+                }
+            }
+        }
+        if (pending.empty() && !overflowed) continue;
+
+        // Settled: quiet for the debounce window and size stable since the last check
+        bool settled = !overflowed || now - overflow_event >= std::chrono::milliseconds(debounce_ms);
+        for (auto& kv : pending) {
+            std::error_code ec;
+            auto size = std::filesystem::file_size(std::filesystem::path(input_dir) / kv.first, ec);
+            if (ec) size = 0; // removed; settles once quiet
+            if (now - kv.second.last_event < std::chrono::milliseconds(debounce_ms) || size != kv.second.last_size) {
+                settled = false;
+            }
+            kv.second.last_size = size;
+        }
+        if (!settled) continue;
+
+        if (overflowed) std::cout << "Event queue overflowed, reconverting everything" << std::endl;
+        else std::cout << "Change detected in " << pending.size() << " file(s), reconverting" << std::endl;
+        bool full = overflowed;
+        pending.clear();
+        overflowed = false;
+        if (convert(full)) continue;
+        std::vector<DiscoveredFile> remaining;
+        if (discover_input_files(input_dir, opts, remaining) && remaining.empty()) {
+            // Every input is gone: so are its outputs
+            std::cout << "No inputs left, removing outputs" << std::endl;
+            remove_bins(out_dir, converted_labels(out_dir));
+            for (const char* name : {"/manifest.json", "/manifest.uvfm"}) std::remove((out_dir + name).c_str());
+            std::remove(conversion_cache_path(out_dir).c_str());
+        } else {
+            std::cerr << "Reconversion failed; keeping previous manifest" << std::endl;
+        }
+    }
+    close(fd);
+    return true;
+}
+
+#else
+
+bool watch_directory(const char* input_dir, const char* uvf_dir, const UVFOptions& options,
+                     const std::atomic<bool>* stop, int debounce_ms) {
+    (void)input_dir; (void)uvf_dir; (void)options; (void)stop; (void)debounce_ms;
+    std::cerr << "Watch mode requires inotify (Linux)" << std::endl;
+    return false;
+}
+
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "uvf_options.h"
+#include <atomic>
+
+// Convert input_dir once, then keep watching it (inotify) and reconvert whenever
+// VTK/STL inputs are created, modified, moved in or removed. Bursts of events are
+// debounced until the touched files stop changing for debounce_ms; only changed
+// inputs are reconverted (incremental mode is forced on) and manifest.json is
+// replaced atomically. Bins of removed inputs are deleted, and when the event
+// queue overflows every input is reconverted. Returns when *stop becomes true,
+// or false when watching is unavailable (non-Linux builds) or the initial
+// conversion fails.
+bool watch_directory(
+    const char* input_dir,
+    const char* uvf_dir,
+    const UVFOptions& options,
+    const std::atomic<bool>* stop,
+    int debounce_ms = 500
+);
@@ -0,0 +1,457 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <filesystem>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include "uvf_c_api.h"
+#include "vtp_to_uvf.h"
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkPointData.h>
+#include <vtkFloatArray.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+bool file_exists(const std::string& p){ return fs::exists(p); }
+
+std::string read_file(const std::string& path){
+    std::ifstream ifs(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+}
+
+// Counts live blocks so tests can check ownership
+struct CountingAllocator {
+    int live = 0;
+    int calls = 0;
+    static void* fn(void* user, void* ptr, size_t size){
+        auto* self = static_cast<CountingAllocator*>(user);
+        self->calls++;
+        if(size == 0){ if(ptr){ self->live--; std::free(ptr); } return nullptr; }
+        self->live++;
+        return std::malloc(size);
+    }
+};
+}
+
+// Contexts converting on separate threads keep their own statistics and errors
+static bool test_concurrent_contexts() {
+    const std::string slice = std::string(TEST_DATA_DIR) + "/slice_sample.vtp";
+    const std::string line = std::string(TEST_DATA_DIR) + "/line_sample.vtp";
+    const int kThreads = 8;
+    std::vector<uvf_context*> contexts(kThreads);
+    std::vector<int> results(kThreads, 0);
+    std::vector<std::thread> workers;
+
+    for(int i=0;i<kThreads;++i){
+        contexts[i] = uvf_context_create();
+        if(!contexts[i]) return false;
+    }
+    for(int i=0;i<kThreads;++i){
+        workers.emplace_back([&, i]{
+            std::string out = "test_out_ctx_" + std::to_string(i);
+            fs::remove_all(out);
+            if(i % 4 == 3){
+                // Failing conversions must not disturb the others
+                results[i] = uvf_context_generate(contexts[i], "no_such_file.vtp", out.c_str());
+            } else {
+                const std::string& in = (i % 2) ? line : slice;
+                for(int r=0;r<5 && (r==0 || results[i]);++r)
+                    results[i] = uvf_context_generate(contexts[i], in.c_str(), out.c_str());
+            }
+        });
+    }
+    for(auto& t : workers) t.join();
+
+    long long slicePoints = -1, linePoints = -1;
+    bool ok = true;
+    for(int i=0;i<kThreads;++i){
+        uvf_context* ctx = contexts[i];
+        std::string out = "test_out_ctx_" + std::to_string(i);
+        if(i % 4 == 3){
+            if(results[i] || std::strlen(uvf_context_get_last_error(ctx))==0) { std::cerr << "context " << i << " should have failed" << std::endl; ok = false; }
+        } else {
+            if(!results[i] || uvf_context_get_last_error(ctx)[0]!='\0') { std::cerr << "context " << i << ": " << uvf_context_get_last_error(ctx) << std::endl; ok = false; }
+            if(!file_exists(out + "/manifest.json")) { std::cerr << "missing manifest for context " << i << std::endl; ok = false; }
+            if(std::string(uvf_context_get_operation_type(ctx))!="basic_uvf") ok = false;
+            long long& expected = (i % 2) ? linePoints : slicePoints;
+            long long pts = uvf_context_get_point_count(ctx);
+            if(expected < 0) expected = pts;
+            if(pts <= 0 || pts != expected) { std::cerr << "context " << i << " point count " << pts << std::endl; ok = false; }
+        }
+        uvf_context_destroy(ctx);
+    }
+    return ok;
+}
+
+static bool test_context_options() {
+    uvf_context* ctx = uvf_context_create();
+    if(!ctx) return false;
+    bool ok = uvf_context_set_option(ctx, "content_hash_names", "true")
+           && uvf_context_set_option(ctx, "threads", "2")
+           && !uvf_context_set_option(ctx, "no_such_option", "1")
+           && !uvf_context_set_option(ctx, "threads", "-4")
+           && !uvf_context_set_option(ctx, "time_keyframe_interval", "-1")
+           && uvf_context_set_option(ctx, "time_keyframe_interval", "0")
+           && !uvf_context_set_option(ctx, "threads", "many")
+           && std::string(uvf_context_get_last_error(ctx)).find("threads")!=std::string::npos;
+
+    const std::string in = std::string(TEST_DATA_DIR) + "/slice_sample.vtp";
+    fs::remove_all("test_out_ctx_opts");
+    ok = ok && uvf_context_generate(ctx, in.c_str(), "test_out_ctx_opts");
+
+    // Content-hash names are 16 hex digits
+    bool hashed = false;
+    if(ok){
+        for(auto& e : fs::directory_iterator("test_out_ctx_opts")){
+            std::string name = e.path().filename().string();
+            if(name.size()==20 && name.substr(16)==".bin") hashed = true;
+        }
+    }
+    uvf_context_destroy(ctx);
+    uvf_context_destroy(nullptr);
+    if(!hashed) std::cerr << "context options were not applied" << std::endl;
+    return ok && hashed;
+}
+
+// A reused context reports only the latest run: no stale counts after a
+// failure, no stale error after a success
+static bool test_context_reuse() {
+    uvf_context* ctx = uvf_context_create();
+    if(!ctx) return false;
+    const std::string in = std::string(TEST_DATA_DIR) + "/slice_sample.vtp";
+    fs::remove_all("test_out_ctx_reuse");
+    bool ok = uvf_context_generate(ctx, in.c_str(), "test_out_ctx_reuse") && uvf_context_get_point_count(ctx)>0;
+    ok = ok && !uvf_context_generate(ctx, "no_such_file.vtp", "test_out_ctx_reuse");
+    if(ok && (uvf_context_get_point_count(ctx)!=0 || uvf_context_get_triangle_count(ctx)!=0 ||
+              uvf_context_get_file_count(ctx)!=0 || uvf_context_get_group_count(ctx)!=0 ||
+              uvf_context_get_operation_type(ctx)[0]!='\0')) { std::cerr << "failed run kept previous counts" << std::endl; ok = false; }
+    ok = ok && uvf_context_generate(ctx, in.c_str(), "test_out_ctx_reuse");
+    if(ok && uvf_context_get_last_error(ctx)[0]!='\0') { std::cerr << "successful run kept error: " << uvf_context_get_last_error(ctx) << std::endl; ok = false; }
+    uvf_context_destroy(ctx);
+    return ok;
+}
+
+// The global API keeps working alongside contexts
+static bool test_legacy_api() {
+    const std::string in = std::string(TEST_DATA_DIR) + "/slice_sample.vtp";
+    fs::remove_all("test_out_ctx_legacy");
+    if(!generate_uvf(in.c_str(), "test_out_ctx_legacy")) return false;
+    if(std::string(uvf_get_last_operation_type())!="basic_uvf" || uvf_get_last_point_count()<=0) return false;
+    if(parse_vtp("no_such_file.vtp")) return false;
+    return std::strlen(uvf_get_last_error())>0;
+}
+
+// In-memory conversion produces the same manifest and bin as the directory path
+static bool test_buffer_conversion() {
+    const std::string in = std::string(TEST_DATA_DIR) + "/slice_sample.vtp";
+    std::string bytes = read_file(in);
+    uvf_context* ctx = uvf_context_create();
+    if(!ctx || bytes.empty()) return false;
+    uvf_context_set_option(ctx, "content_hash_names", "1");
+
+    fs::remove_all("test_out_ctx_buffer");
+    bool ok = uvf_context_generate(ctx, in.c_str(), "test_out_ctx_buffer");
+
+    CountingAllocator counter;
+    ok = ok && uvf_context_generate_buffer(ctx, bytes.data(), bytes.size(), "vtp", &CountingAllocator::fn, &counter);
+    if(!ok || uvf_context_get_buffer_count(ctx)!=2 || counter.live!=2) { std::cerr << "buffer conversion failed: " << uvf_context_get_last_error(ctx) << std::endl; uvf_context_destroy(ctx); return false; }
+
+    for(int i=0;i<uvf_context_get_buffer_count(ctx);++i){
+        const uvf_buffer* b = uvf_context_get_buffer(ctx, i);
+        std::string onDisk = read_file(std::string("test_out_ctx_buffer/") + b->name);
+        if(onDisk.size()!=b->size || std::memcmp(onDisk.data(), b->data, b->size)!=0) { std::cerr << "buffer " << b->name << " differs from file output" << std::endl; ok = false; }
+        CountingAllocator::fn(&counter, b->data, 0);
+    }
+    if(uvf_context_get_buffer(ctx, 2)!=nullptr || counter.live!=0) ok = false;
+
+    // Failed conversions leave nothing allocated
+    std::string junk = "not a dataset";
+    if(uvf_context_generate_buffer(ctx, junk.data(), junk.size(), "vtp", &CountingAllocator::fn, &counter) || counter.live!=0 || uvf_context_get_buffer_count(ctx)!=0) ok = false;
+    uvf_context_destroy(ctx);
+    return ok;
+}
+
+// ASCII and binary STL images parse to the same merged mesh
+static bool test_stl_buffer() {
+    const float tris[2][9] = {{0,0,0, 1,0,0, 0,1,0}, {1,0,0, 1,1,0, 0,1,0}};
+    std::string ascii = "solid quad\n";
+    for(const auto& t : tris){
+        ascii += " facet normal 0 0 1\n  outer loop\n";
+        for(int v=0;v<3;++v) ascii += "   vertex " + std::to_string(t[v*3]) + " " + std::to_string(t[v*3+1]) + " " + std::to_string(t[v*3+2]) + "\n";
+        ascii += "  endloop\n endfacet\n";
+    }
+    ascii += "endsolid quad\n";
+
+    std::string binary(80, ' ');
+    uint32_t count = 2;
+    binary.append(reinterpret_cast<const char*>(&count), 4);
+    for(const auto& t : tris){
+        float normal[3] = {0,0,1};
+        uint16_t attr = 0;
+        binary.append(reinterpret_cast<const char*>(normal), 12);
+        binary.append(reinterpret_cast<const char*>(t), 36);
+        binary.append(reinterpret_cast<const char*>(&attr), 2);
+    }
+
+    uvf_context* ctx = uvf_context_create();
+    bool ok = ctx != nullptr;
+    for(const std::string* image : {&ascii, &binary}){
+        if(!ok) break;
+        ok = uvf_context_generate_buffer(ctx, image->data(), image->size(), "stl", nullptr, nullptr)
+             && uvf_context_get_point_count(ctx)==4 && uvf_context_get_triangle_count(ctx)==2;
+        for(int i=0;i<uvf_context_get_buffer_count(ctx);++i) uvf_free(uvf_context_get_buffer(ctx, i)->data);
+    }
+    if(!ok) std::cerr << "STL buffer: " << uvf_context_get_point_count(ctx) << " points" << std::endl;
+    uvf_context_destroy(ctx);
+    return ok;
+}
+
+// Raw arrays produce the same output as the equivalent vtkPolyData
+static bool test_raw_mesh() {
+    const float positions[] = {0,0,0, 1,0,0, 1,1,0.5f, 0,1,0.5f};
+    const uint32_t indices[] = {0,1,2, 0,2,3};
+    const float temperature[] = {10, 20, 30, 40};
+
+    uvf_attribute attr = {"temperature", temperature, 4, 1};
+    uvf_mesh mesh = {};
+    mesh.positions = positions; mesh.vertex_count = 4;
+    mesh.indices = indices; mesh.index_count = 6;
+    mesh.attributes = &attr; mesh.attribute_count = 1;
+
+    uvf_context* ctx = uvf_context_create();
+    uvf_context_set_option(ctx, "content_hash_names", "1");
+    fs::remove_all("test_out_ctx_mesh");
+    bool ok = uvf_context_generate_mesh(ctx, &mesh, "test_out_ctx_mesh")
+              && uvf_context_get_triangle_count(ctx)==2
+              && std::string(uvf_context_get_operation_type(ctx))=="mesh_uvf";
+
+    auto poly = vtkSmartPointer<vtkPolyData>::New();
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    auto polys = vtkSmartPointer<vtkCellArray>::New();
+    for(int i=0;i<4;++i) points->InsertNextPoint(positions[i*3], positions[i*3+1], positions[i*3+2]);
+    for(int t=0;t<2;++t){ polys->InsertNextCell(3); for(int k=0;k<3;++k) polys->InsertCellPoint(indices[t*3+k]); }
+    auto scalars = vtkSmartPointer<vtkFloatArray>::New();
+    scalars->SetName("temperature");
+    for(float v : temperature) scalars->InsertNextValue(v);
+    poly->SetPoints(points);
+    poly->SetPolys(polys);
+    poly->GetPointData()->AddArray(scalars);
+    UVFOptions opts;
+    opts.content_hash_names = true;
+    fs::remove_all("test_out_ctx_mesh_vtk");
+    ok = ok && generate_uvf(poly, "test_out_ctx_mesh_vtk", opts);
+    if(ok && read_file("test_out_ctx_mesh/manifest.json")!=read_file("test_out_ctx_mesh_vtk/manifest.json")) { std::cerr << "raw mesh manifest differs from VTK path" << std::endl; ok = false; }
+
+    // Face segments and explicit kind
+    uvf_face_range faces[] = {{"left", 0, 3}, {"right", 3, 6}};
+    mesh.faces = faces; mesh.face_count = 2;
+    mesh.geom_kind = "isosurface";
+    ok = ok && uvf_context_generate_mesh_buffer(ctx, &mesh, nullptr, nullptr);
+    if(ok){
+        const uvf_buffer* manifest = uvf_context_get_buffer(ctx, uvf_context_get_buffer_count(ctx)-1);
+        std::string json(static_cast<const char*>(manifest->data), manifest->size);
+        if(json.find("\"id\":\"right\"")==std::string::npos || json.find("\"startIndex\":3")==std::string::npos || json.find("isosurfaces")==std::string::npos) { std::cerr << "face ranges missing from manifest" << std::endl; ok = false; }
+        for(int i=0;i<uvf_context_get_buffer_count(ctx);++i) uvf_free(uvf_context_get_buffer(ctx, i)->data);
+    }
+
+    // Validation rejects out-of-range indices and mis-sized attributes
+    const uint32_t bad[] = {0,1,7};
+    uvf_mesh broken = mesh;
+    broken.indices = bad; broken.index_count = 3; broken.faces = nullptr; broken.face_count = 0;
+    if(uvf_context_generate_mesh(ctx, &broken, "test_out_ctx_mesh_bad") || std::string(uvf_context_get_last_error(ctx)).find("out of range")==std::string::npos) ok = false;
+    attr.count = 3;
+    if(uvf_context_generate_mesh(ctx, &mesh, "test_out_ctx_mesh_bad")) ok = false;
+    uvf_context_destroy(ctx);
+    return ok;
+}
+
+// Face ids are JSON-escaped; large face lists stream with an exact entry size
+static bool test_manifest_escaping() {
+    const float positions[] = {0,0,0, 1,0,0, 1,1,0.5f, 0,1,0.5f};
+    std::vector<uint32_t> indices;
+    const size_t face_count = 20000;
+    for(size_t i=0;i<face_count;++i){ uint32_t tri[] = {0,1,2}; indices.insert(indices.end(), tri, tri+3); }
+    std::vector<std::string> ids = {"quote\"d", "back\\slash", "line\nbreak\t\x01", "caf\xc3\xa9"};
+    for(size_t i=ids.size();i<face_count;++i) ids.push_back("face_" + std::to_string(i));
+    std::vector<uvf_face_range> faces(face_count);
+    for(size_t i=0;i<face_count;++i) faces[i] = {ids[i].c_str(), i*3, i*3+3};
+
+    uvf_mesh mesh = {};
+    mesh.positions = positions; mesh.vertex_count = 4;
+    mesh.indices = indices.data(); mesh.index_count = indices.size();
+    mesh.faces = faces.data(); mesh.face_count = static_cast<int>(face_count);
+    mesh.geom_kind = "surface";
+
+    uvf_context* ctx = uvf_context_create();
+    bool ok = uvf_context_generate_mesh_buffer(ctx, &mesh, nullptr, nullptr);
+    if(!ok) std::cerr << "escaping: " << uvf_context_get_last_error(ctx) << std::endl;
+    if(ok){
+        const uvf_buffer* manifest = uvf_context_get_buffer(ctx, uvf_context_get_buffer_count(ctx)-1);
+        std::string json(static_cast<const char*>(manifest->data), manifest->size);
+        const char* expected[] = {"\"quote\\\"d\"", "\"back\\\\slash\"", "\"line\\nbreak\\t\\u0001\"", "\"caf\xc3\xa9\"", "\"face_19999\""};
+        for(const char* e : expected){
+            if(json.find(e)==std::string::npos){ std::cerr << "manifest missing escaped id " << e << std::endl; ok = false; }
+        }
+        if(json.find('\n')!=std::string::npos || json.back()!=']'){ std::cerr << "manifest has raw control characters or is truncated" << std::endl; ok = false; }
+        for(int i=0;i<uvf_context_get_buffer_count(ctx);++i) uvf_free(uvf_context_get_buffer(ctx, i)->data);
+    }
+    uvf_context_destroy(ctx);
+    return ok;
+}
+
+struct ProgressLog {
+    std::vector<std::string> stages;
+    const char* cancel_at = nullptr;
+    uvf_context* ctx = nullptr;
+    bool monotonic = true;
+    uint64_t last_bytes = 0;
+};
+
+static void record_progress(const uvf_progress* p, void* user) {
+    auto* log = static_cast<ProgressLog*>(user);
+    if (log->stages.empty() || log->stages.back() != p->stage) { log->stages.push_back(p->stage); log->last_bytes = 0; }
+    if (p->bytes_done < log->last_bytes || (p->bytes_total && p->bytes_done > p->bytes_total)) log->monotonic = false;
+    log->last_bytes = p->bytes_done;
+    if (log->cancel_at && std::strcmp(p->stage, log->cancel_at) == 0) uvf_context_cancel(log->ctx);
+}
+
+// Stages are reported in order; cancelling mid-write leaves no output behind
+static bool test_progress_and_cancel() {
+    const std::string in = std::string(TEST_DATA_DIR) + "/slice_sample.vtp";
+    uvf_context* ctx = uvf_context_create();
+    ProgressLog log;
+    log.ctx = ctx;
+    uvf_context_set_progress_callback(ctx, record_progress, &log);
+    fs::remove_all("test_out_ctx_progress");
+    bool ok = uvf_context_generate(ctx, in.c_str(), "test_out_ctx_progress");
+    std::vector<std::string> expected = {"extract", "write", "manifest"};
+    if(!ok || log.stages != expected || !log.monotonic) { std::cerr << "unexpected progress stages" << std::endl; ok = false; }
+
+    ProgressLog cancelLog;
+    cancelLog.ctx = ctx;
+    cancelLog.cancel_at = "write";
+    uvf_context_set_progress_callback(ctx, record_progress, &cancelLog);
+    fs::remove_all("test_out_ctx_cancel");
+    if(uvf_context_generate(ctx, in.c_str(), "test_out_ctx_cancel")) ok = false;
+    if(std::string(uvf_context_get_last_error(ctx)) != "Cancelled") { std::cerr << "cancel error: " << uvf_context_get_last_error(ctx) << std::endl; ok = false; }
+    if(fs::exists("test_out_ctx_cancel") && !fs::is_empty("test_out_ctx_cancel")) { std::cerr << "cancelled conversion left output" << std::endl; ok = false; }
+
+    // A cancel request does not carry over to the next conversion
+    uvf_context_set_progress_callback(ctx, nullptr, nullptr);
+    ok = ok && uvf_context_generate(ctx, in.c_str(), "test_out_ctx_cancel");
+    uvf_context_destroy(ctx);
+    return ok;
+}
+
+// Structured stats report stages and real totals, including directory mode
+static bool test_stats() {
+    uvf_context* ctx = uvf_context_create();
+    const std::string in = std::string(TEST_DATA_DIR) + "/slice_sample.vtp";
+    fs::remove_all("test_out_ctx_stats");
+    bool ok = uvf_context_generate(ctx, in.c_str(), "test_out_ctx_stats");
+
+    uvf_stats st;
+    ok = ok && uvf_context_get_stats(ctx, &st);
+    ok = ok && st.point_count > 0 && st.triangle_count > 0 && st.file_count == 1;
+    ok = ok && st.bytes_read == fs::file_size(in) && st.bytes_written > 0 && st.total_seconds > 0;
+    std::vector<std::string> names;
+    uvf_stage_stats stage;
+    for (int i = 0; i < st.stage_count && uvf_context_get_stage_stats(ctx, i, &stage); ++i) names.push_back(stage.name);
+    std::vector<std::string> expected = {"parse", "extract", "triangulate", "write", "manifest"};
+    if(!ok || names != expected) { std::cerr << "unexpected single-file stats" << std::endl; ok = false; }
+    if(uvf_context_get_stage_stats(ctx, st.stage_count, &stage)) ok = false;
+
+    // Bytes written match the files on disk
+    uint64_t on_disk = 0;
+    for(auto& e : fs::directory_iterator("test_out_ctx_stats")) on_disk += fs::file_size(e.path());
+    if(on_disk != st.bytes_written) { std::cerr << "bytes_written " << st.bytes_written << " != " << on_disk << std::endl; ok = false; }
+
+    fs::remove_all("test_out_ctx_stats_dir");
+    ok = ok && uvf_context_generate_directory(ctx, TEST_DATA_DIR, "test_out_ctx_stats_dir");
+    ok = ok && uvf_context_get_stats(ctx, &st);
+    if(!ok || st.point_count == 0 || st.triangle_count == 0 || st.file_count != 3 || st.group_count == 0) {
+        std::cerr << "unexpected directory stats" << std::endl;
+        ok = false;
+    }
+    if(ok && uvf_context_get_point_count(ctx) != static_cast<long long>(st.point_count)) ok = false;
+
+    // A quad is one polygon but two triangles: the getter and the stats agree
+    std::ofstream("test_in_ctx_quad.vtk") << "# vtk DataFile Version 3.0\nquad\nASCII\nDATASET POLYDATA\n"
+        "POINTS 4 float\n0 0 0 1 0 0 1 1 0 0 1 0\nPOLYGONS 1 5\n4 0 1 2 3\n";
+    fs::remove_all("test_out_ctx_quad"); fs::remove_all("test_out_ctx_quad_structured");
+    bool quad = uvf_context_parse(ctx, "test_in_ctx_quad.vtk") && uvf_context_get_triangle_count(ctx) == 2 &&
+                uvf_context_get_stats(ctx, &st) && st.triangle_count == 2;
+    quad = quad && uvf_context_generate(ctx, "test_in_ctx_quad.vtk", "test_out_ctx_quad") &&
+           uvf_context_get_triangle_count(ctx) == 2 && uvf_context_get_stats(ctx, &st) && st.triangle_count == 2;
+    quad = quad && uvf_context_generate_structured(ctx, "test_in_ctx_quad.vtk", "test_out_ctx_quad_structured") &&
+           uvf_context_get_triangle_count(ctx) == 2 && uvf_context_get_stats(ctx, &st) && st.triangle_count == 2;
+    if(!quad) { std::cerr << "triangle counts disagree for a quad" << std::endl; ok = false; }
+
+    std::string json = uvf_context_get_stats_json(ctx);
+    if(json.empty() || json.front()!='{' || json.back()!='}' || json.find("\"stages\":[{\"name\":\"parse\"")==std::string::npos) {
+        std::cerr << "bad stats json: " << json << std::endl;
+        ok = false;
+    }
+    uvf_context_destroy(ctx);
+    return ok;
+}
+
+static size_t count_occurrences(const std::string& s, const std::string& needle) {
+    size_t n = 0;
+    for (size_t pos = s.find(needle); pos != std::string::npos; pos = s.find(needle, pos + 1)) n++;
+    return n;
+}
+
+// Tracing writes one span per file and per stage; turning it off writes nothing
+static bool test_trace() {
+    uvf_context* ctx = uvf_context_create();
+    uvf_context_set_option(ctx, "threads", "2");
+    fs::remove("test_ctx_trace.json");
+    fs::remove_all("test_out_ctx_trace");
+    bool ok = uvf_context_set_trace_file(ctx, "test_ctx_trace.json")
+           && uvf_context_generate_directory(ctx, TEST_DATA_DIR, "test_out_ctx_trace");
+    std::string json = read_file("test_ctx_trace.json");
+    if(!ok || json.rfind("{\"traceEvents\":[", 0) != 0 || json.back() != '}'
+       || count_occurrences(json, "\"name\":\"file\"") != 3
+       || count_occurrences(json, "\"name\":\"parse\"") != 3
+       || count_occurrences(json, "\"name\":\"generate_multi_file_uvf\"") != 1
+       || json.find("\"ph\":\"X\"") == std::string::npos) {
+        std::cerr << "unexpected trace: " << json.substr(0, 200) << std::endl;
+        ok = false;
+    }
+
+    fs::remove("test_ctx_trace.json");
+    uvf_context_set_trace_file(ctx, nullptr);
+    ok = ok && uvf_context_generate_directory(ctx, TEST_DATA_DIR, "test_out_ctx_trace");
+    if(fs::exists("test_ctx_trace.json")) { std::cerr << "trace written while off" << std::endl; ok = false; }
+    uvf_context_destroy(ctx);
+    return ok;
+}
+
+int main() {
+    bool a = test_concurrent_contexts();
+    bool b = test_context_options();
+    bool c = test_legacy_api();
+    bool d = test_buffer_conversion();
+    bool e = test_stl_buffer();
+    bool f = test_raw_mesh();
+    bool g = test_progress_and_cancel();
+    bool h = test_stats();
+    bool i = test_trace();
+    bool j = test_manifest_escaping();
+    bool k = test_context_reuse();
+    if(!(a&&b&&c&&d&&e&&f&&g&&h&&i&&j&&k)) {
+        std::cerr << "Tests failed: " << a << b << c << d << e << f << g << h << i << j << k << std::endl;
+        return 1;
+    }
+    std::cout << "All C API context tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,351 @@
+// Large-input tier (UVF_ENABLE_LARGE_TESTS): procedurally generated VTP, legacy
+// VTK and binary STL files with 10M-100M triangles.
+//
+//   uvf_large_tests --format=vtp|vtk|stl --elements=N [--rss-factor=F] [--work-dir=DIR]
+//   uvf_large_tests --scaling --elements=N [--work-dir=DIR]
+//
+// Format runs check the output against the generator (section sizes, sampled
+// triangles and attributes, offsets beyond 2^31 at 100M) and that peak RSS stays
+// within F times the input file size. One format per process, so the RSS
+// high-water mark belongs to that conversion alone.
+//
+// The scaling run splits the mesh into files, converts the directory with one
+// thread and with several, and checks the speedup is real but sub-linear.
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <filesystem>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <regex>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include "vtp_to_uvf.h"
+#include "multi_file_parser.h"
+#include "conversion_stats.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Triangulated grid: triangle t lies in quad t/2 of a W-wide point grid
+struct GridMesh {
+    uint64_t triangles = 0;
+    uint64_t width = 0;
+    uint64_t points = 0;
+
+    explicit GridMesh(uint64_t elements) : triangles(elements) {
+        width = static_cast<uint64_t>(std::sqrt(static_cast<double>(elements) / 2)) + 2;
+        uint64_t quads = (elements + 1) / 2;
+        uint64_t rows = (quads + width - 2) / (width - 1) + 1;
+        points = rows * width;
+    }
+
+    void triangle(uint64_t t, uint64_t ids[3]) const {
+        uint64_t q = t / 2, r = q / (width - 1), c = q % (width - 1);
+        uint64_t p0 = r * width + c, p1 = p0 + 1, p2 = p0 + width, p3 = p2 + 1;
+        if (t % 2 == 0) { ids[0] = p0; ids[1] = p1; ids[2] = p3; }
+        else { ids[0] = p0; ids[1] = p3; ids[2] = p2; }
+    }
+
+    // Coordinates and attributes are small integers or quarters: exact in
+    // float and in ASCII, so the check can compare bit for bit
+    void position(uint64_t i, float xyz[3]) const {
+        xyz[0] = static_cast<float>(i % width);
+        xyz[1] = static_cast<float>(i / width);
+        xyz[2] = static_cast<float>(((i % width) * 7 + (i / width) * 13) % 17) * 0.25f;
+    }
+    static float pressure(uint64_t i) { return static_cast<float>(i % 1000); }
+    static void velocity(uint64_t i, float v[3]) {
+        v[0] = static_cast<float>(i % 7);
+        v[1] = static_cast<float>(i % 11);
+        v[2] = static_cast<float>(i % 13);
+    }
+};
+
+// Buffered text writer; ASCII inputs at this size are dominated by formatting
+class Writer {
+public:
+    explicit Writer(const std::string& path) : f_(std::fopen(path.c_str(), "wb")) {
+        if (f_) std::setvbuf(f_, nullptr, _IOFBF, 1 << 22);
+    }
+    ~Writer() { if (f_) std::fclose(f_); }
+    bool ok() const { return f_ != nullptr; }
+    void text(const char* s) { std::fputs(s, f_); }
+    void num(float v) { std::fprintf(f_, "%g ", v); }
+    void num(uint64_t v) { std::fprintf(f_, "%llu ", static_cast<unsigned long long>(v)); }
+    void raw(const void* p, size_t n) { std::fwrite(p, 1, n, f_); }
+    void newline() { std::fputc('\n', f_); }
+
+private:
+    FILE* f_;
+};
+
+bool write_vtp(const GridMesh& m, const std::string& path) {
+    Writer w(path);
+    if (!w.ok()) return false;
+    float v[3];
+    w.text("<?xml version=\"1.0\"?>\n<VTKFile type=\"PolyData\" version=\"0.1\" byte_order=\"LittleEndian\">\n<PolyData>\n");
+    std::string piece = "<Piece NumberOfPoints=\"" + std::to_string(m.points) + "\" NumberOfPolys=\"" + std::to_string(m.triangles) + "\">\n";
+    w.text(piece.c_str());
+    w.text("<PointData Scalars=\"pressure\">\n<DataArray type=\"Float32\" Name=\"pressure\" format=\"ascii\">\n");
+    for (uint64_t i = 0; i < m.points; ++i) w.num(GridMesh::pressure(i));
+    w.text("\n</DataArray>\n<DataArray type=\"Float32\" Name=\"velocity\" NumberOfComponents=\"3\" format=\"ascii\">\n");
+    for (uint64_t i = 0; i < m.points; ++i) { GridMesh::velocity(i, v); w.num(v[0]); w.num(v[1]); w.num(v[2]); }
+    w.text("\n</DataArray>\n</PointData>\n<Points>\n<DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"ascii\">\n");
+    for (uint64_t i = 0; i < m.points; ++i) { m.position(i, v); w.num(v[0]); w.num(v[1]); w.num(v[2]); }
+    w.text("\n</DataArray>\n</Points>\n<Polys>\n<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\">\n");
+    uint64_t ids[3];
+    for (uint64_t t = 0; t < m.triangles; ++t) { m.triangle(t, ids); w.num(ids[0]); w.num(ids[1]); w.num(ids[2]); }
+    w.text("\n</DataArray>\n<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\">\n");
+    for (uint64_t t = 0; t < m.triangles; ++t) w.num((t + 1) * 3);
+    w.text("\n</DataArray>\n</Polys>\n</Piece>\n</PolyData>\n</VTKFile>\n");
+    return true;
+}
+
+bool write_legacy_vtk(const GridMesh& m, const std::string& path) {
+    Writer w(path);
+    if (!w.ok()) return false;
+    float v[3];
+    std::string header = "# vtk DataFile Version 3.0\nuvf large test\nASCII\nDATASET POLYDATA\nPOINTS " + std::to_string(m.points) + " float\n";
+    w.text(header.c_str());
+    for (uint64_t i = 0; i < m.points; ++i) { m.position(i, v); w.num(v[0]); w.num(v[1]); w.num(v[2]); w.newline(); }
+    std::string polys = "POLYGONS " + std::to_string(m.triangles) + " " + std::to_string(m.triangles * 4) + "\n";
+    w.text(polys.c_str());
+    uint64_t ids[3];
+    for (uint64_t t = 0; t < m.triangles; ++t) { m.triangle(t, ids); w.num(uint64_t(3)); w.num(ids[0]); w.num(ids[1]); w.num(ids[2]); w.newline(); }
+    std::string pd = "POINT_DATA " + std::to_string(m.points) + "\nSCALARS pressure float 1\nLOOKUP_TABLE default\n";
+    w.text(pd.c_str());
+    for (uint64_t i = 0; i < m.points; ++i) w.num(GridMesh::pressure(i));
+    w.text("\nVECTORS velocity float\n");
+    for (uint64_t i = 0; i < m.points; ++i) { GridMesh::velocity(i, v); w.num(v[0]); w.num(v[1]); w.num(v[2]); }
+    w.newline();
+    return true;
+}
+
+bool write_binary_stl(const GridMesh& m, const std::string& path) {
+    Writer w(path);
+    if (!w.ok()) return false;
+    char header[80] = "uvf large test (binary)";
+    w.raw(header, sizeof(header));
+    uint32_t count = static_cast<uint32_t>(m.triangles);
+    w.raw(&count, 4);
+    float rec[12] = {0, 0, 1};
+    uint16_t attr = 0;
+    uint64_t ids[3];
+    for (uint64_t t = 0; t < m.triangles; ++t) {
+        m.triangle(t, ids);
+        for (int k = 0; k < 3; ++k) m.position(ids[k], rec + 3 + k * 3);
+        w.raw(rec, sizeof(rec));
+        w.raw(&attr, 2);
+    }
+    return true;
+}
+
+struct Section { uint64_t offset = 0, length = 0; bool found = false; };
+
+// Sections of the single-geometry manifest written by generate_uvf
+bool read_manifest(const std::string& dir, std::string& bin, std::map<std::string, Section>& sections) {
+    std::ifstream ifs(dir + "/manifest.json");
+    std::string json((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    std::smatch m;
+    if (!std::regex_search(json, m, std::regex("\"path\":\"([^\"]+)\""))) return false;
+    bin = dir + "/" + m[1].str();
+    std::regex sec("\"length\":(\\d+),\"name\":\"([^\"]+)\",\"offset\":(\\d+)");
+    for (auto it = std::sregex_iterator(json.begin(), json.end(), sec); it != std::sregex_iterator(); ++it) {
+        Section s;
+        s.length = std::stoull((*it)[1].str());
+        s.offset = std::stoull((*it)[3].str());
+        s.found = true;
+        sections[(*it)[2].str()] = s;
+    }
+    return !sections.empty();
+}
+
+template <class T>
+bool read_at(std::ifstream& bin, const Section& s, uint64_t element, T* out, size_t count) {
+    uint64_t pos = s.offset + element * sizeof(T);
+    if ((element + count) * sizeof(T) > s.length) return false;
+    bin.seekg(static_cast<std::streamoff>(pos));
+    bin.read(reinterpret_cast<char*>(out), static_cast<std::streamsize>(count * sizeof(T)));
+    return static_cast<bool>(bin);
+}
+
+bool check_output(const GridMesh& m, const std::string& format, const std::string& dir) {
+    std::string bin_path;
+    std::map<std::string, Section> sections;
+    if (!read_manifest(dir, bin_path, sections)) {
+        std::cerr << "manifest unreadable" << std::endl;
+        return false;
+    }
+    const Section& idx = sections["indices"];
+    const Section& pos = sections["position"];
+    const bool stl = format == "stl";
+    uint64_t total = 0;
+    for (const auto& kv : sections) total = std::max(total, kv.second.offset + kv.second.length);
+    if (!idx.found || idx.length != m.triangles * 12 || !pos.found || pos.length % 12 != 0
+        || (!stl && pos.length != m.points * 12) || fs::file_size(bin_path) != total) {
+        std::cerr << "section sizes do not match the input" << std::endl;
+        return false;
+    }
+    const uint64_t vertices = pos.length / 12;
+    if (!stl && (!sections["pressure"].found || !sections["velocity"].found
+                 || sections["pressure"].length != m.points * 4 || sections["velocity"].length != m.points * 12)) {
+        std::cerr << "attribute sections missing or truncated" << std::endl;
+        return false;
+    }
+    if (m.triangles >= 100000000 && !stl && sections["velocity"].offset <= (uint64_t(1) << 31)) {
+        std::cerr << "expected a section beyond 2 GiB at this size" << std::endl;
+        return false;
+    }
+
+    // Sampled triangles: indices in range and positions equal to the generator's
+    std::ifstream bin(bin_path, std::ios::binary);
+    const uint64_t samples = std::min<uint64_t>(m.triangles, 4096);
+    for (uint64_t s = 0; s < samples; ++s) {
+        uint64_t t = samples > 1 ? s * (m.triangles - 1) / (samples - 1) : 0;
+        uint32_t got[3];
+        uint64_t want[3];
+        if (!read_at(bin, idx, t * 3, got, 3)) return false;
+        m.triangle(t, want);
+        for (int k = 0; k < 3; ++k) {
+            if (got[k] >= vertices) { std::cerr << "index out of range at triangle " << t << std::endl; return false; }
+            if (!stl && got[k] != want[k]) { std::cerr << "index mismatch at triangle " << t << std::endl; return false; }
+            float p[3], e[3];
+            if (!read_at(bin, pos, uint64_t(got[k]) * 3, p, 3)) return false;
+            m.position(want[k], e);
+            if (std::memcmp(p, e, sizeof(p)) != 0) { std::cerr << "position mismatch at triangle " << t << std::endl; return false; }
+            if (!stl) {
+                float pr, v[3], ev[3];
+                if (!read_at(bin, sections["pressure"], got[k], &pr, 1) || pr != GridMesh::pressure(got[k])) {
+                    std::cerr << "pressure mismatch at vertex " << got[k] << std::endl;
+                    return false;
+                }
+                GridMesh::velocity(got[k], ev);
+                if (!read_at(bin, sections["velocity"], uint64_t(got[k]) * 3, v, 3) || std::memcmp(v, ev, sizeof(v)) != 0) {
+                    std::cerr << "velocity mismatch at vertex " << got[k] << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int run_format(const std::string& format, uint64_t elements, double rss_factor, const std::string& work) {
+    GridMesh mesh(elements);
+    const std::string input = work + "/large_" + std::to_string(elements) + "." + format;
+    const std::string out = work + "/large_" + std::to_string(elements) + "_" + format + "_out";
+    fs::create_directories(work);
+    fs::remove_all(out);
+
+    auto t0 = std::chrono::steady_clock::now();
+    bool written = format == "vtp" ? write_vtp(mesh, input)
+                 : format == "vtk" ? write_legacy_vtk(mesh, input)
+                 : write_binary_stl(mesh, input);
+    if (!written) { std::cerr << "cannot write " << input << std::endl; return 1; }
+    const uint64_t input_bytes = fs::file_size(input);
+    // Generation streams to disk; conversion is what the RSS bound is about
+    const uint64_t baseline_rss = current_peak_rss_bytes();
+
+    UVFConversionStats stats;
+    UVFOptions options;
+    options.stats = &stats;
+    stats.start();
+    auto poly = parse_vtp_file(input.c_str(), options);
+    bool ok = poly && generate_uvf(poly, out.c_str(), options);
+    poly = nullptr;
+    stats.finish();
+    auto t1 = std::chrono::steady_clock::now();
+    std::cout << stats.to_json() << std::endl;
+    if (!ok) { std::cerr << "conversion failed" << std::endl; return 1; }
+    if (stats.triangles() != elements) { std::cerr << "triangle count " << stats.triangles() << " != " << elements << std::endl; return 1; }
+    if (!check_output(mesh, format, out)) return 1;
+
+    const uint64_t peak = stats.peak_rss_bytes();
+    const double limit = rss_factor * static_cast<double>(input_bytes) + static_cast<double>(baseline_rss);
+    std::cout << format << " " << elements << " triangles: input " << input_bytes << " B, peak RSS " << peak
+              << " B (limit " << static_cast<uint64_t>(limit) << "), "
+              << std::chrono::duration<double>(t1 - t0).count() << " s" << std::endl;
+    if (static_cast<double>(peak) > limit) { std::cerr << "peak RSS above " << rss_factor << "x input" << std::endl; return 1; }
+
+    fs::remove(input);
+    fs::remove_all(out);
+    return 0;
+}
+
+// Directory conversion timed at 1 and N threads over independent files
+int run_scaling(uint64_t elements, const std::string& work) {
+    const unsigned hw = std::thread::hardware_concurrency();
+    const int threads = static_cast<int>(std::min(8u, hw));
+    if (threads < 2) {
+        std::cout << "single core machine; thread scaling not measurable" << std::endl;
+        return 77; // reported as skipped
+    }
+    const int files = threads * 2;
+    const std::string in = work + "/scaling_" + std::to_string(elements);
+    fs::remove_all(in);
+    fs::create_directories(in);
+    GridMesh part(elements / files);
+    for (int f = 0; f < files; ++f) {
+        if (!write_vtp(part, in + "/part_" + std::to_string(f) + ".vtp")) return 1;
+    }
+
+    double seconds[2] = {0, 0};
+    const int counts[2] = {1, threads};
+    for (int k = 0; k < 2; ++k) {
+        const std::string out = in + "_out" + std::to_string(counts[k]);
+        fs::remove_all(out);
+        UVFConversionStats stats;
+        UVFOptions options;
+        options.threads = counts[k];
+        options.stats = &stats;
+        stats.start();
+        bool ok = process_directory_structure(in.c_str(), out.c_str(), options);
+        stats.finish();
+        seconds[k] = stats.total_seconds();
+        if (!ok || stats.files() != static_cast<uint64_t>(files) || stats.triangles() != part.triangles * files) {
+            std::cerr << "directory conversion with " << counts[k] << " threads failed" << std::endl;
+            return 1;
+        }
+        fs::remove_all(out);
+    }
+    fs::remove_all(in);
+
+    const double speedup = seconds[0] / seconds[1];
+    std::cout << "1 thread " << seconds[0] << " s, " << threads << " threads " << seconds[1] << " s, speedup " << speedup << std::endl;
+    // More threads must help, and no more than linearly (superlinear means the
+    // single-thread run was measuring something else)
+    if (speedup < 1.2) { std::cerr << "no parallel speedup" << std::endl; return 1; }
+    if (speedup > threads * 1.25) { std::cerr << "superlinear speedup; timing is suspect" << std::endl; return 1; }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string format = "vtp";
+    uint64_t elements = 10000000;
+    double rss_factor = 6.0;
+    std::string work = ".";
+    bool scaling = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--format=", 9) == 0) format = argv[i] + 9;
+        else if (std::strncmp(argv[i], "--elements=", 11) == 0) elements = std::strtoull(argv[i] + 11, nullptr, 10);
+        else if (std::strncmp(argv[i], "--rss-factor=", 13) == 0) rss_factor = std::atof(argv[i] + 13);
+        else if (std::strncmp(argv[i], "--work-dir=", 11) == 0) work = argv[i] + 11;
+        else if (std::strcmp(argv[i], "--scaling") == 0) scaling = true;
+        else { std::cerr << "Unknown argument: " << argv[i] << std::endl; return 2; }
+    }
+    if (elements == 0 || (format != "vtp" && format != "vtk" && format != "stl")) {
+        std::cerr << "Invalid --elements or --format" << std::endl;
+        return 2;
+    }
+    return scaling ? run_scaling(elements, work) : run_format(format, elements, rss_factor, work);
+}
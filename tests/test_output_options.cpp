@@ -0,0 +1,1173 @@
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <filesystem>
+#include <map>
+#include <chrono>
+#include <sys/stat.h>
+#include "vtp_to_uvf.h"
+#include "multi_file_parser.h"
+#include "time_series.h"
+#include "watch_mode.h"
+#include "file_discovery.h"
+#include "binary_manifest.h"
+#include "uvf_container.h"
+#include "section_codec.h"
+#include "mesh_codec.h"
+#include "mesh_normals.h"
+#include "mesh_bvh.h"
+#include "mesh_edges.h"
+#include "mesh_reorder.h"
+#include "vtk_structured_parser.h"
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <vector>
+#include <cstring>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <algorithm>
+#include <limits>
+
+namespace {
+bool file_exists(const std::string& p){ struct stat st; return ::stat(p.c_str(), &st)==0; }
+
+std::string read_manifest(const std::string& dir){
+    std::ifstream ifs(dir + "/manifest.json");
+    if(!ifs) return "";
+    return std::string((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+}
+
+// First "path":"<value>" in the manifest
+std::string manifest_bin_path(const std::string& dir){
+    std::string content = read_manifest(dir);
+    auto pos = content.find("\"path\":\"");
+    if(pos==std::string::npos) return "";
+    pos += 8;
+    auto end = content.find('"', pos);
+    if(end==std::string::npos) return "";
+    return content.substr(pos, end-pos);
+}
+
+vtkSmartPointer<vtkPolyData> make_triangle(double z){
+    auto poly = vtkSmartPointer<vtkPolyData>::New();
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    auto polys = vtkSmartPointer<vtkCellArray>::New();
+    vtkIdType id0 = points->InsertNextPoint(0,0,0);
+    vtkIdType id1 = points->InsertNextPoint(1,0,0);
+    vtkIdType id2 = points->InsertNextPoint(0,1,z);
+    polys->InsertNextCell(3); polys->InsertCellPoint(id0); polys->InsertCellPoint(id1); polys->InsertCellPoint(id2);
+    poly->SetPoints(points);
+    poly->SetPolys(polys);
+    return poly;
+}
+
+std::string convert(vtkPolyData* poly, const std::string& outDir, const UVFOptions& opts){
+    system((std::string("rm -rf ")+outDir).c_str());
+    if(!generate_uvf(poly, outDir.c_str(), opts)) return "";
+    return manifest_bin_path(outDir);
+}
+}
+
+static bool test_content_hash_names() {
+    UVFOptions opts;
+    opts.content_hash_names = true;
+    auto poly = make_triangle(0.2);
+    std::string a = convert(poly, "test_out_hash_a", opts);
+    std::string b = convert(poly, "test_out_hash_b", opts);
+    std::string c = convert(make_triangle(0.3), "test_out_hash_c", opts);
+    if(a.empty() || a != b) { std::cerr << "hash names differ for identical input: " << a << " vs " << b << std::endl; return false; }
+    if(a == c) { std::cerr << "hash name unchanged for different input: " << c << std::endl; return false; }
+    if(!file_exists("test_out_hash_a/" + a)) { std::cerr << "missing bin " << a << std::endl; return false; }
+    if(file_exists("test_out_hash_a/" + a + ".tmp")) return false;
+    return true;
+}
+
+static bool test_random_names_default() {
+    auto poly = make_triangle(0.2);
+    std::string a = convert(poly, "test_out_rand_a", UVFOptions());
+    std::string b = convert(poly, "test_out_rand_b", UVFOptions());
+    return !a.empty() && !b.empty() && file_exists("test_out_rand_a/" + a);
+}
+
+namespace fs = std::filesystem;
+
+static std::map<std::string, fs::file_time_type> bin_times(const std::string& dir){
+    std::map<std::string, fs::file_time_type> out;
+    for(const auto& e : fs::directory_iterator(dir)) if(e.path().extension()==".bin") out[e.path().filename().string()] = e.last_write_time();
+    return out;
+}
+
+static bool test_incremental_directory() {
+    const std::string inDir = "test_in_incremental", outDir = "test_out_incremental";
+    fs::remove_all(inDir); fs::remove_all(outDir);
+    fs::create_directories(inDir);
+    for(const char* f : {"slice_sample.vtp", "line_sample.vtp", "surface_sample.vtk"})
+        fs::copy_file(std::string(TEST_DATA_DIR)+"/"+f, inDir+"/"+f);
+    UVFOptions opts;
+    opts.incremental = true;
+    if(!process_directory_structure(inDir.c_str(), outDir.c_str(), opts)) return false;
+    auto first = bin_times(outDir);
+    std::string manifest1 = read_manifest(outDir);
+    if(first.size()!=3 || !file_exists(outDir+"/.uvf_cache")) { std::cerr << "incremental first run incomplete" << std::endl; return false; }
+
+    // Unchanged inputs: nothing rewritten, identical manifest
+    if(!process_directory_structure(inDir.c_str(), outDir.c_str(), opts)) return false;
+    if(bin_times(outDir)!=first || read_manifest(outDir)!=manifest1) { std::cerr << "unchanged inputs were reconverted" << std::endl; return false; }
+
+    // Change one input: only its bin is rewritten
+    { std::ofstream app(inDir+"/surface_sample.vtk", std::ios::app); app << "\n"; }
+    fs::last_write_time(outDir+"/surface_sample.bin", fs::file_time_type::clock::now() - std::chrono::hours(1));
+    auto before = bin_times(outDir);
+    if(!process_directory_structure(inDir.c_str(), outDir.c_str(), opts)) return false;
+    auto after = bin_times(outDir);
+    if(after["surface_sample.bin"]==before["surface_sample.bin"]) { std::cerr << "changed input was not reconverted" << std::endl; return false; }
+    if(after["slice_sample.bin"]!=before["slice_sample.bin"] || after["line_sample.bin"]!=before["line_sample.bin"]) return false;
+    if(read_manifest(outDir)!=manifest1) return false;
+
+    // An input rewritten in place (same size) while it is converted: the next
+    // run must not take the bin of the old content for the new one
+    const std::string surface = inDir+"/surface_sample.vtk";
+    { std::ofstream app(surface, std::ios::app); app << "\n"; }
+    opts.threads = 1;
+    opts.progress = [&](const UVFProgress& p){
+        if(std::string(p.stage)!="convert" || p.items_done!=1) return;
+        std::ifstream ifs(surface, std::ios::binary);
+        std::string text((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        ifs.close();
+        text.back() = ' ';
+        std::ofstream(surface, std::ios::binary) << text;
+        fs::last_write_time(surface, fs::file_time_type::clock::now() + std::chrono::hours(1));
+    };
+    if(!process_directory_structure(inDir.c_str(), outDir.c_str(), opts)) return false;
+    opts.progress = nullptr;
+    fs::last_write_time(outDir+"/surface_sample.bin", fs::file_time_type::clock::now() - std::chrono::hours(1));
+    before = bin_times(outDir);
+    if(!process_directory_structure(inDir.c_str(), outDir.c_str(), opts)) return false;
+    if(bin_times(outDir)["surface_sample.bin"]==before["surface_sample.bin"]) { std::cerr << "input rewritten during conversion was not reconverted" << std::endl; return false; }
+    return true;
+}
+
+static void write_step_vtk(const std::string& path, float t){
+    std::ofstream ofs(path);
+    ofs << "# vtk DataFile Version 3.0\nstep\nASCII\nDATASET POLYDATA\nPOINTS 3 float\n0 0 0\n1 0 0\n0 1 0.2\n";
+    ofs << "POLYGONS 1 4\n3 0 1 2\nPOINT_DATA 3\nSCALARS temperature float 1\nLOOKUP_TABLE default\n";
+    ofs << t << "\n" << t*2 << "\n" << t*3 << "\n";
+}
+
+static std::vector<char> read_bytes(const std::string& path){
+    std::ifstream ifs(path, std::ios::binary);
+    return std::vector<char>((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+}
+
+static bool test_time_series_xor() {
+    const std::string inDir = "test_in_series", outDir = "test_out_series";
+    fs::remove_all(inDir); fs::remove_all(outDir);
+    fs::create_directories(inDir);
+    const float values[3] = {1.5f, 2.25f, -4.0f};
+    std::ofstream pvd(inDir + "/series.pvd");
+    pvd << "<?xml version=\"1.0\"?>\n<VTKFile type=\"Collection\" version=\"0.1\">\n<Collection>\n";
+    for(int i=2;i>=0;--i){ // out of order on purpose
+        write_step_vtk(inDir + "/step" + std::to_string(i) + ".vtk", values[i]);
+        pvd << "<DataSet timestep=\"" << i*0.5 << "\" group=\"\" part=\"0\" file=\"step" << i << ".vtk\"/>\n";
+    }
+    pvd << "</Collection>\n</VTKFile>\n";
+    pvd.close();
+
+    std::vector<std::string> files; std::vector<double> times;
+    if(!parse_pvd_collection((inDir + "/series.pvd").c_str(), files, times) || files.size()!=3 || times[2]!=1.0) return false;
+    UVFOptions opts;
+    opts.time_encoding = "xor";
+    if(!generate_time_series_uvf(files, times, outDir.c_str(), opts)) return false;
+    if(!file_exists(outDir+"/geometry_0.bin") || file_exists(outDir+"/geometry_1.bin")) { std::cerr << "geometry not shared" << std::endl; return false; }
+    std::string manifest = read_manifest(outDir);
+    if(manifest.find("\"timeSeries\"")==std::string::npos || manifest.find("\"encoding\":\"xor\"")==std::string::npos) return false;
+
+    // Decode the last step by XOR-ing the chain of step sections
+    std::vector<uint32_t> acc(3, 0);
+    for(int i=0;i<3;++i){
+        auto bytes = read_bytes(outDir + "/step_" + std::to_string(i) + ".bin");
+        if(bytes.size()!=12) return false;
+        for(int k=0;k<3;++k){ uint32_t v; std::memcpy(&v, bytes.data()+k*4, 4); acc[k] = (i==0) ? v : (acc[k]^v); }
+    }
+    for(int k=0;k<3;++k){ float f; std::memcpy(&f, &acc[k], 4); if(f != values[2]*(k+1)) { std::cerr << "decoded step mismatch" << std::endl; return false; } }
+
+    // A step failing to load removes the bins already written; no manifest appears
+    const std::string failDir = "test_out_series_fail";
+    fs::remove_all(failDir);
+    std::vector<std::string> broken = {files[0], inDir + "/missing.vtk", files[2]};
+    if(generate_time_series_uvf(broken, times, failDir.c_str(), opts)) { std::cerr << "time series with a missing step succeeded" << std::endl; return false; }
+    for(auto& e : fs::directory_iterator(failDir)) { std::cerr << "leftover " << e.path() << std::endl; return false; }
+    return true;
+}
+
+#ifdef __linux__
+static bool wait_for(const std::function<bool()>& cond, int timeout_ms){
+    for(int waited=0; waited<timeout_ms; waited+=50){
+        if(cond()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return cond();
+}
+
+static bool test_watch_directory() {
+    const std::string inDir = "test_in_watch", outDir = "test_out_watch";
+    fs::remove_all(inDir); fs::remove_all(outDir);
+    fs::create_directories(inDir);
+    fs::copy_file(std::string(TEST_DATA_DIR)+"/slice_sample.vtp", inDir+"/slice_sample.vtp");
+    std::atomic<bool> stop(false);
+    std::thread watcher([&]{ watch_directory(inDir.c_str(), outDir.c_str(), UVFOptions(), &stop, 100); });
+    bool initial = wait_for([&]{ return read_manifest(outDir).find("slice_sample")!=std::string::npos; }, 5000);
+    // A new input written in two chunks shows up after the debounce window
+    { std::ofstream part(inDir+"/surface_new.vtk"); part << "# vtk DataFile Version 3.0\n"; }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    fs::copy_file(std::string(TEST_DATA_DIR)+"/surface_sample.vtk", inDir+"/surface_new.vtk", fs::copy_options::overwrite_existing);
+    bool updated = wait_for([&]{ return read_manifest(outDir).find("surface_new")!=std::string::npos; }, 5000);
+    bool added = file_exists(outDir+"/surface_new.bin");
+    // A removed input takes its bin with it
+    fs::remove(inDir+"/slice_sample.vtp");
+    bool removed = wait_for([&]{ return read_manifest(outDir).find("slice_sample")==std::string::npos; }, 5000) &&
+                   wait_for([&]{ return !file_exists(outDir+"/slice_sample.bin"); }, 1000);
+    stop = true;
+    watcher.join();
+    if(!initial || !updated || !added || !removed) { std::cerr << "watch mode did not pick up changes: " << initial << updated << added << removed << std::endl; return false; }
+    if(file_exists(outDir+"/manifest.json.tmp") || !file_exists(outDir+"/surface_new.bin")) return false;
+
+    // Nothing to convert up front: watching fails instead of waiting
+    fs::remove_all("test_in_watch_empty");
+    fs::create_directories("test_in_watch_empty");
+    stop = false;
+    return !watch_directory("test_in_watch_empty", "test_out_watch_empty", UVFOptions(), &stop, 100);
+}
+#else
+static bool test_watch_directory() { return true; }
+#endif
+
+static bool test_glob_match() {
+    return glob_match("*.vtk", "a/b/c.vtk") && !glob_match("*.vtk", "a/b/c.vtp") &&
+           glob_match("a/*/c.vtk", "a/b/c.vtk") && !glob_match("a/*/c.vtk", "a/b/x/c.vtk") &&
+           glob_match("a/**/c.vtk", "a/c.vtk") && glob_match("a/**/c.vtk", "a/b/x/c.vtk") &&
+           glob_match("**/tmp/**", "x/tmp/y.vtk") && glob_match("step_??.vtp", "run/step_01.vtp");
+}
+
+static bool test_recursive_directory() {
+    const std::string inDir = "test_in_tree", outDir = "test_out_tree";
+    fs::remove_all(inDir); fs::remove_all(outDir);
+    fs::create_directories(inDir + "/caseA/cuts");
+    fs::create_directories(inDir + "/scratch");
+    fs::copy_file(std::string(TEST_DATA_DIR)+"/surface_sample.vtk", inDir+"/wall.vtk");
+    fs::copy_file(std::string(TEST_DATA_DIR)+"/slice_sample.vtp", inDir+"/caseA/cuts/slice_x.vtp");
+    fs::copy_file(std::string(TEST_DATA_DIR)+"/line_sample.vtp", inDir+"/caseA/stream_1.vtp");
+    fs::copy_file(std::string(TEST_DATA_DIR)+"/surface_sample.vtk", inDir+"/scratch/junk.vtk");
+    {
+        std::ofstream stl(inDir + "/caseA/part.stl");
+        stl << "solid part\nfacet normal 0 0 1\nouter loop\nvertex 0 0 0\nvertex 1 0 0\nvertex 0 1 0\nendloop\nendfacet\nendsolid part\n";
+    }
+
+    UVFOptions opts;
+    opts.recursive = true;
+    opts.exclude_globs.push_back("scratch");
+    opts.threads = 4;
+    std::vector<DiscoveredFile> files;
+    if(!discover_input_files(inDir, opts, files) || files.size()!=4) { std::cerr << "discovered " << files.size() << " files" << std::endl; return false; }
+    if(files[0].relative_path!="caseA/cuts/slice_x.vtp" || files[0].size==0) return false;
+
+    if(!process_directory_structure(inDir.c_str(), outDir.c_str(), opts)) return false;
+    std::string manifest = read_manifest(outDir);
+    for(const char* needle : {"\"id\":\"caseA\"", "\"id\":\"caseA/cuts\"", "\"id\":\"caseA/cuts/slices\"",
+                              "\"id\":\"caseA/streamlines\"", "\"caseA_part\"", "\"caseA_cuts_slice_x\"", "\"wall\""}) {
+        if(manifest.find(needle)==std::string::npos) { std::cerr << "manifest missing " << needle << std::endl; return false; }
+    }
+    if(manifest.find("junk")!=std::string::npos) return false;
+
+    UVFOptions flat; // top level only by default
+    return discover_input_files(inDir, flat, files) && files.size()==1;
+}
+
+// Cancelling a directory conversion keeps the previous output intact
+static bool test_cancel_directory() {
+    std::string inDir = "test_in_cancel";
+    std::string outDir = "test_out_cancel";
+    fs::remove_all(inDir); fs::remove_all(outDir);
+    fs::create_directories(inDir);
+    for (const char* name : {"a_slice.vtp", "b_slice.vtp", "c_slice.vtp"})
+        fs::copy_file(std::string(TEST_DATA_DIR) + "/slice_sample.vtp", inDir + "/" + name);
+
+    UVFOptions opts;
+    if(!process_directory_structure(inDir.c_str(), outDir.c_str(), opts)) return false;
+    std::string manifest = read_manifest(outDir);
+    auto before = bin_times(outDir);
+
+    std::atomic<bool> cancel(false);
+    int reports = 0;
+    opts.threads = 1;
+    opts.cancel = &cancel;
+    opts.progress = [&](const UVFProgress& p){
+        ++reports;
+        if (std::string(p.stage) == "convert" && p.items_done == 1) cancel = true;
+    };
+    if(process_directory_structure(inDir.c_str(), outDir.c_str(), opts)) { std::cerr << "cancelled directory conversion succeeded" << std::endl; return false; }
+    if(read_manifest(outDir) != manifest || bin_times(outDir) != before) { std::cerr << "cancel modified previous output" << std::endl; return false; }
+    for (auto& e : fs::directory_iterator(outDir))
+        if (e.path().extension() == ".tmp") { std::cerr << "leftover " << e.path() << std::endl; return false; }
+    if (reports < 2) return false;
+
+    // Time series: cancelled after the first step, no bins left behind
+    std::vector<std::string> files; std::vector<double> times;
+    for (int i = 0; i < 3; ++i) {
+        files.push_back(inDir + "/step" + std::to_string(i) + ".vtk");
+        times.push_back(i);
+        write_step_vtk(files.back(), 1.0f + i);
+    }
+    fs::remove_all("test_out_cancel_series");
+    cancel = false;
+    opts.progress = [&](const UVFProgress& p){
+        if (std::string(p.stage) == "convert" && p.items_done == 1) cancel = true;
+    };
+    if (generate_time_series_uvf(files, times, "test_out_cancel_series", opts)) { std::cerr << "cancelled time series succeeded" << std::endl; return false; }
+    for (auto& e : fs::directory_iterator("test_out_cancel_series")) { std::cerr << "leftover " << e.path() << std::endl; return false; }
+
+    // Structured: cancelled before the first entry
+    fs::remove_all("test_out_cancel_structured");
+    opts.progress = nullptr;
+    if (generate_structured_uvf(make_triangle(0.2), "test_out_cancel_structured", opts)) { std::cerr << "cancelled structured conversion succeeded" << std::endl; return false; }
+    if (file_exists("test_out_cancel_structured/manifest.json")) { std::cerr << "cancelled structured conversion wrote a manifest" << std::endl; return false; }
+    for (auto& e : fs::recursive_directory_iterator("test_out_cancel_structured"))
+        if (e.path().extension() == ".bin") { std::cerr << "leftover " << e.path() << std::endl; return false; }
+    return true;
+}
+
+static size_t count_of(const std::string& s, const std::string& needle){
+    size_t n = 0;
+    for(size_t pos = s.find(needle); pos != std::string::npos; pos = s.find(needle, pos + 1)) ++n;
+    return n;
+}
+
+// Parse dir/manifest.uvfm into view; bytes keeps the (4-byte aligned) image alive
+static bool open_binary_manifest(const std::string& dir, std::vector<uint32_t>& bytes, UVFBinaryManifestView& view){
+    std::vector<char> raw = read_bytes(dir + "/manifest.uvfm");
+    bytes.assign((raw.size() + 3) / 4, 0);
+    if(!raw.empty()) std::memcpy(bytes.data(), raw.data(), raw.size());
+    std::string error;
+    if(!view.parse(bytes.data(), raw.size(), error)) { std::cerr << dir << ": " << error << std::endl; return false; }
+    return true;
+}
+
+// The binary manifest carries the same nodes as manifest.json in all three modes
+static bool test_binary_manifest() {
+    // Single file with many face segments
+    const size_t face_count = 20000;
+    std::vector<float> positions = {0,0,0, 1,0,0, 0,1,0.25f};
+    std::vector<uint32_t> indices;
+    std::vector<float> pressure = {-2.5f, 0.5f, 7.0f};
+    for(size_t i=0;i<face_count;++i){ indices.push_back(0); indices.push_back(1); indices.push_back(2); }
+    UVFMeshView mesh;
+    mesh.positions = positions.data(); mesh.vertex_count = 3;
+    mesh.indices = indices.data(); mesh.index_count = indices.size();
+    mesh.attributes.push_back({"pressure", pressure.data(), pressure.size(), 1});
+    for(size_t i=0;i<face_count;++i) mesh.faces.push_back({"face_" + std::to_string(i), i*3, i*3+3});
+    mesh.geom_kind = "surface";
+    UVFOptions opts;
+    opts.binary_manifest = true;
+    fs::remove_all("test_out_bm_single");
+    if(!generate_uvf(mesh, "test_out_bm_single", opts)) return false;
+
+    std::vector<uint32_t> image;
+    UVFBinaryManifestView view;
+    if(!open_binary_manifest("test_out_bm_single", image, view)) return false;
+    std::string json = read_manifest("test_out_bm_single");
+    if(view.count(UVF_BM_GROUPS)!=1 || view.count(UVF_BM_SOLIDS)!=1 || view.count(UVF_BM_FACES)!=face_count ||
+       view.count(UVF_BM_SECTIONS)!=count_of(json, "\"dType\"")) { std::cerr << "binary manifest node counts differ" << std::endl; return false; }
+    const uint32_t* solid = view.record(UVF_BM_SOLIDS, 0);
+    if(view.string_at(solid[0])!="surfaces" || view.string_at(solid[1])!="surface" || view.string_at(solid[2])!=manifest_bin_path("test_out_bm_single") || solid[8]!=face_count) return false;
+    const uint32_t* last = view.record(UVF_BM_FACES, face_count-1);
+    if(view.string_at(last[0])!="face_19999" || view.string_at(last[1])!="surfaces" ||
+       UVFBinaryManifestView::u64(last+4)!=(face_count-1)*3 || UVFBinaryManifestView::u64(last+6)!=face_count*3) { std::cerr << "binary face record wrong" << std::endl; return false; }
+    bool ranged = false;
+    for(size_t i=0;i<view.count(UVF_BM_SECTIONS);++i){
+        const uint32_t* sec = view.record(UVF_BM_SECTIONS, i);
+        if(view.string_at(sec[1])=="pressure") ranged = sec[3]==1 && UVFBinaryManifestView::f32(sec[8])==-2.5f && UVFBinaryManifestView::f32(sec[9])==7.0f;
+    }
+    if(!ranged) { std::cerr << "binary section range missing" << std::endl; return false; }
+    size_t binary_size = fs::file_size("test_out_bm_single/manifest.uvfm");
+    if(binary_size * 3 > json.size()) { std::cerr << "binary manifest " << binary_size << " bytes vs JSON " << json.size() << std::endl; return false; }
+
+    // A manifest.json that cannot be written leaves neither bin nor binary manifest behind
+    fs::remove_all("test_out_bm_fail");
+    fs::create_directories("test_out_bm_fail/manifest.json");
+    if(generate_uvf(mesh, "test_out_bm_fail", opts)) { std::cerr << "blocked manifest.json not reported" << std::endl; return false; }
+    for(const auto& e : fs::directory_iterator("test_out_bm_fail"))
+        if(e.path().filename()!="manifest.json") { std::cerr << "orphaned " << e.path() << std::endl; return false; }
+
+    // Directory mode; turning the option off removes the stale binary manifest
+    const std::string inDir = "test_in_bm", outDir = "test_out_bm_dir";
+    fs::remove_all(inDir); fs::remove_all(outDir);
+    fs::create_directories(inDir);
+    for(const char* f : {"slice_sample.vtp", "line_sample.vtp", "surface_sample.vtk"})
+        fs::copy_file(std::string(TEST_DATA_DIR)+"/"+f, inDir+"/"+f);
+    if(!process_directory_structure(inDir.c_str(), outDir.c_str(), opts)) return false;
+    if(!open_binary_manifest(outDir, image, view)) return false;
+    json = read_manifest(outDir);
+    if(view.count(UVF_BM_FACES)!=3 || view.count(UVF_BM_SOLIDS)!=3 || view.count(UVF_BM_GROUPS)!=count_of(json, "GeometryGroup")) { std::cerr << "directory binary manifest counts differ" << std::endl; return false; }
+    for(size_t i=0;i<view.count(UVF_BM_FACES);++i){
+        const uint32_t* face = view.record(UVF_BM_FACES, i);
+        if(json.find("\"id\":\"" + view.string_at(face[0]) + "\"")==std::string::npos) return false;
+    }
+    if(!process_directory_structure(inDir.c_str(), outDir.c_str(), UVFOptions()) || file_exists(outDir + "/manifest.uvfm")) { std::cerr << "stale manifest.uvfm kept" << std::endl; return false; }
+
+    // Structured mode
+    auto poly = make_triangle(0.2);
+    fs::remove_all("test_out_bm_structured");
+    if(!generate_structured_uvf(poly, "test_out_bm_structured", opts)) return false;
+    if(!open_binary_manifest("test_out_bm_structured", image, view)) return false;
+    json = read_manifest("test_out_bm_structured");
+    return view.count(UVF_BM_SOLIDS)==count_of(json, "SolidGeometry") && view.count(UVF_BM_FACES)==count_of(json, "\"Face\"");
+}
+
+static std::string entry_string(const UVFContainerReader& pack, const std::string& name){
+    const UVFContainerReader::Entry* e = pack.find(name);
+    return e ? std::string(pack.data(*e), e->size) : std::string();
+}
+
+// Container output holds exactly what the loose layout would, in one file
+static bool test_container_output() {
+    UVFOptions loose;
+    loose.content_hash_names = true;
+    UVFOptions packed = loose;
+    packed.container = true;
+    packed.binary_manifest = true;
+    auto poly = make_triangle(0.2);
+    fs::remove_all("test_out_pack_loose"); fs::remove_all("test_out_pack_single");
+    if(!generate_uvf(poly, "test_out_pack_loose", loose) || !generate_uvf(poly, "test_out_pack_single", packed)) return false;
+    std::vector<std::string> left;
+    for(const auto& e : fs::directory_iterator("test_out_pack_single")) left.push_back(e.path().filename().string());
+    if(left != std::vector<std::string>{UVF_CONTAINER_NAME}) { std::cerr << "loose files left next to the container" << std::endl; return false; }
+
+    UVFContainerReader pack;
+    std::string error;
+    if(!pack.open(std::string("test_out_pack_single/") + UVF_CONTAINER_NAME, error)) { std::cerr << error << std::endl; return false; }
+    std::string bin = manifest_bin_path("test_out_pack_loose");
+    const UVFContainerReader::Entry* binEntry = pack.find(bin);
+    if(pack.entries().size()!=3 || pack.entries()[0].name!="manifest.json" || pack.entries()[1].kind!=UVF_CONTAINER_MANIFEST_BINARY || !binEntry) return false;
+    if(binEntry->offset % UVF_CONTAINER_ALIGNMENT != 0) { std::cerr << "bin not 4 KiB aligned" << std::endl; return false; }
+    std::vector<char> looseBin = read_bytes("test_out_pack_loose/" + bin);
+    if(entry_string(pack, "manifest.json")!=read_manifest("test_out_pack_loose") || entry_string(pack, bin)!=std::string(looseBin.begin(), looseBin.end())) {
+        std::cerr << "container entries differ from loose output" << std::endl; return false;
+    }
+
+    // Directory mode: leading '/' of manifest paths is accepted by find
+    const std::string inDir = "test_in_pack", outDir = "test_out_pack_dir";
+    fs::remove_all(inDir); fs::remove_all(outDir);
+    fs::create_directories(inDir);
+    for(const char* f : {"slice_sample.vtp", "line_sample.vtp", "surface_sample.vtk"})
+        fs::copy_file(std::string(TEST_DATA_DIR)+"/"+f, inDir+"/"+f);
+    packed.binary_manifest = false;
+    if(!process_directory_structure(inDir.c_str(), outDir.c_str(), packed)) return false;
+    if(file_exists(outDir + "/manifest.json") || file_exists(outDir + "/slice_sample.bin")) return false;
+    if(!pack.open(outDir + "/" + UVF_CONTAINER_NAME, error) || pack.entries().size()!=4 || !pack.find("/line_sample.bin")) { std::cerr << "directory container incomplete" << std::endl; return false; }
+    for(const auto& e : pack.entries()) if(e.kind==UVF_CONTAINER_BIN && (e.offset % UVF_CONTAINER_ALIGNMENT || e.size==0)) return false;
+
+    // Structured mode
+    fs::remove_all("test_out_pack_structured");
+    if(!generate_structured_uvf(poly, "test_out_pack_structured", packed)) return false;
+    return pack.open(std::string("test_out_pack_structured/") + UVF_CONTAINER_NAME, error) && pack.entries().size() >= 2 &&
+           !file_exists("test_out_pack_structured/manifest.json");
+}
+
+// Compressed sections inflate back to the raw arrays; block layout is in both manifests
+static bool test_section_compression() {
+    UVFOptions bad;
+    if(set_uvf_option(bad, "compression", "zstd") || set_uvf_option(bad, "compression_block_size", "100")) return false;
+
+    // Smooth fields on a strip: several 4 KiB blocks per section
+    const size_t n = 20000;
+    std::vector<float> positions, pressure;
+    std::vector<uint32_t> indices;
+    for(size_t i=0;i<n;++i){
+        positions.insert(positions.end(), {float(i/2), float(i%2), 0.0f});
+        pressure.push_back(float(i/2) * 0.5f);
+        if(i>=2){ indices.push_back(uint32_t(i-2)); indices.push_back(uint32_t(i-1)); indices.push_back(uint32_t(i)); }
+    }
+    UVFMeshView mesh;
+    mesh.positions = positions.data(); mesh.vertex_count = n;
+    mesh.indices = indices.data(); mesh.index_count = indices.size();
+    mesh.attributes.push_back({"pressure", pressure.data(), pressure.size(), 1});
+    UVFOptions opts;
+    opts.compression = "deflate";
+    opts.compression_block_size = 4096;
+    opts.threads = 4;
+    opts.binary_manifest = true;
+    fs::remove_all("test_out_deflate");
+    if(!generate_uvf(mesh, "test_out_deflate", opts)) return false;
+
+    std::string json = read_manifest("test_out_deflate");
+    if(count_of(json, "\"compression\":\"deflate\"")!=3 || count_of(json, "\"rawLength\":")!=3) { std::cerr << "compressed sections missing from manifest.json" << std::endl; return false; }
+    std::vector<char> bin = read_bytes("test_out_deflate/" + manifest_bin_path("test_out_deflate"));
+    size_t plain_size = (mesh.index_count + mesh.vertex_count * 3) * 4;
+    for(const auto& a : mesh.attributes) plain_size += a.count * 4;
+    if(bin.size() * 4 > plain_size) { std::cerr << "deflate bin is " << bin.size() << " bytes" << std::endl; return false; }
+
+    std::vector<uint32_t> image;
+    UVFBinaryManifestView view;
+    if(!open_binary_manifest("test_out_deflate", image, view)) return false;
+    std::map<std::string, std::pair<const void*, size_t>> raw = {
+        {"indices", {indices.data(), indices.size()*4}}, {"position", {positions.data(), positions.size()*4}}, {"pressure", {pressure.data(), pressure.size()*4}}};
+    for(size_t i=0;i<view.count(UVF_BM_SECTIONS);++i){
+        const uint32_t* sec = view.record(UVF_BM_SECTIONS, i);
+        UVFSectionBlocks layout;
+        layout.codec = view.string_at(sec[10]);
+        layout.block_size = sec[11];
+        for(uint32_t b=0;b<sec[13];++b) layout.sizes.push_back(view.record(UVF_BM_BLOCKS, sec[12]+b)[0]);
+        layout.raw_length = UVFBinaryManifestView::u64(sec+14);
+        const auto& expected = raw[view.string_at(sec[1])];
+        uint64_t offset = UVFBinaryManifestView::u64(sec+4), length = UVFBinaryManifestView::u64(sec+6);
+        if(!(sec[3] & 2) || layout.raw_length!=expected.second || layout.sizes.size() < 2 || offset + length > bin.size()) { std::cerr << "compressed section record wrong" << std::endl; return false; }
+        std::vector<char> out(layout.raw_length);
+        std::string error;
+        if(!decompress_section(bin.data() + offset, length, layout, out.data(), 2, error) || std::memcmp(out.data(), expected.first, out.size())!=0) {
+            std::cerr << view.string_at(sec[1]) << ": " << (error.empty() ? "inflated bytes differ" : error) << std::endl; return false;
+        }
+    }
+
+    // Directory mode: an incremental rerun reuses the cached block layout unchanged
+    const std::string inDir = "test_in_deflate", outDir = "test_out_deflate_dir";
+    fs::remove_all(inDir); fs::remove_all(outDir);
+    fs::create_directories(inDir);
+    for(const char* f : {"slice_sample.vtp", "surface_sample.vtk"})
+        fs::copy_file(std::string(TEST_DATA_DIR)+"/"+f, inDir+"/"+f);
+    opts.binary_manifest = false;
+    opts.incremental = true;
+    if(!process_directory_structure(inDir.c_str(), outDir.c_str(), opts)) return false;
+    json = read_manifest(outDir);
+    if(!process_directory_structure(inDir.c_str(), outDir.c_str(), opts)) return false;
+    return count_of(json, "\"blocks\":[")==count_of(json, "\"dType\"") && read_manifest(outDir)==json;
+}
+
+// Mesh codecs round-trip exactly, alone and under block compression
+static bool test_mesh_codecs() {
+    std::vector<uint32_t> jumps = {0, 0xFFFFFFFFu, 5, 5, 1u << 31, 7};
+    std::string varints;
+    encode_indices_delta_varint(jumps.data(), jumps.size(), varints);
+    std::vector<uint32_t> back(jumps.size());
+    if(!decode_indices_delta_varint(varints.data(), varints.size(), back.data(), back.size()) || back!=jumps) { std::cerr << "varint round trip failed" << std::endl; return false; }
+    if(decode_indices_delta_varint(varints.data(), varints.size()-1, back.data(), back.size())) { std::cerr << "truncated varints accepted" << std::endl; return false; }
+
+    // Bumpy strip; geometry sections encoded, the attribute left plain
+    const size_t n = 6000;
+    std::vector<float> positions, temperature;
+    std::vector<uint32_t> indices;
+    for(size_t i=0;i<n;++i){
+        positions.insert(positions.end(), {float(i/2) * 0.1f, float(i%2), std::sin(float(i) * 0.01f)});
+        temperature.push_back(300.0f + float(i % 17));
+        if(i>=2){ indices.push_back(uint32_t(i-2)); indices.push_back(uint32_t(i-1)); indices.push_back(uint32_t(i)); }
+    }
+    UVFMeshView mesh;
+    mesh.positions = positions.data(); mesh.vertex_count = n;
+    mesh.indices = indices.data(); mesh.index_count = indices.size();
+    mesh.attributes.push_back({"temperature", temperature.data(), temperature.size(), 1});
+    for(const char* compression : {"none", "deflate"}){
+        UVFOptions opts;
+        opts.mesh_codecs = true;
+        opts.compression = compression;
+        opts.binary_manifest = true;
+        const std::string dir = std::string("test_out_codecs_") + compression;
+        fs::remove_all(dir);
+        if(!generate_uvf(mesh, dir.c_str(), opts)) return false;
+        std::string json = read_manifest(dir);
+        if(count_of(json, "\"encoding\":\"delta-varint\"")!=1 || count_of(json, "\"encoding\":\"byteplane-delta\"")!=1 || count_of(json, "\"decodedLength\":")!=2) { std::cerr << "encoded sections missing from manifest.json" << std::endl; return false; }
+        std::vector<char> bin = read_bytes(dir + "/" + manifest_bin_path(dir));
+        std::vector<uint32_t> image;
+        UVFBinaryManifestView view;
+        if(!open_binary_manifest(dir, image, view)) return false;
+        for(size_t i=0;i<view.count(UVF_BM_SECTIONS);++i){
+            const uint32_t* sec = view.record(UVF_BM_SECTIONS, i);
+            std::string name = view.string_at(sec[1]);
+            std::vector<char> stored(bin.begin() + UVFBinaryManifestView::u64(sec+4), bin.begin() + UVFBinaryManifestView::u64(sec+4) + UVFBinaryManifestView::u64(sec+6));
+            if(sec[3] & 2){
+                UVFSectionBlocks layout;
+                layout.codec = view.string_at(sec[10]);
+                layout.block_size = sec[11];
+                for(uint32_t b=0;b<sec[13];++b) layout.sizes.push_back(view.record(UVF_BM_BLOCKS, sec[12]+b)[0]);
+                layout.raw_length = UVFBinaryManifestView::u64(sec+14);
+                std::vector<char> raw(layout.raw_length);
+                std::string error;
+                if(!decompress_section(stored.data(), stored.size(), layout, raw.data(), 1, error)) { std::cerr << error << std::endl; return false; }
+                stored.swap(raw);
+            }
+            std::string encoding = sec[16]==UVF_BM_NONE ? "" : view.string_at(sec[16]);
+            size_t decoded = UVFBinaryManifestView::u64(sec+17);
+            bool ok;
+            if(name=="indices"){
+                std::vector<uint32_t> out(decoded / 4);
+                ok = encoding==UVF_INDEX_ENCODING && decode_indices_delta_varint(stored.data(), stored.size(), out.data(), out.size()) && out==indices;
+            } else if(name=="position"){
+                std::vector<float> out(decoded / 4);
+                decode_byteplane_delta(stored.data(), n, 3, out.data());
+                ok = encoding==UVF_VECTOR_ENCODING && stored.size()==decoded && std::memcmp(out.data(), positions.data(), decoded)==0;
+            } else {
+                ok = encoding.empty() && stored.size()==decoded && std::memcmp(stored.data(), temperature.data(), decoded)==0;
+            }
+            if(!ok) { std::cerr << dir << ": section " << name << " does not decode" << std::endl; return false; }
+        }
+    }
+    return true;
+}
+
+// Constant arrays store no bytes; duplicates share the first copy's bytes
+static bool test_section_elision() {
+    const size_t n = 4000;
+    std::vector<float> positions, temperature, wall(n, 0.5f);
+    std::vector<uint32_t> indices;
+    for(size_t i=0;i<n;++i){
+        positions.insert(positions.end(), {float(i/2), float(i%2), 0.0f});
+        temperature.push_back(300.0f + float(i % 17));
+        if(i>=2){ indices.push_back(uint32_t(i-2)); indices.push_back(uint32_t(i-1)); indices.push_back(uint32_t(i)); }
+    }
+    std::vector<float> copy = temperature;
+    UVFMeshView mesh;
+    mesh.positions = positions.data(); mesh.vertex_count = n;
+    mesh.indices = indices.data(); mesh.index_count = indices.size();
+    mesh.attributes.push_back({"temperature", temperature.data(), temperature.size(), 1});
+    mesh.attributes.push_back({"temperature_copy", copy.data(), copy.size(), 1});
+    mesh.attributes.push_back({"wall", wall.data(), wall.size(), 1});
+    for(const char* compression : {"none", "deflate"}){
+        UVFOptions opts;
+        opts.elide_sections = true;
+        opts.compression = compression;
+        opts.binary_manifest = true;
+        const std::string dir = std::string("test_out_elide_") + compression;
+        fs::remove_all(dir);
+        if(!generate_uvf(mesh, dir.c_str(), opts)) return false;
+        std::string json = read_manifest(dir);
+        if(count_of(json, "\"encoding\":\"constant\"")!=1 || count_of(json, "\"constant\":0.5,")!=1) { std::cerr << "constant section missing from manifest.json" << std::endl; return false; }
+        std::vector<uint32_t> image;
+        UVFBinaryManifestView view;
+        if(!open_binary_manifest(dir, image, view)) return false;
+        std::map<std::string, const uint32_t*> sections;
+        for(size_t i=0;i<view.count(UVF_BM_SECTIONS);++i) sections[view.string_at(view.record(UVF_BM_SECTIONS, i)[1])] = view.record(UVF_BM_SECTIONS, i);
+        const uint32_t* t = sections["temperature"];
+        const uint32_t* c = sections["temperature_copy"];
+        const uint32_t* w = sections["wall"];
+        if(!t || !c || !w) return false;
+        if(UVFBinaryManifestView::u64(c+4)!=UVFBinaryManifestView::u64(t+4) || UVFBinaryManifestView::u64(c+6)!=UVFBinaryManifestView::u64(t+6) ||
+           c[13]!=t[13] || (c[13] && view.record(UVF_BM_BLOCKS, c[12])[0]!=view.record(UVF_BM_BLOCKS, t[12])[0])) { std::cerr << dir << ": duplicate not aliased" << std::endl; return false; }
+        if(UVFBinaryManifestView::u64(w+6)!=0 || view.string_at(w[16])!=UVF_CONSTANT_ENCODING ||
+           UVFBinaryManifestView::u64(w+17)!=n*4 || UVFBinaryManifestView::f32(w[19])!=0.5f) { std::cerr << dir << ": constant record wrong" << std::endl; return false; }
+        size_t stored = 0;
+        for(const auto& kv : sections) if(kv.second!=c) stored += UVFBinaryManifestView::u64(kv.second+6);
+        if(fs::file_size(dir + "/" + manifest_bin_path(dir))!=stored) { std::cerr << dir << ": bin holds elided bytes" << std::endl; return false; }
+    }
+    // Off by default: every array stored
+    UVFOptions plain;
+    fs::remove_all("test_out_elide_off");
+    if(!generate_uvf(mesh, "test_out_elide_off", plain)) return false;
+    return count_of(read_manifest("test_out_elide_off"), "\"constant\"")==0 &&
+           fs::file_size("test_out_elide_off/" + manifest_bin_path("test_out_elide_off"))==(positions.size()+indices.size()+3*n)*4;
+}
+
+static bool near3(const float* n, float x, float y, float z){
+    return std::fabs(n[0]-x)<1e-4f && std::fabs(n[1]-y)<1e-4f && std::fabs(n[2]-z)<1e-4f;
+}
+
+// Normals stay per face (hard edge at the fold), match across thread counts
+// and survive the oct16 round trip
+static bool test_vertex_normals() {
+    // Two triangles folded 90 degrees along the edge 0-2
+    std::vector<float> positions = {0,0,0, 1,0,0, 0,1,0, 0,0,1};
+    std::vector<uint32_t> indices = {0,1,2, 0,2,3};
+    UVFMeshView mesh;
+    mesh.positions = positions.data(); mesh.vertex_count = 4;
+    mesh.indices = indices.data(); mesh.index_count = indices.size();
+    std::vector<float> smooth(12), hard(12);
+    compute_vertex_normals(mesh, 1, smooth.data());
+    const float h = std::sqrt(0.5f);
+    if(!near3(&smooth[0], h,0,h) || !near3(&smooth[6], h,0,h) || !near3(&smooth[3], 0,0,1) || !near3(&smooth[9], 1,0,0)) { std::cerr << "smooth normals wrong" << std::endl; return false; }
+    mesh.faces = {{"bottom", 0, 3}, {"side", 3, 6}};
+    compute_vertex_normals(mesh, 1, hard.data());
+    if(!near3(&hard[0], 0,0,1) || !near3(&hard[6], 0,0,1) || !near3(&hard[9], 1,0,0)) { std::cerr << "face normals smoothed across the edge" << std::endl; return false; }
+
+    // Written sections: float32 as computed, oct16 decodes within quantisation error
+    const size_t n = 20000;
+    std::vector<float> wave;
+    std::vector<uint32_t> strip;
+    for(size_t i=0;i<n;++i){
+        wave.insert(wave.end(), {float(i/2) * 0.05f, float(i%2), std::sin(float(i) * 0.003f)});
+        if(i>=2){ strip.push_back(uint32_t(i-2)); strip.push_back(uint32_t(i-1)); strip.push_back(uint32_t(i)); }
+    }
+    UVFMeshView big;
+    big.positions = wave.data(); big.vertex_count = n;
+    big.indices = strip.data(); big.index_count = strip.size();
+    big.faces = {{"front", 0, strip.size() / 2 / 3 * 3}, {"back", strip.size() / 2 / 3 * 3, strip.size()}};
+    std::vector<float> one(n * 3), many(n * 3);
+    compute_vertex_normals(big, 1, one.data());
+    compute_vertex_normals(big, 4, many.data());
+    if(one!=many) { std::cerr << "normals depend on the thread count" << std::endl; return false; }
+    for(const char* mode : {"float32", "oct16"}){
+        UVFOptions opts;
+        opts.normals = mode;
+        const std::string dir = std::string("test_out_normals_") + mode;
+        fs::remove_all(dir);
+        if(!generate_uvf(big, dir.c_str(), opts)) return false;
+        std::string json = read_manifest(dir);
+        auto at = json.find("\"name\":\"normal\"");
+        if(at==std::string::npos) { std::cerr << "normal section missing" << std::endl; return false; }
+        size_t section = json.rfind('{', at);
+        size_t offset = std::stoull(json.substr(json.find("\"offset\":", section) + 9));
+        std::vector<char> bin = read_bytes(dir + "/" + manifest_bin_path(dir));
+        std::vector<float> got(n * 3);
+        if(std::string(mode)=="float32"){
+            std::memcpy(got.data(), bin.data() + offset, n * 12);
+            if(got!=one) { std::cerr << "float32 normals differ" << std::endl; return false; }
+        } else {
+            if(json.find("\"encoding\":\"oct16\"", section)==std::string::npos) { std::cerr << "oct16 encoding not named" << std::endl; return false; }
+            std::vector<int16_t> oct(n * 2);
+            std::memcpy(oct.data(), bin.data() + offset, n * 4);
+            decode_normals_oct16(oct.data(), n, got.data());
+            for(size_t i=0;i<n*3;++i) if(std::fabs(got[i]-one[i])>1e-3f) { std::cerr << "oct16 normal " << i/3 << " off" << std::endl; return false; }
+        }
+    }
+
+    // Written fold: the shared vertices 0 and 2 are split, every corner shades with its own face's normal
+    UVFOptions opts;
+    opts.normals = "float32";
+    opts.feature_edges = true;
+    opts.binary_manifest = true;
+    fs::remove_all("test_out_normals_fold");
+    if(!generate_uvf(mesh, "test_out_normals_fold", opts)) return false;
+    std::vector<uint32_t> image;
+    UVFBinaryManifestView view;
+    if(!open_binary_manifest("test_out_normals_fold", image, view)) return false;
+    std::vector<char> bin = read_bytes("test_out_normals_fold/" + manifest_bin_path("test_out_normals_fold"));
+    std::map<std::string, const char*> data;
+    std::map<std::string, uint64_t> bytes;
+    for(size_t i=0;i<view.count(UVF_BM_SECTIONS);++i){
+        const uint32_t* sec = view.record(UVF_BM_SECTIONS, i);
+        data[view.string_at(sec[1])] = bin.data() + UVFBinaryManifestView::u64(sec + 4);
+        bytes[view.string_at(sec[1])] = UVFBinaryManifestView::u64(sec + 6);
+    }
+    if(bytes["position"]!=6*12 || bytes["normal"]!=6*12) { std::cerr << "face boundary vertices not split" << std::endl; return false; }
+    const uint32_t* idx = reinterpret_cast<const uint32_t*>(data["indices"]);
+    const float* pos = reinterpret_cast<const float*>(data["position"]);
+    const float* nrm = reinterpret_cast<const float*>(data["normal"]);
+    for(size_t i=0;i<6;++i){
+        if(std::memcmp(pos + idx[i]*3, &positions[indices[i]*3], 12)!=0) return false;
+        bool bottom = i < 3;
+        if(bottom && !near3(nrm + idx[i]*3, 0, 0, 1)) { std::cerr << "bottom corner " << i << " has the wrong normal" << std::endl; return false; }
+        if(!bottom && !near3(nrm + idx[i]*3, 1, 0, 0)) { std::cerr << "side corner " << i << " has the wrong normal" << std::endl; return false; }
+    }
+    // Edges still refer to the unsplit vertices
+    const uint32_t* fold = reinterpret_cast<const uint32_t*>(data["featureEdges"]);
+    return bytes["featureEdges"]==8 && fold[0]==0 && fold[1]==2;
+}
+
+// "faceId" maps every triangle to its Face; last section of the bin
+static bool test_face_ids() {
+    const size_t face_count = 300;
+    std::vector<float> positions = {0,0,0, 1,0,0, 0,1,0};
+    std::vector<uint32_t> indices;
+    UVFMeshView mesh;
+    for(size_t i=0;i<=face_count;++i){ indices.push_back(0); indices.push_back(1); indices.push_back(2); }
+    // Reversed order, one triangle each; the last triangle belongs to no face
+    for(size_t i=0;i<face_count;++i){
+        size_t t = face_count - 1 - i;
+        mesh.faces.push_back({"face_" + std::to_string(i), t*3, t*3+3});
+    }
+    mesh.positions = positions.data(); mesh.vertex_count = 3;
+    mesh.indices = indices.data(); mesh.index_count = indices.size();
+    UVFOptions opts;
+    opts.face_ids = true;
+    fs::remove_all("test_out_face_ids");
+    if(!generate_uvf(mesh, "test_out_face_ids", opts)) return false;
+    std::string json = read_manifest("test_out_face_ids");
+    auto at = json.find("\"name\":\"faceId\"");
+    if(at==std::string::npos) { std::cerr << "faceId section missing" << std::endl; return false; }
+    size_t section = json.rfind('{', at);
+    if(json.find("\"dType\":\"uint16\"", section)!=section+1) { std::cerr << "faceId not uint16" << std::endl; return false; }
+    size_t offset = std::stoull(json.substr(json.find("\"offset\":", section) + 9));
+    std::vector<char> bin = read_bytes("test_out_face_ids/" + manifest_bin_path("test_out_face_ids"));
+    if(bin.size()!=offset + (face_count+1)*2) { std::cerr << "faceId not last in the bin" << std::endl; return false; }
+    std::vector<uint16_t> ids(face_count+1);
+    std::memcpy(ids.data(), bin.data() + offset, ids.size()*2);
+    for(size_t t=0;t<face_count;++t) if(ids[t]!=face_count-1-t) { std::cerr << "triangle " << t << " has face " << ids[t] << std::endl; return false; }
+    if(ids[face_count]!=0xFFFF) return false;
+
+    // VTK path: one face, uint8
+    auto poly = make_triangle(0.5);
+    if(convert(poly, "test_out_face_ids_vtk", opts).empty()) return false;
+    json = read_manifest("test_out_face_ids_vtk");
+    return json.find("\"dType\":\"uint8\",\"dimension\":1,\"length\":1,\"name\":\"faceId\"")!=std::string::npos;
+}
+
+static bool box_contains(const UVFBvhNode& outer, const float* lo, const float* hi){
+    for(int a=0;a<3;++a) if(lo[a]<outer.min[a] || hi[a]>outer.max[a]) return false;
+    return true;
+}
+
+// BVH covers every triangle once, nests its bounds, does not depend on the
+// thread count and answers rays like brute force
+static bool test_mesh_bvh() {
+    const size_t w = 160;
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+    for(size_t y=0;y<w;++y) for(size_t x=0;x<w;++x)
+        positions.insert(positions.end(), {float(x), float(y), std::sin(float(x) * 0.2f) * std::cos(float(y) * 0.15f) * 4.0f});
+    for(size_t y=0;y+1<w;++y) for(size_t x=0;x+1<w;++x){
+        uint32_t v = uint32_t(y*w + x);
+        indices.insert(indices.end(), {v, v+1, v+uint32_t(w), v+1, v+uint32_t(w)+1, v+uint32_t(w)});
+    }
+    UVFMeshView mesh;
+    mesh.positions = positions.data(); mesh.vertex_count = w*w;
+    mesh.indices = indices.data(); mesh.index_count = indices.size();
+    const size_t tri_count = indices.size() / 3;
+    std::vector<UVFBvhNode> nodes, nodes4;
+    std::vector<uint32_t> tris, tris4;
+    build_mesh_bvh(mesh, 1, nodes, tris);
+    build_mesh_bvh(mesh, 4, nodes4, tris4);
+    if(tris!=tris4 || nodes.size()!=nodes4.size() || std::memcmp(nodes.data(), nodes4.data(), nodes.size()*sizeof(UVFBvhNode))!=0) { std::cerr << "BVH depends on the thread count" << std::endl; return false; }
+    std::vector<int> seen(tri_count, 0);
+    for(size_t i=0;i<nodes.size();++i){
+        const UVFBvhNode& n = nodes[i];
+        if(n.count==0){
+            if(n.offset<=i+1 || n.offset>=nodes.size() || !box_contains(n, nodes[i+1].min, nodes[i+1].max) || !box_contains(n, nodes[n.offset].min, nodes[n.offset].max)) { std::cerr << "BVH node " << i << " malformed" << std::endl; return false; }
+            continue;
+        }
+        if(n.count>UVF_BVH_MAX_LEAF_TRIANGLES || n.offset+n.count>tri_count) return false;
+        for(uint32_t k=n.offset;k<n.offset+n.count;++k){
+            ++seen[tris[k]];
+            for(int c=0;c<3;++c){
+                const float* p = &positions[size_t(indices[size_t(tris[k])*3+c])*3];
+                if(!box_contains(n, p, p)) { std::cerr << "triangle outside its leaf" << std::endl; return false; }
+            }
+        }
+    }
+    if(std::count(seen.begin(), seen.end(), 1)!=long(tri_count)) { std::cerr << "BVH leaves do not cover every triangle once" << std::endl; return false; }
+    for(int r=0;r<200;++r){
+        float origin[3] = {float(r % 150) + 0.37f, float(r * 7 % 150) + 0.61f, 10.0f};
+        float dir[3] = {0.013f * float(r % 5), -0.011f * float(r % 3), -1.0f};
+        float t = 0, best = std::numeric_limits<float>::max();
+        int64_t hit = intersect_mesh_bvh(mesh, nodes, tris, origin, dir, t);
+        int64_t brute = -1;
+        std::vector<UVFBvhNode> one(1, UVFBvhNode{{-1e9f,-1e9f,-1e9f},{1e9f,1e9f,1e9f},0,1});
+        for(uint32_t k=0;k<tri_count;++k){
+            std::vector<uint32_t> single(1, k);
+            float d;
+            if(intersect_mesh_bvh(mesh, one, single, origin, dir, d)>=0 && d<best){ best = d; brute = k; }
+        }
+        if(hit!=brute || (hit>=0 && std::fabs(t-best)>1e-4f)) { std::cerr << "ray " << r << " hit " << hit << " instead of " << brute << std::endl; return false; }
+    }
+
+    // Written as two uint32 sections
+    UVFOptions opts;
+    opts.bvh = true;
+    fs::remove_all("test_out_bvh");
+    if(!generate_uvf(mesh, "test_out_bvh", opts)) return false;
+    std::string json = read_manifest("test_out_bvh");
+    return json.find("\"dType\":\"uint32\",\"dimension\":8,\"length\":" + std::to_string(nodes.size()*32) + ",\"name\":\"bvhNodes\"")!=std::string::npos &&
+           json.find("\"length\":" + std::to_string(tri_count*4) + ",\"name\":\"bvhTriangles\"")!=std::string::npos;
+}
+
+static std::vector<uint32_t> edges_of(const UVFMeshView& mesh, float angle, int cls){
+    UVFMeshEdges edges;
+    extract_feature_edges(mesh, angle, 1, edges);
+    return edges.lines[cls];
+}
+
+// Boundary, non-manifold and feature edges, and their Edge nodes
+static bool test_feature_edges() {
+    // Two triangles folded 90 degrees along 0-2; a third one on 0-2 makes it non-manifold
+    std::vector<float> positions = {0,0,0, 1,0,0, 0,1,0, 0,0,1, -1,0,-1};
+    std::vector<uint32_t> indices = {0,1,2, 0,2,3, 2,0,4};
+    UVFMeshView mesh;
+    mesh.positions = positions.data(); mesh.vertex_count = 5;
+    mesh.indices = indices.data(); mesh.index_count = 6;
+    if(edges_of(mesh, 30, UVF_FEATURE_EDGES)!=std::vector<uint32_t>{0,2} || edges_of(mesh, 30, UVF_BOUNDARY_EDGES).size()!=8) { std::cerr << "fold edge not classified" << std::endl; return false; }
+    if(!edges_of(mesh, 120, UVF_FEATURE_EDGES).empty()) { std::cerr << "edge below the feature angle kept" << std::endl; return false; }
+    mesh.index_count = 9;
+    if(edges_of(mesh, 30, UVF_NON_MANIFOLD_EDGES)!=std::vector<uint32_t>{0,2} || !edges_of(mesh, 30, UVF_FEATURE_EDGES).empty()) { std::cerr << "non-manifold edge not classified" << std::endl; return false; }
+    // Flat, but split between two faces
+    std::vector<float> flat = {0,0,0, 1,0,0, 0,1,0, 1,1,0};
+    std::vector<uint32_t> quad = {0,1,2, 1,3,2};
+    UVFMeshView faces;
+    faces.positions = flat.data(); faces.vertex_count = 4;
+    faces.indices = quad.data(); faces.index_count = 6;
+    if(!edges_of(faces, 30, UVF_FEATURE_EDGES).empty()) return false;
+    faces.faces = {{"a", 0, 3}, {"b", 3, 6}};
+    if(edges_of(faces, 30, UVF_FEATURE_EDGES)!=std::vector<uint32_t>{1,2}) { std::cerr << "face border not a feature edge" << std::endl; return false; }
+
+    // Bumpy grid: independent of the thread count
+    const size_t w = 120;
+    std::vector<float> grid;
+    std::vector<uint32_t> tris;
+    for(size_t y=0;y<w;++y) for(size_t x=0;x<w;++x) grid.insert(grid.end(), {float(x), float(y), float((x*7 + y*13) % 5)});
+    for(size_t y=0;y+1<w;++y) for(size_t x=0;x+1<w;++x){
+        uint32_t v = uint32_t(y*w + x);
+        tris.insert(tris.end(), {v, v+1, v+uint32_t(w), v+1, v+uint32_t(w)+1, v+uint32_t(w)});
+    }
+    UVFMeshView bumpy;
+    bumpy.positions = grid.data(); bumpy.vertex_count = w*w;
+    bumpy.indices = tris.data(); bumpy.index_count = tris.size();
+    UVFMeshEdges one, many;
+    extract_feature_edges(bumpy, 30, 1, one);
+    extract_feature_edges(bumpy, 30, 4, many);
+    for(int c=0;c<UVF_EDGE_CLASS_COUNT;++c) if(one.lines[c]!=many.lines[c]) { std::cerr << "edges depend on the thread count" << std::endl; return false; }
+    if(one.lines[UVF_BOUNDARY_EDGES].size()!=(w-1)*4*2 || one.lines[UVF_FEATURE_EDGES].empty()) { std::cerr << "grid edges wrong" << std::endl; return false; }
+
+    // Edge nodes in manifest.json and manifest.uvfm
+    mesh.index_count = 6;
+    UVFOptions opts;
+    opts.feature_edges = true;
+    opts.binary_manifest = true;
+    fs::remove_all("test_out_edges");
+    if(!generate_uvf(mesh, "test_out_edges", opts)) return false;
+    std::string json = read_manifest("test_out_edges");
+    if(count_of(json, "\"type\":\"Edge\"")!=2 || json.find("\"edges\":[\"surfaces_boundaryEdges\",\"surfaces_featureEdges\"]")==std::string::npos ||
+       json.find("\"featureEdges\":[{\"bufNum\":0,\"endIndex\":2,\"startIndex\":0}]")==std::string::npos) { std::cerr << "Edge nodes missing from manifest.json" << std::endl; return false; }
+    std::vector<uint32_t> image;
+    UVFBinaryManifestView view;
+    if(!open_binary_manifest("test_out_edges", image, view)) return false;
+    const uint32_t* solid = view.record(UVF_BM_SOLIDS, 0);
+    if(view.count(UVF_BM_EDGES)!=2 || solid[6]!=2) { std::cerr << "binary edge records missing" << std::endl; return false; }
+    const uint32_t* feature = view.record(UVF_BM_EDGES, 1);
+    if(view.string_at(feature[0])!="surfaces_featureEdges" || view.string_at(feature[4])!="featureEdges" || UVFBinaryManifestView::u64(feature+7)!=2) return false;
+
+    // Directory mode
+    const std::string inDir = "test_in_edges", outDir = "test_out_edges_dir";
+    fs::remove_all(inDir); fs::remove_all(outDir);
+    fs::create_directories(inDir);
+    fs::copy_file(std::string(TEST_DATA_DIR)+"/surface_sample.vtk", inDir+"/surface_sample.vtk");
+    if(!process_directory_structure(inDir.c_str(), outDir.c_str(), opts)) return false;
+    return count_of(read_manifest(outDir), "\"type\":\"Edge\"")>0;
+}
+
+static bool test_spatial_reorder() {
+    // Grid with shuffled vertices and triangles split between two faces
+    const size_t w = 90, n = w*w;
+    std::vector<uint32_t> shuffle(n);
+    std::iota(shuffle.begin(), shuffle.end(), 0u);
+    std::shuffle(shuffle.begin(), shuffle.end(), std::mt19937(7));
+    std::vector<float> positions(n*3), value(n);
+    for(size_t y=0;y<w;++y) for(size_t x=0;x<w;++x){
+        uint32_t v = shuffle[y*w + x];
+        positions[v*3] = float(x); positions[v*3+1] = float(y); positions[v*3+2] = float((x*3 + y) % 4);
+        value[v] = float(x*1000 + y);
+    }
+    std::vector<uint32_t> indices;
+    for(size_t y=0;y+1<w;++y) for(size_t x=0;x+1<w;++x){
+        uint32_t a = shuffle[y*w+x], b = shuffle[y*w+x+1], c = shuffle[(y+1)*w+x], d = shuffle[(y+1)*w+x+1];
+        indices.insert(indices.end(), {a, b, c, b, d, c});
+    }
+    indices.insert(indices.end(), {shuffle[0], shuffle[1], shuffle[1]}); // line segment
+    UVFMeshView mesh;
+    mesh.positions = positions.data(); mesh.vertex_count = n;
+    mesh.indices = indices.data(); mesh.index_count = indices.size();
+    mesh.attributes.push_back({"value", value.data(), n, 1});
+    size_t half = (indices.size() / 6) * 3;
+    mesh.faces = {{"a", 0, half}, {"b", half, indices.size()}};
+
+    UVFReorderedMesh one, many;
+    reorder_mesh_morton(mesh, 1, one);
+    reorder_mesh_morton(mesh, 4, many);
+    if(one.positions!=many.positions || one.indices!=many.indices || one.attributes!=many.attributes) { std::cerr << "reorder depends on the thread count" << std::endl; return false; }
+    for(size_t v=0;v<n;++v) if(one.attributes[0][v]!=one.positions[v*3]*1000 + one.positions[v*3+1]) { std::cerr << "attribute not remapped with its vertex" << std::endl; return false; }
+    // Same triangles (by corner coordinates, winding kept) in each face
+    auto corners = [](const float* pos, const uint32_t* idx, size_t begin, size_t end) {
+        std::vector<std::vector<float>> tris;
+        for(size_t t=begin;t<end;t+=3){
+            std::vector<float> tri;
+            size_t first = 0; // rotate to the corner with the smallest coordinates, as reorder may rotate
+            for(size_t k=1;k<3;++k) if(std::lexicographical_compare(pos+idx[t+k]*3, pos+idx[t+k]*3+3, pos+idx[t+first]*3, pos+idx[t+first]*3+3)) first = k;
+            bool line = idx[t]==idx[t+1] || idx[t+1]==idx[t+2] || idx[t]==idx[t+2];
+            for(size_t k=0;k<3;++k){ const float* p = pos + idx[t + (line ? k : (first+k)%3)]*3; tri.insert(tri.end(), p, p+3); }
+            tris.push_back(tri);
+        }
+        std::sort(tris.begin(), tris.end());
+        return tris;
+    };
+    for(const auto& f : mesh.faces)
+        if(corners(positions.data(), indices.data(), f.startIndex, f.endIndex)!=corners(one.positions.data(), one.indices.data(), f.startIndex, f.endIndex)) { std::cerr << "face triangles changed" << std::endl; return false; }
+    if(one.view.indices!=one.indices.data() || one.view.faces.size()!=2 || one.view.attributes[0].data!=one.attributes[0].data()) return false;
+    // Overlapping faces (allowed by the raw-mesh API) keep their triangles too
+    UVFMeshView overlapping = mesh;
+    overlapping.faces = {{"a", 0, half + 3000}, {"b", half - 3000, indices.size()}, {"c", 300, 9000}};
+    UVFReorderedMesh shared;
+    reorder_mesh_morton(overlapping, 4, shared);
+    for(const auto& f : overlapping.faces)
+        if(corners(positions.data(), indices.data(), f.startIndex, f.endIndex)!=corners(shared.positions.data(), shared.indices.data(), f.startIndex, f.endIndex)) { std::cerr << "overlapping face triangles changed" << std::endl; return false; }
+
+    // Neighbours end up close in the index space, and the bin compresses better
+    auto spread = [](const std::vector<uint32_t>& idx){ uint64_t s=0; for(size_t t=0;t<idx.size();t+=3) s += std::max({idx[t],idx[t+1],idx[t+2]}) - std::min({idx[t],idx[t+1],idx[t+2]}); return s; };
+    if(spread(one.indices)*20 > spread(indices)) { std::cerr << "reordered triangles not local" << std::endl; return false; }
+    UVFOptions opts;
+    opts.compression = "deflate";
+    opts.mesh_codecs = true;
+    fs::remove_all("test_out_reorder_off"); fs::remove_all("test_out_reorder_on");
+    if(!generate_uvf(mesh, "test_out_reorder_off", opts)) return false;
+    opts.reorder = "morton";
+    if(!generate_uvf(mesh, "test_out_reorder_on", opts)) return false;
+    size_t off = fs::file_size("test_out_reorder_off/" + manifest_bin_path("test_out_reorder_off"));
+    size_t on = fs::file_size("test_out_reorder_on/" + manifest_bin_path("test_out_reorder_on"));
+    if(on >= off) { std::cerr << "reordered bin not smaller" << std::endl; return false; }
+    UVFOptions bad;
+    return uvf_options_key(opts).find(";reorder=morton")!=std::string::npos && !set_uvf_option(bad, "reorder", "hilbert");
+}
+
+static bool test_interleaved_vertices() {
+    const size_t n = 500;
+    std::vector<float> positions, a(n), b(n*3);
+    std::vector<uint32_t> strip;
+    for(size_t i=0;i<n;++i){
+        positions.insert(positions.end(), {float(i/2), float(i%2), float(i%7)});
+        a[i] = float(i) * 0.5f;
+        b[i*3] = float(i); b[i*3+1] = -float(i); b[i*3+2] = 7;
+        if(i>=2) strip.insert(strip.end(), {uint32_t(i-2), uint32_t(i-1), uint32_t(i)});
+    }
+    UVFMeshView mesh;
+    mesh.positions = positions.data(); mesh.vertex_count = n;
+    mesh.indices = strip.data(); mesh.index_count = strip.size();
+    mesh.attributes = {{"b", b.data(), n*3, 3}, {"a", a.data(), n, 1}};
+
+    // Interleaved only: position, normal, then attributes by name
+    UVFOptions opts;
+    opts.normals = "float32";
+    opts.vertex_layout = "interleaved";
+    opts.binary_manifest = true;
+    fs::remove_all("test_out_interleaved");
+    if(!generate_uvf(mesh, "test_out_interleaved", opts)) return false;
+    std::string json = read_manifest("test_out_interleaved");
+    if(json.find("{\"attributes\":[{\"dimension\":3,\"name\":\"position\",\"offset\":0},{\"dimension\":3,\"name\":\"normal\",\"offset\":12},"
+                 "{\"dimension\":1,\"name\":\"a\",\"offset\":24,\"rangeMin\":0,\"rangeMax\":249.5},")==std::string::npos ||
+       json.find("\"name\":\"vertices\"")==std::string::npos || json.find("\"stride\":40}")==std::string::npos ||
+       count_of(json, "\"name\":\"position\"")!=1 || count_of(json, "\"name\":\"a\"")!=1) {
+        std::cerr << "interleaved section not described in manifest.json" << std::endl; return false;
+    }
+    std::vector<uint32_t> image;
+    UVFBinaryManifestView view;
+    if(!open_binary_manifest("test_out_interleaved", image, view)) return false;
+    const uint32_t* vertices = nullptr;
+    for(size_t i=0;i<view.count(UVF_BM_SECTIONS);++i) if(view.string_at(view.record(UVF_BM_SECTIONS, i)[1])=="vertices") vertices = view.record(UVF_BM_SECTIONS, i);
+    if(!vertices || vertices[2]!=10 || vertices[21]!=4 || view.count(UVF_BM_ATTRIBUTES)!=4) { std::cerr << "binary interleaved section missing" << std::endl; return false; }
+    const uint32_t* attr_b = view.record(UVF_BM_ATTRIBUTES, vertices[20] + 3);
+    if(view.string_at(attr_b[0])!="b" || attr_b[1]!=28 || attr_b[2]!=3 || attr_b[3]!=1 || UVFBinaryManifestView::f32(attr_b[5])!=float(n-1)) return false;
+    std::vector<char> bin = read_bytes("test_out_interleaved/" + manifest_bin_path("test_out_interleaved"));
+    const float* element = reinterpret_cast<const float*>(bin.data() + UVFBinaryManifestView::u64(vertices + 4)) + 123 * 10;
+    if(element[0]!=positions[369] || element[2]!=positions[371] || element[6]!=a[123] || element[7]!=b[369] || element[9]!=b[371]) {
+        std::cerr << "interleaved bytes wrong" << std::endl; return false;
+    }
+
+    // Both layouts, selected attributes; oct16 normals stay separate
+    opts.vertex_layout = "both";
+    opts.normals = "oct16";
+    opts.interleaved_attributes = {"b", "normal", "missing"};
+    fs::remove_all("test_out_interleaved_both");
+    if(!generate_uvf(mesh, "test_out_interleaved_both", opts)) return false;
+    json = read_manifest("test_out_interleaved_both");
+    if(json.find("\"name\":\"b\",\"offset\":12,\"rangeMin\":")==std::string::npos || json.find("\"stride\":24}")==std::string::npos ||
+       count_of(json, "\"name\":\"position\"")!=2 || count_of(json, "\"name\":\"normal\"")!=1) {
+        std::cerr << "selected attributes not interleaved" << std::endl; return false;
+    }
+    UVFOptions parsed;
+    if(!set_uvf_option(parsed, "vertex_layout", "both") || set_uvf_option(parsed, "vertex_layout", "aos") ||
+       !set_uvf_option(parsed, "interleaved_attribute", "b") || uvf_options_key(parsed).find(";layout=both:b")==std::string::npos) return false;
+
+    // Directory mode, incremental: cached interleaved layouts survive a reuse
+    const std::string inDir = "test_in_interleaved", outDir = "test_out_interleaved_dir";
+    fs::remove_all(inDir); fs::remove_all(outDir);
+    fs::create_directories(inDir);
+    fs::copy_file(std::string(TEST_DATA_DIR)+"/surface_sample.vtk", inDir+"/surface_sample.vtk");
+    UVFOptions dir_opts;
+    dir_opts.vertex_layout = "interleaved";
+    dir_opts.incremental = true;
+    if(!process_directory_structure(inDir.c_str(), outDir.c_str(), dir_opts)) return false;
+    std::string first = read_manifest(outDir);
+    if(!process_directory_structure(inDir.c_str(), outDir.c_str(), dir_opts)) return false;
+    return first.find("\"stride\":")!=std::string::npos && read_manifest(outDir)==first;
+}
+
+// Every "endIndex" of a manifest, in order
+static std::vector<std::string> end_indices(const std::string& json){
+    std::vector<std::string> out;
+    for(size_t at = json.find("\"endIndex\":"); at != std::string::npos; at = json.find("\"endIndex\":", at + 1)){
+        size_t begin = at + 11;
+        out.push_back(json.substr(begin, json.find_first_of(",}", begin) - begin));
+    }
+    return out;
+}
+
+// Directory and structured face ranges count decoded triangles, whatever the sections' stored length
+static bool test_stored_face_ranges() {
+    const std::string inDir = "test_in_ranges";
+    fs::remove_all(inDir);
+    fs::create_directories(inDir);
+    for(const char* f : {"slice_sample.vtp", "line_sample.vtp", "surface_sample.vtk"})
+        fs::copy_file(std::string(TEST_DATA_DIR)+"/"+f, inDir+"/"+f);
+    // Degenerate triangles all on vertex 0: the indices section is elided as a constant
+    std::ofstream(inDir + "/constant.vtk") << "# vtk DataFile Version 3.0\nconstant\nASCII\nDATASET POLYDATA\n"
+        "POINTS 3 float\n0 0 0 1 0 0 0 1 0\nPOLYGONS 2 8\n3 0 0 0\n3 0 0 0\n";
+    auto poly = make_triangle(0.2);
+    UVFOptions plain;
+    plain.binary_manifest = true;
+    fs::remove_all("test_out_ranges_plain"); fs::remove_all("test_out_ranges_plain_structured");
+    if(!process_directory_structure(inDir.c_str(), "test_out_ranges_plain", plain) ||
+       !generate_structured_uvf(poly, "test_out_ranges_plain_structured", plain)) return false;
+    const std::vector<std::string> expected = end_indices(read_manifest("test_out_ranges_plain"));
+    const std::vector<std::string> expected_structured = end_indices(read_manifest("test_out_ranges_plain_structured"));
+    if(expected.size()!=4 || expected_structured.empty()) return false;
+
+    std::vector<UVFOptions> variants(4, plain);
+    variants[0].compression = "deflate";
+    variants[1].compression = "deflate";
+    variants[1].mesh_codecs = true;
+    variants[2].mesh_codecs = true;
+    variants[3].elide_sections = true;
+    for(size_t v=0;v<variants.size();++v){
+        const std::string outDir = "test_out_ranges_" + std::to_string(v);
+        fs::remove_all(outDir); fs::remove_all(outDir + "_structured");
+        if(!process_directory_structure(inDir.c_str(), outDir.c_str(), variants[v]) ||
+           !generate_structured_uvf(poly, (outDir + "_structured").c_str(), variants[v])) return false;
+        if(end_indices(read_manifest(outDir))!=expected || end_indices(read_manifest(outDir + "_structured"))!=expected_structured) {
+            std::cerr << "face endIndex follows the stored length (variant " << v << ")" << std::endl; return false;
+        }
+        if(variants[v].elide_sections && read_manifest(outDir).find("\"constant\":0,\"dType\":\"uint32\"")==std::string::npos) { std::cerr << "indices not elided" << std::endl; return false; }
+        std::vector<uint32_t> image;
+        UVFBinaryManifestView view;
+        if(!open_binary_manifest(outDir, image, view)) return false;
+        for(size_t i=0;i<view.count(UVF_BM_FACES);++i){
+            if(std::to_string(UVFBinaryManifestView::u64(view.record(UVF_BM_FACES, i) + 6))!=expected[i]) { std::cerr << "binary face range follows the stored length" << std::endl; return false; }
+        }
+    }
+    return true;
+}
+
+int main() {
+    bool a = test_content_hash_names();
+    bool b = test_random_names_default();
+    bool c = test_incremental_directory();
+    bool d = test_time_series_xor();
+    bool e = test_watch_directory();
+    bool f = test_glob_match();
+    bool g = test_recursive_directory();
+    bool h = test_cancel_directory();
+    bool i = test_binary_manifest();
+    bool j = test_container_output();
+    bool k = test_section_compression();
+    bool l = test_mesh_codecs();
+    bool m = test_section_elision();
+    bool o = test_vertex_normals();
+    bool p = test_face_ids();
+    bool q = test_mesh_bvh();
+    bool r = test_feature_edges();
+    bool s = test_spatial_reorder();
+    bool t = test_interleaved_vertices();
+    bool u = test_stored_face_ranges();
+    if(!(a&&b&&c&&d&&e&&f&&g&&h&&i&&j&&k&&l&&m&&o&&p&&q&&r&&s&&t&&u)) {
+        std::cerr << "Tests failed: " << a << b << c << d << e << f << g << h << i << j << k << l << m << o << p << q << r << s << t << u << std::endl;
+        return 1;
+    }
+    std::cout << "All output option tests passed" << std::endl;
+    return 0;
+}